@@ -0,0 +1,145 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Memoria por escena (arena) para los objetos del grafo (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_ARENA_HPP
+#define IG_ARENA_HPP
+
+#include <cstddef>   // std::size_t
+#include <vector>
+
+// ---------------------------------------------------------------------
+// Una arena es una región de memoria en la que se crean todos los objetos
+// de una escena (nodos, mallas, materiales, entradas de los nodos, ...):
+// se reservan seguidos, en bloques grandes, y se liberan todos a la vez
+// con 'vaciar', sin ir objeto a objeto.
+//
+// Las clases base de la escena (Objeto3D, Material, ColFuentesLuz)
+// redefinen 'operator new' con 'Arena_Reservar': mientras haya una arena
+// activa en la hebra (ver 'UsarArena'), los 'new' de esas clases van a la
+// arena; si no, al montón, como siempre. Las matrices de las entradas de
+// los nodos también van a la arena.
+//
+// Al vaciar la arena se ejecutan los destructores de los objetos que no
+// se hayan destruido antes (en orden inverso al de creación), para que
+// liberen lo que tengan fuera de la arena (tablas de las mallas, texturas,
+// ...). Por eso un objeto no debe destruir a otro que esté en una arena
+// (ver 'Arena_Borrar').
+
+// función que destruye (sin liberar) el objeto que empieza en 'p'
+typedef void (*FuncFinalizar)( void * p ) ;
+
+class Arena
+{
+   public:
+      // 'tam_bloque': bytes de cada bloque que se pide al sistema
+      Arena( const std::size_t p_tam_bloque = 64*1024 ) ;
+      ~Arena() ;
+
+      Arena( const Arena & ) = delete ;
+      Arena & operator = ( const Arena & ) = delete ;
+
+      // reserva 'tam' bytes alineados a 16, detrás de una cabecera (ver
+      // 'Arena_Liberar'). Si 'fin' no es nulo, se llama con el objeto al
+      // vaciar la arena, salvo que se haya liberado antes
+      void * reservar( const std::size_t tam, FuncFinalizar fin = nullptr ) ;
+
+      // destruye los objetos que queden y libera todos los bloques
+      // (sin liberar cada objeto por separado)
+      void vaciar() ;
+
+      // bytes reservados desde el último 'vaciar' (con las cabeceras). Lo
+      // liberado con 'delete' no se reutiliza, así que es también el máximo
+      std::size_t bytesUsados() const ;
+      std::size_t bytesBloques() const ;  // bytes pedidos al sistema (bloques actuales)
+      unsigned    numBloques() const ;
+      unsigned    numObjetos() const ;    // objetos con destructor pendientes de destruir
+
+   private:
+      struct Bloque
+      {
+         char *      datos ;
+         std::size_t tam ;
+      } ;
+      struct Finalizacion
+      {
+         void *        objeto ;
+         FuncFinalizar fin ;
+      } ;
+
+      std::size_t tam_bloque ;
+      std::vector<Bloque> bloques ;       // el último es el actual
+      std::size_t usado_bloque ;          // bytes usados en el bloque actual
+      std::size_t bytes_usados ;
+      std::vector<Finalizacion> finalizaciones ; // en orden de creación
+} ;
+
+// ---------------------------------------------------------------------
+// arena activa en la hebra actual (nullptr si no hay ninguna)
+
+Arena * Arena_Actual() ;
+
+// activa una arena en la hebra actual mientras exista el objeto
+// (se pueden anidar: al destruirse se restaura la anterior)
+class UsarArena
+{
+   public:
+      UsarArena( Arena * arena ) ;
+      ~UsarArena() ;
+   private:
+      Arena * anterior ;
+} ;
+
+// ---------------------------------------------------------------------
+// funciones para 'operator new' y 'operator delete' de las clases que se
+// pueden crear en una arena: reservan en la arena activa (o en el montón
+// si no hay ninguna) y liberan según dónde se reservó el bloque
+
+void * Arena_Reservar( const std::size_t tam, FuncFinalizar fin = nullptr ) ;
+void   Arena_Liberar( void * p ) ;
+
+// true si el bloque 'p' (devuelto por 'Arena_Reservar') está en una arena
+bool Arena_EnArena( const void * p ) ;
+
+// true mientras se está vaciando alguna arena en la hebra actual
+bool Arena_Vaciando() ;
+
+// destruye 'p' si está en el montón; si está en una arena no hace nada:
+// lo destruirá la arena al vaciarse
+template< class T > void Arena_Borrar( T * p )
+{
+   if ( p != nullptr && ! Arena_EnArena( p ) )
+      delete p ;
+}
+
+// ---------------------------------------------------------------------
+// asignador para contenedores de la biblioteca estándar: reserva en la
+// arena activa al crecer el contenedor, o en el montón si no hay ninguna
+
+template< class T > struct AsignadorArena
+{
+   typedef T value_type ;
+
+   AsignadorArena() {}
+   template< class U > AsignadorArena( const AsignadorArena<U> & ) {}
+
+   T * allocate( const std::size_t n )
+   {
+      return static_cast<T *>( Arena_Reservar( n*sizeof(T) ) );
+   }
+   void deallocate( T * p, const std::size_t )
+   {
+      Arena_Liberar( p );
+   }
+} ;
+
+template< class T, class U >
+bool operator == ( const AsignadorArena<T> &, const AsignadorArena<U> & ) { return true ; }
+template< class T, class U >
+bool operator != ( const AsignadorArena<T> &, const AsignadorArena<U> & ) { return false ; }
+
+#endif
@@ -224,6 +224,52 @@ void MallaInd::visualizarDE_VBOs( ContextoVis & cv ){
   glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+// dibuja todas las instancias a la vez: las posiciones y normales van al
+// shader como 'gl_Vertex' y 'gl_Normal', los atributos de instancia ya
+// están fijados
+void MallaInd::visualizarInstancias( ContextoVis & cv, const GLsizei num_instancias ){
+  setPolygonMode(cv);
+  setLineasPuntos(2,4);
+
+  if(!modoVBO){
+    crearVBOs();
+    modoVBO = true;
+  }
+
+  if(col_ver.size() > 0){
+    glBindBuffer(GL_ARRAY_BUFFER, id_vbo_col_ver);
+    glColorPointer(3, GL_FLOAT, 0, 0);
+    glEnableClientState( GL_COLOR_ARRAY );
+  }
+
+  if(normales_vertices.size() > 0){
+    glBindBuffer(GL_ARRAY_BUFFER, id_vbo_norm_ver);
+    glNormalPointer(GL_FLOAT, 0, 0);
+    glEnableClientState(GL_NORMAL_ARRAY);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, id_vbo_ver);
+  glVertexPointer( 3, GL_FLOAT, 0, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glEnableClientState(GL_VERTEX_ARRAY);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_vbo_tri);
+  //en OSX (OpenGL 2.1) y sin OpenGL 3.1 es una extensión ARB
+#ifdef OSX
+  glDrawElementsInstancedARB( GL_TRIANGLES, 3*caras.size(), GL_UNSIGNED_INT, nullptr, num_instancias);
+#else
+  if(GLEW_VERSION_3_1)
+    glDrawElementsInstanced( GL_TRIANGLES, 3*caras.size(), GL_UNSIGNED_INT, nullptr, num_instancias);
+  else
+    glDrawElementsInstancedARB( GL_TRIANGLES, 3*caras.size(), GL_UNSIGNED_INT, nullptr, num_instancias);
+#endif
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glDisableClientState(GL_COLOR_ARRAY );
+  glDisableClientState(GL_NORMAL_ARRAY);
+}
+
 void MallaInd::visualizarDE_Plano(ContextoVis & cv){
   glBegin(GL_TRIANGLES);
   for(unsigned i=0; i<caras.size(); i++){
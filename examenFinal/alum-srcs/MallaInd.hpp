@@ -86,6 +86,9 @@ class MallaInd : public Objeto3D
       MallaInd( const string & nombreIni );
       // visualizar el objeto con OpenGL
       virtual void visualizarGL( ContextoVis & cv) ;
+      // visualizar 'num_instancias' copias con una llamada, con VBOs y el
+      // shader y los atributos de instancia ya fijados (ver NodoInstancias.hpp)
+      void visualizarInstancias( ContextoVis & cv, const GLsizei num_instancias ) ;
 
 } ;
 // ---------------------------------------------------------------------
@@ -0,0 +1,299 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Nodo con instancias de mallas repetidas (implementación)
+// **
+// *********************************************************************
+
+#include <cstddef>   // offsetof
+#include "aux.hpp"
+#include "shaders.hpp"
+#include "cauce.hpp"
+#include "NodoInstancias.hpp"
+
+using namespace std ;
+
+// *****************************************************************************
+// funciones auxiliares
+
+// atributos de una instancia, tal como van en el VBO del grupo
+struct AtributosInstancia
+{
+   GLfloat       matriz[16] ; // por columnas, como 'glMultMatrixf'
+   Tupla4f       color ;
+   unsigned char ident[4] ;   // identificador como color (ver 'FijarColorIdent')
+} ;
+static_assert( sizeof(Matriz4f) == 16*sizeof(GLfloat), "Matriz4f debe ser float[16]" );
+
+// programa que dibuja las instancias y posiciones de sus atributos (se
+// crea la primera vez que se dibuja con instancias)
+static InstanciasSP * programa = nullptr ;
+static GLint loc_matriz = -1, loc_color = -1, loc_ident = -1 ;
+
+// fija el divisor de un atributo (1: cambia en cada instancia, 0: en cada
+// vértice). En OSX (OpenGL 2.1) y sin OpenGL 3.3 es una extensión ARB
+static void DivisorAtributo( const GLuint loc, const GLuint divisor )
+{
+#ifdef OSX
+   glVertexAttribDivisorARB( loc, divisor );
+#else
+   if ( GLEW_VERSION_3_3 )
+      glVertexAttribDivisor( loc, divisor );
+   else
+      glVertexAttribDivisorARB( loc, divisor );
+#endif
+}
+
+// modo de generación de coordenadas de textura activo, como en 'instancias_vs.glsl'
+static int ModoGenCTActual()
+{
+   if ( ! glIsEnabled( GL_TEXTURE_GEN_S ) )
+      return 0 ;
+   GLint modo ;
+   glGetTexGeniv( GL_S, GL_TEXTURE_GEN_MODE, &modo );
+   return modo == GL_OBJECT_LINEAR ? 1 : ( modo == GL_EYE_LINEAR ? 2 : 0 ) ;
+}
+
+// *****************************************************************************
+// NodoInstancias
+
+NodoInstancias::NodoInstancias()
+{
+   ponerNombre( "nodo con instancias" );
+}
+// -----------------------------------------------------------------------------
+
+bool NodoInstancias::instanciasDisponibles()
+{
+#ifdef OSX
+   return true ;
+#else
+   static const bool disponibles = GLEW_VERSION_3_3 ||
+      ( GLEW_ARB_instanced_arrays && GLEW_ARB_draw_instanced ) ;
+   return disponibles ;
+#endif
+}
+// -----------------------------------------------------------------------------
+
+unsigned NodoInstancias::agregar( MallaInd * malla, const Matriz4f & matriz,
+                                  const int ident )
+{
+   // color con alfa 0: se usa el de la malla
+   const unsigned i = agregar( malla, matriz, Tupla3f( 0.0, 0.0, 0.0 ), ident );
+   grupos[indice_grupo[malla]].colores[i] = Tupla4f( 0.0, 0.0, 0.0, 0.0 );
+   return i ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned NodoInstancias::agregar( MallaInd * malla, const Matriz4f & matriz,
+                                  const Tupla3f & color, const int ident )
+{
+   assert( malla != nullptr );
+   auto pos = indice_grupo.find( malla );
+   if ( pos == indice_grupo.end() )
+   {
+      pos = indice_grupo.insert( { malla, grupos.size() } ).first ;
+      grupos.push_back( GrupoInstancias() );
+      grupos.back().malla = malla ;
+   }
+   GrupoInstancias & g = grupos[pos->second] ;
+   g.matrices.push_back( matriz );
+   g.colores.push_back( Tupla4f( color(0), color(1), color(2), 1.0 ) );
+   g.idents.push_back( ident );
+   g.vbo_act = false ;
+   return g.matrices.size()-1 ;
+}
+// -----------------------------------------------------------------------------
+
+void NodoInstancias::fijarMatriz( MallaInd * malla, const unsigned i, const Matriz4f & matriz )
+{
+   GrupoInstancias & g = grupos.at( indice_grupo.at( malla ) );
+   g.matrices.at( i ) = matriz ;
+   g.vbo_act = false ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned NodoInstancias::numInstancias() const
+{
+   unsigned n = 0 ;
+   for( unsigned i = 0 ; i < grupos.size() ; i++ )
+      n += grupos[i].matrices.size() ;
+   return n ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned NodoInstancias::numGrupos() const
+{
+   return grupos.size() ;
+}
+// -----------------------------------------------------------------------------
+
+void NodoInstancias::actualizarVBO( GrupoInstancias & g )
+{
+   const int ident_nodo = leerIdentificador() ;
+   if ( g.vbo_act && g.ident_vbo == ident_nodo )
+      return ;
+
+   std::vector<AtributosInstancia> atr( g.matrices.size() );
+   for( unsigned i = 0 ; i < atr.size() ; i++ )
+   {
+      const GLfloat * m = g.matrices[i] ;
+      std::copy( m, m+16, atr[i].matriz );
+      atr[i].color = g.colores[i] ;
+      const int ident = g.idents[i] == -1 ? ident_nodo : g.idents[i] ;
+      atr[i].ident[0] = ( ident            ) % 0x100U ;
+      atr[i].ident[1] = ( ident/0x100U     ) % 0x100U ;
+      atr[i].ident[2] = ( ident/0x10000U   ) % 0x100U ;
+      atr[i].ident[3] = 0xFF ;
+   }
+
+   if ( g.id_vbo == 0 )
+      glGenBuffers( 1, &g.id_vbo );
+   glBindBuffer( GL_ARRAY_BUFFER, g.id_vbo );
+   glBufferData( GL_ARRAY_BUFFER, atr.size()*sizeof(AtributosInstancia), atr.data(), GL_STATIC_DRAW );
+   glBindBuffer( GL_ARRAY_BUFFER, 0 );
+   g.vbo_act   = true ;
+   g.ident_vbo = ident_nodo ;
+}
+// -----------------------------------------------------------------------------
+
+void NodoInstancias::visualizarGrupoInstancias( GrupoInstancias & g, ContextoVis & cv )
+{
+   actualizarVBO( g );
+
+   // atributos de instancia: la matriz ocupa cuatro posiciones (una por columna)
+   const GLsizei tam = sizeof(AtributosInstancia) ;
+   glBindBuffer( GL_ARRAY_BUFFER, g.id_vbo );
+   for( GLuint c = 0 ; c < 4 ; c++ )
+   {
+      glEnableVertexAttribArray( loc_matriz+c );
+      glVertexAttribPointer( loc_matriz+c, 4, GL_FLOAT, GL_FALSE, tam,
+         (GLvoid *)( offsetof( AtributosInstancia, matriz ) + 4*c*sizeof(GLfloat) ) );
+      DivisorAtributo( loc_matriz+c, 1 );
+   }
+   glEnableVertexAttribArray( loc_color );
+   glVertexAttribPointer( loc_color, 4, GL_FLOAT, GL_FALSE, tam,
+      (GLvoid *) offsetof( AtributosInstancia, color ) );
+   DivisorAtributo( loc_color, 1 );
+   glEnableVertexAttribArray( loc_ident );
+   glVertexAttribPointer( loc_ident, 4, GL_UNSIGNED_BYTE, GL_TRUE, tam,
+      (GLvoid *) offsetof( AtributosInstancia, ident ) );
+   DivisorAtributo( loc_ident, 1 );
+   glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+   g.malla->visualizarInstancias( cv, g.matrices.size() );
+
+   // dejar los atributos como estaban (sin divisor y desactivados)
+   for( GLuint c = 0 ; c < 4 ; c++ )
+   {
+      DivisorAtributo( loc_matriz+c, 0 );
+      glDisableVertexAttribArray( loc_matriz+c );
+   }
+   DivisorAtributo( loc_color, 0 );
+   glDisableVertexAttribArray( loc_color );
+   DivisorAtributo( loc_ident, 0 );
+   glDisableVertexAttribArray( loc_ident );
+}
+// -----------------------------------------------------------------------------
+
+void NodoInstancias::visualizarGrupoUnoAUno( GrupoInstancias & g, ContextoVis & cv )
+{
+   const int ident_nodo = leerIdentificador() ;
+   glMatrixMode( GL_MODELVIEW );
+   for( unsigned i = 0 ; i < g.matrices.size() ; i++ )
+   {
+      glPushMatrix();
+      glMultMatrixf( g.matrices[i] );
+      if ( cv.modoSeleccionFBO )
+         FijarColorIdent( g.idents[i] == -1 ? ident_nodo : g.idents[i] );
+      else if ( g.colores[i](3) > 0.0 )
+         glColor4fv( g.colores[i] );
+      g.malla->visualizarGL( cv );
+      glPopMatrix();
+   }
+}
+// -----------------------------------------------------------------------------
+
+void NodoInstancias::visualizarGL( ContextoVis & cv )
+{
+   if ( grupos.empty() )
+      return ;
+
+   // la iluminación plana usa las normales de las caras, que no están en los VBOs
+   if ( ! cv.usarInstancias || cv.modoVis == modoIluminacionPlano || ! instanciasDisponibles() )
+   {
+      for( unsigned i = 0 ; i < grupos.size() ; i++ )
+         visualizarGrupoUnoAUno( grupos[i], cv );
+      return ;
+   }
+
+   if ( programa == nullptr )
+   {
+      programa   = new InstanciasSP() ;
+      const GLuint prog = programa->leerIdProg() ;
+      loc_matriz = glGetAttribLocation( prog, "matriz_instancia" );
+      loc_color  = glGetAttribLocation( prog, "color_instancia" );
+      loc_ident  = glGetAttribLocation( prog, "color_ident" );
+      assert( loc_matriz >= 0 && loc_color >= 0 && loc_ident >= 0 );
+   }
+
+   // en los modos sin iluminación las mallas no usan luces ni texturas
+   // (ver MallaInd::visualizarGL)
+   if ( cv.modoVis == modoPuntos || cv.modoVis == modoAlambre || cv.modoVis == modoSolido )
+   {
+      glDisable( GL_LIGHTING );
+      glDisable( GL_TEXTURE_2D );
+   }
+
+   // el estado del cauce fijo que usa el shader
+   const GLuint prog = programa->leerIdProg() ;
+   programa->activar();
+   asignarUniform( prog, "seleccion",   cv.modoSeleccionFBO ? 1 : 0 );
+   asignarUniform( prog, "iluminacion", glIsEnabled( GL_LIGHTING ) ? 1 : 0 );
+   for( unsigned i = 0 ; i < 8 ; i++ )
+   {
+      const std::string nombre = "luz_activa[" + std::to_string( i ) + "]" ;
+      asignarUniform( prog, nombre.c_str(), glIsEnabled( GL_LIGHT0+i ) ? 1 : 0 );
+   }
+   const bool textura = ! cv.modoSeleccionFBO && glIsEnabled( GL_TEXTURE_2D ) ;
+   asignarUniform( prog, "textura",     textura ? 1 : 0 );
+   asignarUniform( prog, "imagen",      0 );
+   asignarUniform( prog, "modo_gen_ct", textura ? ModoGenCTActual() : 0 );
+
+   for( unsigned i = 0 ; i < grupos.size() ; i++ )
+      visualizarGrupoInstancias( grupos[i], cv );
+
+   glUseProgram( 0 );
+}
+// -----------------------------------------------------------------------------
+
+bool NodoInstancias::buscarObjeto( const int ident_busc, const Matriz4f & mmodelado,
+                                   Objeto3D ** objeto, Tupla3f & centro_wc )
+{
+   if ( Objeto3D::buscarObjeto( ident_busc, mmodelado, objeto, centro_wc ) )
+      return true ;
+
+   for( unsigned i = 0 ; i < grupos.size() ; i++ )
+   {
+      GrupoInstancias & g = grupos[i] ;
+      for( unsigned j = 0 ; j < g.idents.size() ; j++ )
+         if ( g.idents[j] == ident_busc )
+         {
+            g.malla->calcularCentroOC();
+            centro_wc = mmodelado*( g.matrices[j]*g.malla->leerCentroOC() );
+            if ( objeto != nullptr )
+               *objeto = this ;
+            return true ;
+         }
+   }
+   return false ;
+}
+// -----------------------------------------------------------------------------
+
+NodoInstancias::~NodoInstancias()
+{
+   for( unsigned i = 0 ; i < grupos.size() ; i++ )
+      if ( grupos[i].id_vbo != 0 )
+         glDeleteBuffers( 1, &grupos[i].id_vbo );
+}
@@ -0,0 +1,89 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Nodo con instancias de mallas repetidas (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_NODOINSTANCIAS_HPP
+#define IG_NODOINSTANCIAS_HPP
+
+#include <vector>
+#include <map>
+#include "MallaInd.hpp"
+
+// ---------------------------------------------------------------------
+// Objeto con muchas copias (instancias) de unas pocas mallas, cada una con
+// su matriz de modelado (respecto del nodo), su color y su identificador.
+// Las instancias de la misma malla se agrupan, y cada grupo se dibuja con
+// una sola llamada a 'glDrawElementsInstanced': las matrices, colores e
+// identificadores van en un VBO, y el shader 'InstanciasSP' (ver cauce.hpp)
+// los lee como atributos de instancia y calcula la iluminación, la textura
+// y las coordenadas de textura igual que el cauce fijo.
+//
+// Si OpenGL no tiene instancias (versión < 3.3 sin ARB_instanced_arrays),
+// en el modo de iluminación plana (que usa las normales de las caras) o si
+// 'cv.usarInstancias' es false, cada instancia se dibuja por separado con
+// su matriz, como lo haría un nodo del grafo de escena.
+//
+// Las matrices de las instancias deben ser rígidas o con escalado uniforme
+// (las normales se transforman con la propia matriz).
+
+class NodoInstancias : public Objeto3D
+{
+   private:
+      struct GrupoInstancias
+      {
+         MallaInd *            malla ;   // (no propietario, la comparten todas)
+         std::vector<Matriz4f> matrices ;
+         std::vector<Tupla4f>  colores ; // alfa 0: color de la malla
+         std::vector<int>      idents ;  // -1: el del nodo
+         GLuint                id_vbo  = 0 ;     // VBO con los atributos de las instancias
+         bool                  vbo_act = false ; // true si el VBO tiene los datos actuales
+         int                   ident_vbo = 0 ;   // identificador del nodo con el que se llenó
+                                                 // el VBO (el de las instancias con -1)
+      } ;
+
+      std::vector<GrupoInstancias> grupos ;
+      std::map<MallaInd *,unsigned> indice_grupo ; // grupo de cada malla
+
+      // true si OpenGL puede dibujar con instancias (se comprueba una vez)
+      static bool instanciasDisponibles() ;
+
+      // envía al VBO del grupo sus atributos de instancia, si han cambiado
+      // (también si ha cambiado el identificador del nodo)
+      void actualizarVBO( GrupoInstancias & g ) ;
+      void visualizarGrupoInstancias( GrupoInstancias & g, ContextoVis & cv ) ;
+      void visualizarGrupoUnoAUno( GrupoInstancias & g, ContextoVis & cv ) ;
+
+   public:
+      NodoInstancias() ;
+
+      // añade una instancia de 'malla' con la matriz 'matriz' (se agrupa con
+      // las demás de la misma malla). Devuelve el índice de la instancia en
+      // su grupo. Con 'color' se fija el color de la instancia cuando no hay
+      // iluminación (si no, se usa el de la malla)
+      unsigned agregar( MallaInd * malla, const Matriz4f & matriz,
+                        const int ident = -1 ) ;
+      unsigned agregar( MallaInd * malla, const Matriz4f & matriz,
+                        const Tupla3f & color, const int ident = -1 ) ;
+
+      // cambiar la matriz de una instancia (de la malla 'malla')
+      void fijarMatriz( MallaInd * malla, const unsigned i, const Matriz4f & matriz ) ;
+
+      unsigned numInstancias() const ;
+      unsigned numGrupos() const ;
+
+      // dibuja cada grupo con una llamada (o cada instancia, ver arriba)
+      virtual void visualizarGL( ContextoVis & cv ) ;
+
+      // busca entre el nodo y los identificadores de las instancias (el
+      // objeto encontrado es el nodo, el centro el de la instancia)
+      virtual bool buscarObjeto( const int ident_busc, const Matriz4f & mmodelado,
+                                 Objeto3D ** objeto, Tupla3f & centro_wc ) ;
+
+      virtual ~NodoInstancias() ;
+} ;
+
+#endif
@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include "Objeto3D.hpp"
+#include "Arena.hpp"
 
 using namespace std ;
 
@@ -103,3 +104,15 @@ Objeto3D::~Objeto3D()
    using namespace std ;
    cout << "destruyendo objeto3D de nombre: " << nombre_obj << endl << flush ;
 }
+// -----------------------------------------------------------------------------
+
+void * Objeto3D::operator new( std::size_t tam )
+{
+   return Arena_Reservar( tam, []( void * p ) { static_cast<Objeto3D *>( p )->~Objeto3D(); } );
+}
+// -----------------------------------------------------------------------------
+
+void Objeto3D::operator delete( void * p )
+{
+   Arena_Liberar( p );
+}
@@ -60,6 +60,10 @@ class Objeto3D
       // destructor
       virtual ~Objeto3D();
 
+      // los objetos se crean en la arena activa, si la hay (ver Arena.hpp)
+      static void * operator new( std::size_t tam ) ;
+      static void   operator delete( void * p ) ;
+
       // método para buscar un objeto con un identificador y devolver
       // un puntero al objeto y el punto central
       //
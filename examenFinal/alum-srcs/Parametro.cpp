@@ -1,7 +1,7 @@
 #include <cassert>
 #include <cmath>
 #include "Parametro.hpp"
-#include "Objeto3D.hpp"
+#include "grafo-escena.hpp"
 #include "matrices-tr.hpp"
 
 using namespace std;
@@ -13,7 +13,7 @@ using namespace std;
 
 Parametro::Parametro(std::string p_descripcion, Matriz4f * p_ptr_mat,
                     TFuncionCMF p_fcm, bool p_acotado, float p_c,
-                    float p_s, float p_f){
+                    float p_s, float p_f, NodoGrafoEscena * p_propietario){
   ////
   aceleracion = 0.1;
   incremento = 1.0;
@@ -21,6 +21,7 @@ Parametro::Parametro(std::string p_descripcion, Matriz4f * p_ptr_mat,
   ////
   descripcion = p_descripcion;
   ptr_mat = p_ptr_mat;
+  propietario = p_propietario;
   fun_calculo_matriz = p_fcm;
   acotado = p_acotado;
   c = p_c;
@@ -34,20 +35,20 @@ Parametro::Parametro(std::string p_descripcion, Matriz4f * p_ptr_mat,
 /*actualizar valor y matriz al siguiente frame*/
 void Parametro::siguiente_cuadro(){
   valor_norm += velocidad;
-  *ptr_mat = fun_calculo_matriz(leer_valor_actual());
+  actualizar_matriz();
 }
 // -----------------------------------------------------------------------------
 /*vuelve al estado inicial de valor, aceleracion y velocidad */
 void Parametro::reset(){
   valor_norm = c;
   velocidad = velocidad_inicial;
-  *ptr_mat = fun_calculo_matriz(leer_valor_actual());
+  actualizar_matriz();
 }
 // -----------------------------------------------------------------------------
 /*incrementar el valor*/
 void Parametro::incrementar(){
   valor_norm += incremento;
-  *ptr_mat = fun_calculo_matriz(leer_valor_actual());
+  actualizar_matriz();
 }
 // -----------------------------------------------------------------------------
 /*decrementar el valor*/
@@ -56,7 +57,7 @@ void Parametro::decrementar(){
   //if(valor_norm < 0){
   //  valor_norm = -valor_norm;
   //}
-  *ptr_mat = fun_calculo_matriz(leer_valor_actual());
+  actualizar_matriz();
 }
 // -----------------------------------------------------------------------------
 /*acelerar (aumentar velocidad)*/
@@ -94,6 +95,15 @@ string Parametro::leer_descripcion(){
   return descripcion;
 }
 
+/*recalcula la matriz e invalida la caché de matrices del nodo que la contiene*/
+void Parametro::actualizar_matriz(){
+  *ptr_mat = fun_calculo_matriz(leer_valor_actual());
+  if(propietario != nullptr){
+    propietario->invalidarMatrices();
+  }
+}
+// -----------------------------------------------------------------------------
+
 Matriz4f * Parametro::leer_ptr(){
   return ptr_mat;
 }
@@ -5,7 +5,7 @@
 #ifndef GRADO_LIBERTAD_HPP
 #define GRADO_LIBERTAD_HPP
 
-class Objeto3D ;
+class NodoGrafoEscena ;
 
 // ** Informática Gráfica, curso 2018-19
 // ** Montserrat Rodríguez Zamorano
@@ -22,6 +22,7 @@ class Parametro
   private:
      string descripcion; //descripcion del grado de libertad
      Matriz4f * ptr_mat; //puntero a la matriz dentro del modelo
+     NodoGrafoEscena * propietario; //nodo que contiene la matriz (se invalidan sus matrices al cambiarla)
      TFuncionCMF fun_calculo_matriz; //nueva matriz a partir de un valor flotante
      bool acotado; //true si el valor oscila entre dos valores
      float c; //valor inicial
@@ -37,7 +38,7 @@ class Parametro
 
   Parametro(string p_descripcion, Matriz4f * p_ptr_mat,
             TFuncionCMF p_fcm, bool p_acotado, float p_c,
-            float p_s, float p_f);
+            float p_s, float p_f, NodoGrafoEscena * p_propietario = nullptr);
 
    void  siguiente_cuadro();   // actualizar valor y matriz al siguiente frame
    void  reset();        // vuelve al estado inicial
@@ -47,6 +48,7 @@ class Parametro
    void  decelerar();    // decelerar (disminuir la velocidad normalizada)
    float leer_valor_actual(); // devuelve el valor actual (escalado, no normalizado)
    float leer_velocidad_actual();    // devuelve velocidad actual
+   void  actualizar_matriz();  // recalcula la matriz con el valor actual
    string leer_descripcion();
    Matriz4f * leer_ptr();
 };
@@ -44,6 +44,13 @@ void ShaderProg::activar()
 }
 // -----------------------------------------------------------------------------
 
+GLint ShaderProg::leerIdProg() const
+{
+   assert( compilado );
+   return idProg ;
+}
+// -----------------------------------------------------------------------------
+
 SimpleSP::SimpleSP()
 
 : ShaderProg( "simple_fs.glsl", "simple_vs.glsl")
@@ -51,3 +58,10 @@ SimpleSP::SimpleSP()
    using namespace std ;
    //cout << "creado shader program simple" << endl << flush ;
 }
+// -----------------------------------------------------------------------------
+
+InstanciasSP::InstanciasSP()
+
+: ShaderProg( "instancias_fs.glsl", "instancias_vs.glsl")
+{
+}
@@ -34,6 +34,7 @@ class ShaderProg
    public:
    ShaderProg( const std::string & frag_fn, const std::string & vert_fn );
    void activar();
+   GLint leerIdProg() const ; // identificador del programa (para los 'uniform')
 
    private:
    bool  compilado ;
@@ -47,5 +48,13 @@ class SimpleSP : public  ShaderProg
    SimpleSP() ;
 } ;
 
+// dibuja instancias de una malla, cada una con su matriz, color e
+// identificador como atributos de instancia (ver NodoInstancias.hpp)
+class InstanciasSP : public  ShaderProg
+{
+   public:
+   InstanciasSP() ;
+} ;
+
 
 #endif
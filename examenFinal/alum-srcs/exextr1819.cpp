@@ -150,37 +150,34 @@ PrismaRegP2::PrismaRegP2( const int n ){
 
 PrismasP3::PrismasP3( const int nf, const int nc ){
   agregar(MAT_Escalado(0.5,2.0,0.5));
-  for(unsigned i=0; i<nc; i++){
-    float retroceso=0.0;
-    agregar(MAT_Traslacion(0.0,0.0,-3));
-    retroceso=aniadeFila(nf);
-    agregar(MAT_Traslacion(-retroceso,0.0,0.0));
+  agregar(MAT_Traslacion(0.0,0.0,-3)); //esta es la que modifica el parametro
+  //las mallas se comparten entre todas las filas
+  for(int j=3; j<=(nf+2); j++)
+    mallas.push_back(new PrismaRegP2(j));
+  instancias = new NodoInstancias();
+  agregar(instancias);
+  //matriz de cada fila, respecto de la primera
+  Matriz4f mcol = MAT_Ident();
+  for(int i=0; i<nc; i++){
+    aniadeFila(mcol);
+    mcol = mcol*MAT_Traslacion(0.0,0.0,-3);
   }
 }
 
-float PrismasP3::aniadeFila(const int nf){
-  float retroceso = 0.0;
-  for(unsigned j=3; j<=(nf+2); j++){
-    retroceso+=3;
-    agregar(MAT_Traslacion(3,0.0,0.0));
-    aniadePrisma(j);
-  }
-  return retroceso;
+void PrismasP3::aniadeFila(const Matriz4f & mcol){
+  for(unsigned j=0; j<mallas.size(); j++)
+    aniadePrisma(j, mcol*MAT_Traslacion(3.0*(j+1),0.0,0.0));
 }
 
 //el parametro no esta bien, tendria que haber calculado la posicion
-//para cada prisma en la que está la matriz MAT_Traslacion(0,0,0)
-//y modificar esa
-
-void PrismasP3::aniadePrisma(const int ind){
-  glLoadIdentity();
-  agregar(MAT_Traslacion(0.0,0.0,0.0)); //esta es la que modificara el parametro
-  PrismaRegP2 *np = new PrismaRegP2(ind);
-  agregar(np);
+//de cada prisma y modificar esa
+
+void PrismasP3::aniadePrisma(const int ind, const Matriz4f & m){
+  instancias->agregar(mallas[ind], m);
   string mensaje = "Rotación de los prismas alrededor del eje Y.";
   parametros.push_back(Parametro(mensaje, entradas[1].matriz,
               [=](float v){return MAT_Rotacion(v,0.0,1.0,0.0);},
-              false, 0.0, 15.0, 0.5));
+              false, 0.0, 15.0, 0.5, this));
 }
 
 // #############################################################################
@@ -209,23 +206,21 @@ MatPrismas::MatPrismas():Material(new TexturaPrisma(),0.2,0.6,0.2,5.0){
 PrismasP4::PrismasP4( const int nf, const int nc){
   agregar(new MatPrismas());
   agregar(MAT_Escalado(0.5,2.0,0.5));
-  for(unsigned i=0; i<nc; i++){
-    float retroceso=0.0;
-    agregar(MAT_Traslacion(0.0,0.0,-3.0));
-    retroceso=aniadeFila(nf);
-    agregar(MAT_Traslacion(-retroceso,0.0,0.0));
+  //las mallas se comparten entre todas las filas
+  for(int j=3; j<=(nf+2); j++)
+    mallas.push_back(new PrismaRegP2(j));
+  instancias = new NodoInstancias();
+  agregar(instancias);
+  Matriz4f mcol = MAT_Traslacion(0.0,0.0,-3.0);
+  for(int i=0; i<nc; i++){
+    aniadeFila(mcol);
+    mcol = mcol*MAT_Traslacion(0.0,0.0,-3.0);
   }
 }
 
-float PrismasP4::aniadeFila(const int nf){
-  float retroceso = 0.0;
-  for(unsigned j=3; j<=(nf+2); j++){
-    retroceso+=3.0;
-    agregar(MAT_Traslacion(3,0.0,0.0));
-    PrismaRegP2 *np = new PrismaRegP2(j);
-    agregar(np);
-  }
-  return retroceso;
+void PrismasP4::aniadeFila(const Matriz4f & mcol){
+  for(unsigned j=0; j<mallas.size(); j++)
+    instancias->agregar(mallas[j], mcol*MAT_Traslacion(3.0*(j+1),0.0,0.0));
 }
 
 void PrismasP3::reiniciar(){
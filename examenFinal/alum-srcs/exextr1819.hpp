@@ -12,6 +12,7 @@
 #include "grafo-escena.hpp"
 #include "materiales.hpp"
 #include "MallaRevol.hpp"
+#include "NodoInstancias.hpp"
 
 // examen prács. conv. extraord. 18-19
 
@@ -34,14 +35,19 @@ class PrismaRegP2 : public MallaInd
 
 // -----------------------------------------------------------------------------
 // P3: rejilla de prismas
+// (cada fila repite los mismos prismas, así que se crea una malla por número
+// de lados y la rejilla se dibuja con instancias, ver NodoInstancias.hpp)
 
 class PrismasP3 : public NodoGrafoEscenaParam
 {
    public:
      PrismasP3( const int nf, const int nc);
-     float aniadeFila(const int nf);
+     void aniadeFila(const Matriz4f & mcol);
      void reiniciar();
-     void aniadePrisma(const int ind);
+     void aniadePrisma(const int ind, const Matriz4f & m);
+   private:
+     NodoInstancias * instancias ;
+     std::vector<MallaInd *> mallas ; // mallas[j]: prisma de j+3 lados
 } ;
 
 // -----------------------------------------------------------------------------
@@ -62,7 +68,10 @@ class PrismasP4 : public NodoGrafoEscena
 {
    public:
      PrismasP4( const int nf, const int nc );
-     float aniadeFila(const int nf);
+     void aniadeFila(const Matriz4f & mcol);
+   private:
+     NodoInstancias * instancias ;
+     std::vector<MallaInd *> mallas ; // mallas[j]: prisma de j+3 lados
 } ;
 
 // -----------------------------------------------------------------------------
@@ -45,8 +45,8 @@ EntradaNGE::EntradaNGE( Objeto3D * pObjeto )
 EntradaNGE::EntradaNGE( const Matriz4f & pMatriz )
 {
    tipo    = TipoEntNGE::transformacion ;
-   matriz  = new Matriz4f() ; // matriz en el heap, puntero propietario
-   *matriz = pMatriz ;
+   // matriz en la arena de la escena, o en el heap si no hay ninguna
+   matriz  = new ( Arena_Reservar( sizeof( Matriz4f ) ) ) Matriz4f( pMatriz ) ;
 }
 
 // ---------------------------------------------------------------------
@@ -119,6 +119,7 @@ void NodoGrafoEscena::fijarColorHoja( const Tupla3f & nuevo_color ){
 unsigned NodoGrafoEscena::agregar( const EntradaNGE & entrada )
 {
    entradas.push_back(entrada);
+   matrices_validas = false ;
    return (entradas.size()-1);
 }
 // -----------------------------------------------------------------------------
@@ -150,6 +151,36 @@ Matriz4f * NodoGrafoEscena::leerPtrMatriz( unsigned indice ){
   return resultado;
 }
 // -----------------------------------------------------------------------------
+
+const Matriz4f & NodoGrafoEscena::matrizEntrada( const unsigned i )
+{
+   if ( ! matrices_validas )
+   {
+      Matriz4f mat = MAT_Ident();
+      matrices_entradas.resize( entradas.size() );
+      for( unsigned j = 0 ; j < entradas.size() ; j++ )
+      {  matrices_entradas[j] = mat ;
+         if ( entradas[j].tipo == TipoEntNGE::transformacion )
+            mat = mat*(*entradas[j].matriz) ;
+      }
+      matrices_validas = true ;
+   }
+   return matrices_entradas[i] ;
+}
+// -----------------------------------------------------------------------------
+
+void NodoGrafoEscena::invalidarMatrices()
+{
+   matrices_validas = false ;
+   num_cambios_matrices++ ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned long NodoGrafoEscena::leerNumCambiosMatrices() const
+{
+   return num_cambios_matrices ;
+}
+// -----------------------------------------------------------------------------
 // si 'centro_calculado' es 'false', recalcula el centro usando los centros
 // de los hijos (el punto medio de la caja englobante de los centros de hijos)
 
@@ -173,7 +204,6 @@ bool NodoGrafoEscena::buscarObjeto
 )
 {
   bool salida = false;
-  Matriz4f mTMP = mmodelado;
   if(!centro_calculado){
     calcularCentroOC();
   }
@@ -187,10 +217,7 @@ bool NodoGrafoEscena::buscarObjeto
      bool encontrado = false;
      for(unsigned i=0; i<entradas.size()&&!encontrado; i++){
        if(entradas[i].tipo == TipoEntNGE::objeto){
-         encontrado = entradas[i].objeto->buscarObjeto(ident_busc,mTMP,objeto,centro_wc);
-       }
-       else if(entradas[i].tipo == TipoEntNGE::transformacion){
-         mTMP = mTMP*(*entradas[i].matriz);
+         encontrado = entradas[i].objeto->buscarObjeto(ident_busc,mmodelado*matrizEntrada(i),objeto,centro_wc);
        }
      }
      salida = encontrado;
@@ -248,7 +275,7 @@ Pelota::Pelota(vector <Parametro> *p){
   string mensaje = "Movimiento de la pelota: Botar.";
   p->push_back(Parametro(mensaje, entradas[0].matriz,
               [=](float v){return MAT_Traslacion(0.0,v,0.0);},
-              true, 0.0, 0.5, 0.1));
+              true, 0.0, 0.5, 0.1, this));
   fijarColorNodo(Tupla3f(0.5,0.18,0.18));
 }
 
@@ -304,15 +331,15 @@ LamparaSuperior::LamparaSuperior(vector <Parametro> *p){
   string mensaje = "Rotación a los lados del cabezal del flexo.";
   p->push_back(Parametro(mensaje, entradas[1].matriz,
               [=](float v){return MAT_Rotacion(v,0.0,1.0,0.0);},
-              false, 0.0, 15.0, 0.5));
+              false, 0.0, 15.0, 0.5, this));
   string mensaje2 = "Rotación arriba-abajo del cabezal del flexo.";
   p->push_back(Parametro(mensaje2, entradas[3].matriz,
               [=](float v){return MAT_Rotacion(v,0.0,0.0,1.0);},
-              true, 0.0, 20.0, 0.2));
+              true, 0.0, 20.0, 0.2, this));
   string mensaje3 = "Desplazamiento lateral del cabezal del flexo.";
   p->push_back(Parametro(mensaje3, entradas[0].matriz,
                 [=](float v){return MAT_Traslacion(v,0.0,0.0);},
-                true, 0.0, 0.15, 0.03));
+                true, 0.0, 0.15, 0.03, this));
 }
 
 Lampara::Lampara(){
@@ -31,6 +31,7 @@
 #include "materiales.hpp"
 #include "Objeto3D.hpp"
 #include "Parametro.hpp"
+#include "Arena.hpp"
 #include <vector>
 
 using namespace std ;
@@ -69,9 +70,16 @@ struct EntradaNGE
 class NodoGrafoEscena : public Objeto3D
 {
    protected:
-   std::vector < EntradaNGE > entradas;
+   // las entradas van en la arena de la escena, si la hay (ver Arena.hpp)
+   std::vector < EntradaNGE, AsignadorArena<EntradaNGE> > entradas;
    //Tupla3f color;
 
+   // caché de las matrices de las entradas respecto del nodo (la composición
+   // de las matrices de las entradas anteriores), válida si 'matrices_validas'
+   std::vector < Matriz4f, AsignadorArena<Matriz4f> > matrices_entradas ;
+   bool          matrices_validas     = false ;
+   unsigned long num_cambios_matrices = 0 ;
+
    public:
 
    NodoGrafoEscena() ;
@@ -94,8 +102,19 @@ class NodoGrafoEscena : public Objeto3D
    unsigned agregar( Material * pMaterial ); // material (copia solo puntero)
 
    // devuelve el puntero a la matriz en la i-ésima entrada
+   // (si se cambia la matriz hay que llamar a 'invalidarMatrices')
    Matriz4f * leerPtrMatriz( unsigned iEnt );
 
+   // matriz de modelado de la entrada 'i' respecto del nodo: la composición
+   // de las matrices de las entradas anteriores (se recalcula solo si ha
+   // cambiado alguna matriz del nodo). La usa la búsqueda de objetos
+   const Matriz4f & matrizEntrada( const unsigned i ) ;
+
+   // hay que llamarlo cuando cambia una matriz del nodo (lo hace Parametro):
+   // invalida la caché de matrices del nodo
+   void invalidarMatrices() ;
+   unsigned long leerNumCambiosMatrices() const ;
+
    //asigna los identificadores a todos los objetos del nodo.
    //IMPORTANTE: modifica id
    //Es importante el orden en el que se llama. El último que se tiene que
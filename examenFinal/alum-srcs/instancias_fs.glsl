@@ -0,0 +1,15 @@
+#version 120
+
+// Shader de fragmentos para las instancias (ver instancias_vs.glsl): el
+// color del vértice interpolado, modulado por la textura si la hay
+
+uniform bool      textura ;  // true si está activado GL_TEXTURE_2D
+uniform sampler2D imagen ;   // textura de la unidad 0
+
+void main()
+{
+   vec4 col = gl_Color ;
+   if ( textura )
+      col *= texture2D( imagen, gl_TexCoord[0].st );
+   gl_FragColor = col ;
+}
@@ -0,0 +1,84 @@
+#version 120
+
+// Shader de vértices para dibujar muchas instancias de una malla con una
+// sola llamada (ver NodoInstancias.hpp). Cada instancia tiene su matriz de
+// modelado (respecto del nodo), su color y el color de su identificador.
+// La iluminación y las coordenadas de textura se calculan con el estado
+// del cauce fijo (luces, material, generación de coordenadas), igual que
+// cuando se dibuja cada malla por separado.
+
+attribute mat4 matriz_instancia ; // coords. de la malla -> coords. del nodo
+attribute vec4 color_instancia ;  // color sin iluminación (si alfa es 0, el de la malla)
+attribute vec4 color_ident ;      // identificador codificado como en 'FijarColorIdent'
+
+uniform bool seleccion ;          // true: dibujar el color del identificador
+uniform bool iluminacion ;        // true si está activado GL_LIGHTING
+uniform bool luz_activa[8] ;      // GL_LIGHT0 .. GL_LIGHT7 activadas
+uniform int  modo_gen_ct ;        // 0: sin generación, 1: coords. de objeto, 2: coords. de ojo
+
+// iluminación de un vértice (en coordenadas de ojo), como el cauce fijo
+// con el observador en el infinito y sin focos
+vec4 Iluminar( vec3 pos, vec3 nor )
+{
+   vec4 col = gl_FrontLightModelProduct.sceneColor ;
+   for( int i = 0 ; i < 8 ; i++ )
+   {
+      if ( ! luz_activa[i] )
+         continue ;
+      vec3  l ;
+      float aten = 1.0 ;
+      if ( gl_LightSource[i].position.w == 0.0 )
+         l = normalize( gl_LightSource[i].position.xyz );
+      else
+      {
+         vec3  d    = gl_LightSource[i].position.xyz/gl_LightSource[i].position.w - pos ;
+         float dist = length( d );
+         l    = d/dist ;
+         aten = 1.0/( gl_LightSource[i].constantAttenuation +
+                      gl_LightSource[i].linearAttenuation*dist +
+                      gl_LightSource[i].quadraticAttenuation*dist*dist );
+      }
+      float nl = max( dot( nor, l ), 0.0 );
+      vec4  c  = gl_FrontLightProduct[i].ambient + nl*gl_FrontLightProduct[i].diffuse ;
+      if ( nl > 0.0 )
+      {
+         vec3 h = normalize( l + vec3( 0.0, 0.0, 1.0 ) );
+         c += pow( max( dot( nor, h ), 0.0 ), gl_FrontMaterial.shininess )*gl_FrontLightProduct[i].specular ;
+      }
+      col += aten*c ;
+   }
+   col.a = gl_FrontMaterial.diffuse.a ;
+   return clamp( col, 0.0, 1.0 );
+}
+
+void main()
+{
+   vec4 pos_nodo = matriz_instancia*gl_Vertex ;
+   vec4 pos_ojo  = gl_ModelViewMatrix*pos_nodo ;
+   gl_Position   = gl_ProjectionMatrix*pos_ojo ;
+
+   if ( seleccion )
+   {
+      gl_FrontColor = color_ident ;
+      return ;
+   }
+
+   if ( iluminacion )
+   {
+      // como GL_NORMALIZE (ver NodoInstancias.hpp sobre las matrices)
+      vec3 nor = normalize( gl_NormalMatrix*( mat3( matriz_instancia )*gl_Normal ) );
+      gl_FrontColor = Iluminar( pos_ojo.xyz/pos_ojo.w, nor );
+   }
+   else if ( color_instancia.a > 0.0 )
+      gl_FrontColor = color_instancia ;
+   else
+      gl_FrontColor = gl_Color ;
+
+   // coordenadas de textura: las de la malla o las generadas
+   if ( modo_gen_ct == 1 )
+      gl_TexCoord[0] = vec4( dot( gl_ObjectPlaneS[0], gl_Vertex ), dot( gl_ObjectPlaneT[0], gl_Vertex ), 0.0, 1.0 );
+   else if ( modo_gen_ct == 2 )
+      gl_TexCoord[0] = vec4( dot( gl_EyePlaneS[0], pos_ojo ), dot( gl_EyePlaneT[0], pos_ojo ), 0.0, 1.0 );
+   else
+      gl_TexCoord[0] = gl_MultiTexCoord0 ;
+}
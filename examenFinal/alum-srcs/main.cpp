@@ -30,6 +30,7 @@
 #include "practica3.hpp"
 #include "practica4.hpp"
 #include "practica5.hpp"
+#include "Arena.hpp"
 
 // evita la necesidad de escribir std::
 using namespace std ;
@@ -73,6 +74,11 @@ ContextoVis
 // puntero a función que se ejecuta cuando no hay eventos pendientes
 // (si es null no se hace nada)
 void (*func_desocupado_actual)(void) = nullptr ;
+// arena en la que se crea la escena de la práctica actual (ver Arena.hpp):
+// solo existe la escena de la práctica actual, se crea al pasar a ella y
+// se destruye entera al pasar a otra
+Arena
+   arenaEscena ;
 
 
 // *********************************************************************
@@ -93,6 +99,51 @@ void ErrorGLFW( int codigo, const char * msg )
 }
 
 
+// ---------------------------------------------------------------------
+// crea los objetos de la práctica 'p' en 'arenaEscena'
+
+void InicializarPractica( const int p )
+{
+   using namespace std ;
+   {
+      UsarArena usar( &arenaEscena );
+      switch( p )
+      {
+         case 1 : P1_Inicializar(  ) ; break ;
+         case 2 : P2_Inicializar(  ) ; break ;
+         case 3 : P3_Inicializar(  ) ; break ;
+         case 4 : P4_Inicializar(  ) ; break ;
+         case 5 : P5_Inicializar( ventana_tam_x, ventana_tam_y ) ; break ;
+      }
+   }
+   cout << "práctica " << p << ": escena creada en la arena: "
+        << arenaEscena.numObjetos() << " objetos, "
+        << arenaEscena.bytesUsados()/1024.0 << " KB en "
+        << arenaEscena.numBloques() << " bloques" << endl << flush ;
+}
+
+// ---------------------------------------------------------------------
+// destruye los objetos de la práctica 'p' (todos los de 'arenaEscena') e
+// informa del máximo de memoria que ha usado su escena en la arena
+
+void DestruirPractica( const int p )
+{
+   using namespace std ;
+   const unsigned num_objetos = arenaEscena.numObjetos() ;
+   const size_t   maximo      = arenaEscena.bytesUsados(), // en la arena no se reutiliza memoria
+                  en_bloques  = arenaEscena.bytesBloques() ;
+   const auto     t_inicio    = std::chrono::steady_clock::now();
+
+   arenaEscena.vaciar();
+   // el material activo podía ser de la escena destruida
+   contextoVis.pilaMateriales = PilaMateriales();
+
+   cout << "práctica " << p << ": escena destruida (" << num_objetos << " objetos) en "
+        << std::chrono::duration<double,std::milli>( std::chrono::steady_clock::now() - t_inicio ).count()
+        << " ms, máximo en la arena: " << maximo/1024.0 << " KB ("
+        << en_bloques/1024.0 << " KB en bloques)" << endl << flush ;
+}
+
 // ---------------------------------------------------------------------
 // asigna el color de fondo actual a todos los pixels de la ventana
 
@@ -262,11 +313,16 @@ void FGE_PulsarTeclaCaracter( GLFWwindow* window, unsigned int codepoint )
    {
       case 'Q' :
       case 27  :
-         exit( 0 );
+         // se sale del bucle de eventos, que destruye la escena antes de
+         // cerrar OpenGL
+         terminar_programa = true ;
+         redibujar = false ;
          break ;
       case 'P' :
+         DestruirPractica( practicaActual );
          practicaActual = (practicaActual % numPracticas) +1 ;
          cout << "Práctica actual cambiada a: " << practicaActual << endl << flush ;
+         InicializarPractica( practicaActual );
          if ( practicaActual == 3 )
             FijarFuncDesocupado( FGE_Desocupado );
          break ;
@@ -290,6 +346,10 @@ void FGE_PulsarTeclaCaracter( GLFWwindow* window, unsigned int codepoint )
            cout << "modo de visualización cambiado a: modo inmediato" << endl << flush ;
          }
          break;
+      case 'I':
+         contextoVis.usarInstancias = ! contextoVis.usarInstancias ;
+         cout << "dibujo con instancias: " << (contextoVis.usarInstancias ? "activado" : "desactivado") << endl << flush ;
+         break;
       default:
          redibujar = false;
          switch( practicaActual )
@@ -668,20 +728,8 @@ void Inicializar( int argc, char *argv[] )
    // opengl: define proyección y atributos iniciales
    Inicializa_OpenGL() ;
 
-   // inicializar práctica 1.
-   P1_Inicializar(  ) ;
-
-   // inicializar práctica 2.
-   P2_Inicializar(  ) ;
-
-   // inicializar la práctica 3
-   P3_Inicializar(  );
-
-   // inicializar la práctica 4
-   P4_Inicializar(  );
-
-   // inicializar la práctica 5
-   P5_Inicializar( ventana_tam_x, ventana_tam_y );
+   // inicializar la práctica actual (las demás se crean al pasar a ellas)
+   InicializarPractica( practicaActual );
 }
 
 // ---------------------------------------------------------------------
@@ -716,6 +764,9 @@ void BucleEventosGLFW()
       terminar_programa = terminar_programa || glfwWindowShouldClose( glfw_window ) ;
    }
 
+   // la escena tiene VBOs y texturas: se destruye mientras el contexto de
+   // OpenGL existe (no en el destructor de 'arenaEscena', tras 'glfwTerminate')
+   DestruirPractica( practicaActual );
    glfwTerminate();
 }
 
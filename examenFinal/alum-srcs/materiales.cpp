@@ -24,6 +24,7 @@
 
 #include "matrices-tr.hpp"
 #include "materiales.hpp"
+#include "Arena.hpp"
 
 using namespace std ;
 
@@ -111,7 +112,10 @@ Textura::~Textura( )
       delete imagen ;
 
    imagen = NULL ;
-   cout << "Hecho (no hecho!)" << endl << flush ;
+   // la textura solo existe en OpenGL si se ha enviado
+   if ( enviada )
+      glDeleteTextures( 1, &ident_textura );
+   cout << "Hecho." << endl << flush ;
 }
 
 //----------------------------------------------------------------------
@@ -285,6 +289,16 @@ Material::~Material()
    }
 }
 //----------------------------------------------------------------------
+void * Material::operator new( std::size_t tam )
+{
+   return Arena_Reservar( tam, []( void * p ) { static_cast<Material *>( p )->~Material(); } );
+}
+//----------------------------------------------------------------------
+void Material::operator delete( void * p )
+{
+   Arena_Liberar( p );
+}
+//----------------------------------------------------------------------
 
 void Material::ponerNombre( const std::string & nuevo_nombre )
 {
@@ -528,6 +542,16 @@ ColFuentesLuz::~ColFuentesLuz()
       vpf[i] = NULL ;
    }
 }
+//----------------------------------------------------------------------
+void * ColFuentesLuz::operator new( std::size_t tam )
+{
+   return Arena_Reservar( tam, []( void * p ) { static_cast<ColFuentesLuz *>( p )->~ColFuentesLuz(); } );
+}
+//----------------------------------------------------------------------
+void ColFuentesLuz::operator delete( void * p )
+{
+   Arena_Liberar( p );
+}
 
 ColeccionFuentesP4::ColeccionFuentesP4(){
   const VectorRGB fuenteBlanca = {1.0,1.0,1.0,1.0};
@@ -49,6 +49,10 @@ void P5_Inicializar(  int vp_ancho, int vp_alto )
    // inicializar las variables de la práctica 5 (incluyendo el viewport)
    viewport = Viewport(0.0,0.0, vp_ancho, vp_alto);
    float radio = (float) vp_alto/vp_ancho;
+   // las cámaras no están en la arena de la escena: se destruyen las de la
+   // vez anterior que se inicializó la práctica, si la hay
+   for( int i = 0 ; i < numCamaras ; i++ )
+      delete camaras[i] ;
    camaras[0] = new CamaraInteractiva(false, radio, 0, 0, {0.0,0.0,0.0},true, 80.0,2);
    camaras[1] = new CamaraInteractiva(false, radio, 90, 0, {0.0,0.0,0.0}, true,80.0,2);
    camaras[2] = new CamaraInteractiva(false, radio, 0, -90, {0.0,0.0,0.0}, false,80.0,2);
@@ -59,6 +59,7 @@ class ContextoVis
    bool           modoSeleccionFBO ; // true -> dibujando en modo selección con FBO invisible (puede ser el back-buffer)
    bool           modoSeleccionRB ;  // true -> dibujando en modo selección usando render buffer de opengl
    bool           modoVBO;           // true -> dibujando en modo diferido
+   bool           usarInstancias ;   // true -> dibujar las mallas repetidas con instancias (ver NodoInstancias)
    int            identAct ;         // identificador actual en modo seleccion (nunca -1, >=0), inicialmente 0 antes de raiz
    PilaMateriales pilaMateriales ;   // pila de materiales
    ColFuentesLuz * colFuentes ;      // colección de fuentes de luz activa
@@ -73,6 +74,7 @@ class ContextoVis
       modoSeleccionFBO = false ;
       colFuentes       = nullptr ;
       modoVBO          = false;
+      usarInstancias   = true ;
    }
 
 };
@@ -0,0 +1,119 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: rejillas de prismas con instancias, una a una y como grafo
+// **
+// *********************************************************************
+
+#include <iostream>
+#include "comun.hpp"
+#include "practicas.hpp"
+#include "grafo-escena.hpp"
+#include "matrices-tr.hpp"
+#include "exextr1819.hpp"
+#include "NodoInstancias.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// identificador leído en el centro de la ventana (de 64x64) tras dibujar
+// 'nodo' en modo selección
+
+static int IdentEnCentro( Objeto3D * nodo )
+{
+   ContextoVis cv ;
+   cv.modoVis          = modoSolido ;
+   cv.modoSeleccionFBO = true ;
+   glClearColor( 0.0, 0.0, 0.0, 1.0 );
+   glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+   nodo->visualizarGL( cv );
+
+   unsigned char bytes[3] ;
+   glReadPixels( 32, 32, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, bytes );
+   return bytes[0] + 0x100U*bytes[1] + 0x10000U*bytes[2] ;
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   CrearVentanaOculta( 64, 64 );
+   glMatrixMode( GL_PROJECTION );
+   glLoadIdentity();
+   glOrtho( -1.0, 1.0, -1.0, 1.0, -10.0, 10.0 );
+   glMatrixMode( GL_MODELVIEW );
+   glLoadIdentity();
+   glEnable( GL_DEPTH_TEST );
+
+   // comprobación: las instancias con identificador -1 usan el del nodo,
+   // también si este cambia después de llenar el VBO
+   NodoInstancias * uno   = new NodoInstancias();
+   MallaInd *       cubre = new PrismaRegP2( 4 );
+   uno->agregar( cubre, MAT_Traslacion( 0.0, -0.5, 0.0 )*MAT_Escalado( 4.0, 4.0, 4.0 ) );
+   uno->ponerIdentificador( 5 );
+   const int ident_1 = IdentEnCentro( uno );
+   uno->ponerIdentificador( 7 );
+   const int ident_2 = IdentEnCentro( uno );
+   const bool idents_ok = ident_1 == 5 && ident_2 == 7 ;
+
+   Titulo( "rejillas de prismas: grafo, una a una y con instancias (ms por cuadro, mejor de 5)" );
+
+   // la rejilla queda fuera de la vista: se mide el envío, no el rasterizado
+   glMatrixMode( GL_PROJECTION );
+   glLoadIdentity();
+   glOrtho( 1e5, 1e5+1.0, 0.0, 1.0, -1.0, 1.0 );
+   glMatrixMode( GL_MODELVIEW );
+
+   // como en PrismasP3/P4: una malla por número de lados (de 3 a 12), y
+   // cada fila repite todas las mallas
+   vector<MallaInd *> mallas ;
+   for( int j = 3 ; j <= 12 ; j++ )
+      mallas.push_back( new PrismaRegP2( j ) );
+
+   const unsigned filas[] = { 10, 100, 1000, 10000, 30000 };
+
+   for( const unsigned nf : filas )
+   {
+      // las mismas instancias, en un NodoInstancias y como un nodo del
+      // grafo (con su matriz) por prisma, como antes de NodoInstancias
+      NodoInstancias *  inst  = new NodoInstancias();
+      NodoGrafoEscena * grafo = new NodoGrafoEscena();
+      for( unsigned i = 0 ; i < nf ; i++ )
+      for( unsigned j = 0 ; j < mallas.size() ; j++ )
+      {
+         const Matriz4f m = MAT_Traslacion( 3.0*(j+1), 0.0, -3.0*i );
+         inst->agregar( mallas[j], m );
+         NodoGrafoEscena * nodo = new NodoGrafoEscena();
+         nodo->agregar( m );
+         nodo->agregar( mallas[j] );
+         grafo->agregar( nodo );
+      }
+
+      ContextoVis cv ;
+      cv.modoVis = modoSolido ;
+      cv.modoVBO = true ;
+      auto cuadro = [&]( Objeto3D * obj )
+      {  obj->visualizarGL( cv );
+         glFinish();
+      };
+
+      const double t_grafo = MedirMs( [&](){ cuadro( grafo ); } );
+      cv.usarInstancias = false ;
+      const double t_uno   = MedirMs( [&](){ cuadro( inst ); } );
+      cv.usarInstancias = true ;
+      cuadro( inst ); // (el primer cuadro llena los VBOs de instancias)
+      const double t_inst  = MedirMs( [&](){ cuadro( inst ); } );
+
+      cout << inst->numInstancias() << " prismas (" << inst->numGrupos() << " mallas):" << endl
+           << "   grafo (un nodo por prisma): " << t_grafo << " ms" << endl
+           << "   una a una:                  " << t_uno   << " ms" << endl
+           << "   con instancias:             " << t_inst  << " ms (x" << t_uno/t_inst << ")" << endl ;
+
+      delete inst ;
+   }
+
+   cout << "identificador de las instancias tras cambiar el del nodo: "
+        << ( idents_ok ? "correcto" : "INCORRECTO" )
+        << " (" << ident_1 << ", " << ident_2 << ")" << endl ;
+   return idents_ok ? 0 : 1 ;
+}
@@ -0,0 +1,64 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medidas de tiempos (examen): funciones comunes (implementación)
+// **
+// *********************************************************************
+
+#include <chrono>
+#include <iostream>
+#include "comun.hpp"
+#include "practicas.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+
+double MedirMs( const std::function<void()> & tarea, const unsigned veces )
+{
+   double mejor = 0.0 ;
+   for( unsigned i = 0 ; i < veces ; i++ )
+   {
+      const auto t_inicio = chrono::steady_clock::now();
+      tarea();
+      const double ms = chrono::duration<double,milli>( chrono::steady_clock::now() - t_inicio ).count();
+      if ( i == 0 || ms < mejor )
+         mejor = ms ;
+   }
+   return mejor ;
+}
+// -----------------------------------------------------------------------------
+
+void Titulo( const std::string & titulo )
+{
+   cout << endl << "---------------------------------------------------------------" << endl
+        << titulo << endl
+        << "---------------------------------------------------------------" << endl ;
+}
+// -----------------------------------------------------------------------------
+
+GLFWwindow * CrearVentanaOculta( const int ancho, const int alto )
+{
+   if ( ! glfwInit() )
+   {  cout << "Error: imposible inicializar GLFW." << endl ;
+      exit(1);
+   }
+   glfwWindowHint( GLFW_VISIBLE, GL_FALSE );
+   GLFWwindow * ventana = glfwCreateWindow( ancho, alto, "medidas", nullptr, nullptr );
+   if ( ventana == nullptr )
+   {  cout << "Error: imposible crear ventana." << endl ;
+      glfwTerminate();
+      exit(1);
+   }
+   glfwMakeContextCurrent( ventana );
+   Inicializa_GLEW();
+   return ventana ;
+}
+// -----------------------------------------------------------------------------
+// (definida en practica5.cpp, que no se enlaza: la usa NodoInstancias)
+
+void FijarColorIdent( const int ident )  // 0 ≤ ident < 2^24
+{
+   glColor3ub( ident%0x100U, (ident/0x100U)%0x100U, (ident/0x10000U)%0x100U );
+}
@@ -0,0 +1,29 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medidas de tiempos (examen): funciones comunes (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_BENCH_COMUN_HPP
+#define IG_BENCH_COMUN_HPP
+
+#include <string>
+#include <functional>
+#include "aux.hpp"
+
+// ---------------------------------------------------------------------
+// tiempo, en milisegundos, de la ejecución más rápida de 'tarea' entre
+// 'veces' ejecuciones (la más rápida es la que menos ruido tiene)
+
+double MedirMs( const std::function<void()> & tarea, const unsigned veces = 5 );
+
+// escribe el título de una medida
+void Titulo( const std::string & titulo );
+
+// crea una ventana oculta de 'ancho' x 'alto' pixels y activa su contexto
+// de OpenGL (con GLEW inicializado), para las medidas que visualizan
+GLFWwindow * CrearVentanaOculta( const int ancho = 1024, const int alto = 1024 );
+
+#endif
@@ -0,0 +1,210 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Memoria por escena (arena) para los objetos del grafo (implementación)
+// **
+// *********************************************************************
+
+#include <cstdlib>   // std::malloc, std::free
+#include <cassert>
+#include <new>       // std::bad_alloc
+#include "Arena.hpp"
+
+using namespace std ;
+
+// *****************************************************************************
+// cabecera de cada bloque devuelto por 'Arena_Reservar': dice dónde está el
+// bloque (en qué arena, o en el montón) y si el objeto sigue vivo. Ocupa
+// 16 bytes para que el objeto que va detrás siga alineado a 16
+
+static const size_t alineacion = 16 ;
+
+struct CabeceraArena
+{
+   Arena *  arena ;  // nullptr: bloque en el montón
+   unsigned vivo ;   // 0 si ya se ha destruido con 'delete'
+} ;
+
+static const size_t tam_cabecera =
+   ( sizeof(CabeceraArena) + alineacion - 1 ) / alineacion * alineacion ;
+
+static inline size_t Alinear( const size_t tam )
+{
+   return ( tam + alineacion - 1 ) / alineacion * alineacion ;
+}
+
+static inline CabeceraArena * Cabecera( const void * p )
+{
+   return (CabeceraArena *)( (const char *) p - tam_cabecera );
+}
+
+// arena activa y número de arenas que se están vaciando, en cada hebra
+static thread_local Arena *  arena_actual = nullptr ;
+static thread_local unsigned num_vaciando = 0 ;
+
+// *****************************************************************************
+// Arena
+
+Arena::Arena( const size_t p_tam_bloque )
+{
+   tam_bloque   = Alinear( p_tam_bloque );
+   usado_bloque = 0 ;
+   bytes_usados = 0 ;
+}
+// -----------------------------------------------------------------------------
+
+Arena::~Arena()
+{
+   vaciar();
+}
+// -----------------------------------------------------------------------------
+
+void * Arena::reservar( const size_t tam, FuncFinalizar fin )
+{
+   const size_t tam_al = tam_cabecera + Alinear( tam > 0 ? tam : 1 );
+
+   // pedir un bloque nuevo si no cabe en el actual (los objetos más grandes
+   // que un bloque van en un bloque propio, ajustado a su tamaño)
+   if ( bloques.empty() || usado_bloque + tam_al > bloques.back().tam )
+   {
+      Bloque b ;
+      b.tam   = tam_al > tam_bloque ? tam_al : tam_bloque ;
+      b.datos = (char *) malloc( b.tam );
+      if ( b.datos == nullptr )
+         throw std::bad_alloc();
+      assert( ((size_t) b.datos) % alineacion == 0 );
+      bloques.push_back( b );
+      usado_bloque = 0 ;
+   }
+
+   CabeceraArena * cab = (CabeceraArena *)( bloques.back().datos + usado_bloque );
+   cab->arena = this ;
+   cab->vivo  = 1 ;
+   usado_bloque += tam_al ;
+   bytes_usados += tam_al ;
+
+   void * res = (char *) cab + tam_cabecera ;
+   if ( fin != nullptr )
+      finalizaciones.push_back( { res, fin } );
+   return res ;
+}
+// -----------------------------------------------------------------------------
+
+void Arena::vaciar()
+{
+   // destruir los objetos que sigan vivos, empezando por los últimos creados.
+   // Mientras, los nodos no tocan a sus hijos (que pueden estar ya destruidos)
+   num_vaciando++ ;
+   for( size_t i = finalizaciones.size() ; i > 0 ; i-- )
+   {
+      const Finalizacion & f = finalizaciones[i-1] ;
+      CabeceraArena * cab = Cabecera( f.objeto );
+      if ( cab->vivo )
+      {
+         cab->vivo = 0 ;
+         f.fin( f.objeto );
+      }
+   }
+   num_vaciando-- ;
+   finalizaciones.clear();
+
+   // liberar los bloques, de una vez
+   for( unsigned i = 0 ; i < bloques.size() ; i++ )
+      free( bloques[i].datos );
+   bloques.clear();
+   usado_bloque = 0 ;
+   bytes_usados = 0 ;
+}
+// -----------------------------------------------------------------------------
+
+size_t Arena::bytesUsados() const
+{
+   return bytes_usados ;
+}
+// -----------------------------------------------------------------------------
+
+size_t Arena::bytesBloques() const
+{
+   size_t total = 0 ;
+   for( unsigned i = 0 ; i < bloques.size() ; i++ )
+      total += bloques[i].tam ;
+   return total ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned Arena::numBloques() const
+{
+   return bloques.size() ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned Arena::numObjetos() const
+{
+   unsigned n = 0 ;
+   for( unsigned i = 0 ; i < finalizaciones.size() ; i++ )
+      if ( Cabecera( finalizaciones[i].objeto )->vivo )
+         n++ ;
+   return n ;
+}
+
+// *****************************************************************************
+// arena activa
+
+Arena * Arena_Actual()
+{
+   return arena_actual ;
+}
+// -----------------------------------------------------------------------------
+
+UsarArena::UsarArena( Arena * arena )
+{
+   anterior     = arena_actual ;
+   arena_actual = arena ;
+}
+// -----------------------------------------------------------------------------
+
+UsarArena::~UsarArena()
+{
+   arena_actual = anterior ;
+}
+
+// *****************************************************************************
+// reserva y liberación de bloques con cabecera
+
+void * Arena_Reservar( const size_t tam, FuncFinalizar fin )
+{
+   if ( arena_actual != nullptr )
+      return arena_actual->reservar( tam, fin );
+
+   CabeceraArena * cab = (CabeceraArena *) malloc( tam_cabecera + tam );
+   if ( cab == nullptr )
+      throw std::bad_alloc();
+   cab->arena = nullptr ;
+   cab->vivo  = 1 ;
+   return (char *) cab + tam_cabecera ;
+}
+// -----------------------------------------------------------------------------
+
+void Arena_Liberar( void * p )
+{
+   if ( p == nullptr )
+      return ;
+   CabeceraArena * cab = Cabecera( p );
+   if ( cab->arena == nullptr )
+      free( cab );
+   else
+      cab->vivo = 0 ; // la memoria se recupera al vaciar la arena
+}
+// -----------------------------------------------------------------------------
+
+bool Arena_EnArena( const void * p )
+{
+   return Cabecera( p )->arena != nullptr ;
+}
+// -----------------------------------------------------------------------------
+
+bool Arena_Vaciando()
+{
+   return num_vaciando > 0 ;
+}
@@ -0,0 +1,91 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Jerarquía de cajas englobantes (BVH) para cortar rayos (implementación)
+// **
+// *********************************************************************
+
+#include <algorithm>
+#include "BVH.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+
+BVH::BVH()
+{
+}
+// -----------------------------------------------------------------------------
+
+bool BVH::vacio() const
+{
+   return nodos.empty() ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned BVH::numNodos() const
+{
+   return nodos.size() ;
+}
+// -----------------------------------------------------------------------------
+
+void BVH::construir( const vector<CajaEngf> & cajas )
+{
+   nodos.clear();
+   primitivas.clear();
+
+   // las primitivas con caja vacía no se pueden cortar
+   vector<Tupla3f> centros( cajas.size() );
+   for( unsigned i = 0 ; i < cajas.size() ; i++ )
+      if ( ! cajas[i].vacia )
+      {  primitivas.push_back( i );
+         centros[i] = cajas[i].centro();
+      }
+   if ( primitivas.empty() )
+      return ;
+
+   nodos.reserve( 2*( primitivas.size()/max_hoja + 1 ) );
+   construirNodo( cajas, centros, 0, primitivas.size() );
+}
+// -----------------------------------------------------------------------------
+
+void BVH::construirNodo( const vector<CajaEngf> & cajas, const vector<Tupla3f> & centros,
+                         const unsigned ini, const unsigned fin )
+{
+   // caja del nodo y caja de los centros
+   CajaEngf caja, caja_centros ;
+   for( unsigned i = ini ; i < fin ; i++ )
+   {  caja.unir( cajas[primitivas[i]] );
+      caja_centros.unir( centros[primitivas[i]] );
+   }
+
+   const unsigned actual = nodos.size() ;
+   nodos.push_back( Nodo() );
+   for( unsigned j = 0 ; j < 3 ; j++ )
+   {  nodos[actual].minimo[j] = caja.minimo(j) ;
+      nodos[actual].maximo[j] = caja.maximo(j) ;
+   }
+
+   if ( fin-ini <= max_hoja )
+   {  nodos[actual].indice = ini ;
+      nodos[actual].num    = fin-ini ;
+      return ;
+   }
+
+   // partir por la mediana de los centros en el eje más largo
+   const Tupla3f lados = caja_centros.maximo - caja_centros.minimo ;
+   unsigned eje = 0 ;
+   for( unsigned j = 1 ; j < 3 ; j++ )
+      if ( lados(j) > lados(eje) )
+         eje = j ;
+   const unsigned medio = ini + (fin-ini)/2 ;
+   nth_element( primitivas.begin()+ini, primitivas.begin()+medio, primitivas.begin()+fin,
+                [&]( const unsigned a, const unsigned b )
+                {  return centros[a](eje) < centros[b](eje) ; } );
+
+   nodos[actual].num = 0 ;
+   construirNodo( cajas, centros, ini, medio );
+   nodos[actual].indice = nodos.size() ;
+   construirNodo( cajas, centros, medio, fin );
+}
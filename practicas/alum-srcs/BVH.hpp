@@ -0,0 +1,128 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Jerarquía de cajas englobantes (BVH) para cortar rayos (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_BVH_HPP
+#define IG_BVH_HPP
+
+#include <vector>
+#include "CajaEngf.hpp"
+#include "Rayo.hpp"
+
+// ---------------------------------------------------------------------
+// árbol binario de cajas englobantes sobre un conjunto de primitivas (los
+// triángulos de una malla, las hojas de un grafo de escena, ...) de las que
+// solo se conoce su caja. Sirve para buscar el corte más cercano de un rayo
+// visitando solo las primitivas cuyas cajas corta el rayo.
+//
+// Se construye partiendo cada nodo por la mediana de los centros de sus
+// cajas en el eje más largo, hasta que quedan pocas primitivas. Los nodos
+// van en un vector en preorden: el hijo izquierdo de un nodo interior es el
+// siguiente, y el derecho está en 'indice'.
+
+class BVH
+{
+   public:
+      // primitivas por hoja (como mucho)
+      static const unsigned max_hoja = 4 ;
+
+      BVH() ;
+
+      // (re)construir el árbol para las primitivas 0 .. cajas.size()-1
+      void construir( const std::vector<CajaEngf> & cajas );
+
+      bool     vacio() const ;
+      unsigned numNodos() const ;
+
+      // busca el corte más cercano del rayo antes de 't_max'. Para cada
+      // primitiva cuya caja corta el rayo antes de 't_max', se llama a
+      // 'cortar( primitiva, t_max )', que debe devolver true y reducir
+      // 't_max' si la primitiva corta el rayo antes. Devuelve true si
+      // alguna ha devuelto true
+      template< class FuncCortar >
+      bool intersectar( const Rayo & rayo, float & t_max, FuncCortar cortar ) const ;
+
+   private:
+      struct Nodo
+      {
+         float    minimo[3] ;
+         unsigned indice ; // interior: hijo derecho; hoja: primera primitiva en 'primitivas'
+         float    maximo[3] ;
+         unsigned num ;    // primitivas de la hoja (0 si es un nodo interior)
+      } ;
+
+      std::vector<Nodo>     nodos ;
+      std::vector<unsigned> primitivas ; // índices de primitivas, seguidos por hojas
+
+      // construye el nodo de las primitivas [ini,fin) de 'primitivas'
+      // (los centros y cajas son los de todas las primitivas)
+      void construirNodo( const std::vector<CajaEngf> & cajas,
+                          const std::vector<Tupla3f> & centros,
+                          const unsigned ini, const unsigned fin );
+} ;
+
+// ---------------------------------------------------------------------
+
+template< class FuncCortar >
+bool BVH::intersectar( const Rayo & rayo, float & t_max, FuncCortar cortar ) const
+{
+   if ( nodos.empty() )
+      return false ;
+
+   float t_ent ;
+   if ( ! Rayo_CortaCaja( rayo, nodos[0].minimo, nodos[0].maximo, t_max, t_ent ) )
+      return false ;
+
+   // pila de nodos pendientes (la profundidad no pasa de 64 con la mediana)
+   unsigned pila[64] ;
+   unsigned num_pila = 0 ;
+   unsigned actual   = 0 ;
+   bool     cortado  = false ;
+
+   while ( true )
+   {
+      const Nodo & n = nodos[actual] ;
+      if ( n.num > 0 )
+      {  for( unsigned i = n.indice ; i < n.indice+n.num ; i++ )
+            if ( cortar( primitivas[i], t_max ) )
+               cortado = true ;
+      }
+      else
+      {  // visitar antes el hijo cuya caja corta antes el rayo
+         const unsigned izq = actual+1, der = n.indice ;
+         float t_izq, t_der ;
+         const bool c_izq = Rayo_CortaCaja( rayo, nodos[izq].minimo, nodos[izq].maximo, t_max, t_izq ),
+                    c_der = Rayo_CortaCaja( rayo, nodos[der].minimo, nodos[der].maximo, t_max, t_der );
+         if ( c_izq && c_der )
+         {  if ( t_der < t_izq )
+            {  pila[num_pila++] = izq ;
+               actual = der ;
+            }
+            else
+            {  pila[num_pila++] = der ;
+               actual = izq ;
+            }
+            continue ;
+         }
+         else if ( c_izq || c_der )
+         {  actual = c_izq ? izq : der ;
+            continue ;
+         }
+      }
+      // siguiente pendiente (se descarta si ya hay un corte más cercano)
+      bool siguiente = false ;
+      while ( num_pila > 0 && ! siguiente )
+      {  actual    = pila[--num_pila] ;
+         siguiente = Rayo_CortaCaja( rayo, nodos[actual].minimo, nodos[actual].maximo, t_max, t_ent );
+      }
+      if ( ! siguiente )
+         break ;
+   }
+   return cortado ;
+}
+
+#endif
@@ -0,0 +1,270 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Buffer de selección de una región de la ventana (implementación)
+// **
+// *********************************************************************
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include "matrices-tr.hpp"
+#include "Objeto3D.hpp"
+#include "PiramideVision.hpp"
+#include "Paralelo.hpp"
+#include "BufferSeleccion.hpp"
+
+// -----------------------------------------------------------------------------
+
+static bool MismaMatriz( const Matriz4f & a, const Matriz4f & b )
+{
+   const float * pa = a, * pb = b ;
+   return std::equal( pa, pa+16, pb );
+}
+// -----------------------------------------------------------------------------
+// los PBOs y las vallas necesitan el contexto de OpenGL ya creado
+
+BufferSeleccion::BufferSeleccion( const int p_lado )
+{
+   lado    = p_lado ;
+   usarPBO = ( GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object ) &&
+             ( GLEW_VERSION_3_2 || GLEW_ARB_sync );
+}
+// -----------------------------------------------------------------------------
+
+BufferSeleccion::~BufferSeleccion()
+{
+   if ( valla != 0 )
+      glDeleteSync( valla );
+   if ( pbo != 0 )
+      glDeleteBuffers( 1, &pbo );
+}
+// -----------------------------------------------------------------------------
+
+void BufferSeleccion::invalidar()
+{
+   pedida = false ;
+}
+// -----------------------------------------------------------------------------
+// la caja de la escena se calcula antes de mirar sus invalidaciones (como en
+// NodoGrafoEscena::compilarCola), así cualquier cambio posterior las aumenta
+
+bool BufferSeleccion::mismaVista( Objeto3D * p_escena, const Camara & camara, const Viewport & vp )
+{
+   p_escena->cajaEnglobante();
+   return escena == p_escena &&
+          invalidaciones == p_escena->leerNumInvalidaciones() &&
+          estructura == p_escena->leerNumCambiosEstructura() &&
+          MismaMatriz( vista, camara.mcv.matrizVista ) &&
+          MismaMatriz( proy, camara.vf.matrizProy ) &&
+          vp_x == vp.org_x && vp_y == vp.org_y &&
+          vp_ancho == vp.ancho && vp_alto == vp.alto ;
+}
+// -----------------------------------------------------------------------------
+
+bool BufferSeleccion::contiene( const int xa, const int ya, const int xb, const int yb ) const
+{
+   return x0 <= xa && xb < x0+ancho && y0 <= ya && yb < y0+alto ;
+}
+// -----------------------------------------------------------------------------
+
+bool BufferSeleccion::solicitar( Objeto3D * p_escena, const Camara & camara,
+                                 const Viewport & vp, const int x, const int y )
+{
+   if ( pedida && mismaVista( p_escena, camara, vp ) && contiene( x, y, x, y ) )
+      return false ;
+
+   // región centrada en (x,y), dentro del viewport
+   ancho = std::min( lado, vp.ancho );
+   alto  = std::min( lado, vp.alto );
+   x0    = std::max( vp.org_x, std::min( x - ancho/2, vp.org_x + vp.ancho - ancho ) );
+   y0    = std::max( vp.org_y, std::min( y - alto/2,  vp.org_y + vp.alto  - alto  ) );
+   visualizarRegion( p_escena, camara, vp );
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+bool BufferSeleccion::solicitarRectangulo( Objeto3D * p_escena, const Camara & camara,
+                                           const Viewport & vp, const int xa, const int ya,
+                                           const int xb, const int yb )
+{
+   const int xmin = std::max( std::min( xa, xb ), vp.org_x ),
+             xmax = std::min( std::max( xa, xb ), vp.org_x + vp.ancho - 1 ),
+             ymin = std::max( std::min( ya, yb ), vp.org_y ),
+             ymax = std::min( std::max( ya, yb ), vp.org_y + vp.alto - 1 );
+   if ( xmax < xmin || ymax < ymin )
+      return false ;
+   if ( pedida && mismaVista( p_escena, camara, vp ) && contiene( xmin, ymin, xmax, ymax ) )
+      return false ;
+
+   x0    = xmin ;
+   y0    = ymin ;
+   ancho = xmax-xmin+1 ;
+   alto  = ymax-ymin+1 ;
+   visualizarRegion( p_escena, camara, vp );
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+void BufferSeleccion::visualizarRegion( Objeto3D * p_escena, const Camara & camara,
+                                        const Viewport & vp )
+{
+   escena         = p_escena ;
+   escena->cajaEnglobante();
+   invalidaciones = escena->leerNumInvalidaciones();
+   estructura     = escena->leerNumCambiosEstructura();
+   vista          = camara.mcv.matrizVista ;
+   proy           = camara.vf.matrizProy ;
+   vp_x     = vp.org_x ;  vp_y    = vp.org_y ;
+   vp_ancho = vp.ancho ;  vp_alto = vp.alto ;
+
+   // pirámide de visión de la región: la proyección seguida de la
+   // transformación que lleva la región al cuadrado [-1,1]x[-1,1] (como
+   // 'gluPickMatrix'). Solo se usa para descartar hojas
+   const float cx = 2.0f*( x0 - vp.org_x + 0.5f*ancho )/vp.ancho - 1.0f,
+               cy = 2.0f*( y0 - vp.org_y + 0.5f*alto  )/vp.alto  - 1.0f ;
+   const Matriz4f region = MAT_Escalado( float(vp.ancho)/ancho, float(vp.alto)/alto, 1.0 )*
+                           MAT_Traslacion( -cx, -cy, 0.0 );
+
+   ContextoVis cv ;
+   cv.modoSeleccionFBO = true ;
+   cv.modoVis          = modoSolido ;
+   cv.piramideVision   = PiramideVision( region*proy, vista );
+
+   // visualizar solo en la región (sobre el backbuffer)
+   glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_SCISSOR_BIT | GL_VIEWPORT_BIT );
+   glViewport( vp.org_x, vp.org_y, vp.ancho, vp.alto );
+   glMatrixMode( GL_PROJECTION );
+   glLoadMatrixf( proy );
+   glMatrixMode( GL_MODELVIEW );
+   glLoadMatrixf( vista );
+
+   glEnable( GL_SCISSOR_TEST );
+   glScissor( x0, y0, ancho, alto );
+   glEnable( GL_DEPTH_TEST );
+   glDisable( GL_LIGHTING );
+   glDisable( GL_TEXTURE_2D );
+   glDisable( GL_BLEND );
+   glDisable( GL_DITHER );
+   glClearColor( 0.0, 0.0, 0.0, 1.0 );
+   glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+   escena->visualizarGL( cv );
+   glPopAttrib();
+
+   // leer la región: en el PBO sin esperar, o directamente
+   if ( valla != 0 )
+   {  glDeleteSync( valla );
+      valla = 0 ;
+   }
+   const unsigned tam = 4*ancho*alto ;
+   if ( usarPBO )
+   {
+      if ( pbo == 0 )
+         glGenBuffers( 1, &pbo );
+      glBindBuffer( GL_PIXEL_PACK_BUFFER, pbo );
+      if ( tam_pbo < tam )
+      {  tam_pbo = std::max( tam, unsigned( 4*lado*lado ) );
+         glBufferData( GL_PIXEL_PACK_BUFFER, tam_pbo, nullptr, GL_STREAM_READ );
+      }
+      glReadPixels( x0, y0, ancho, alto, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+      glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+      valla     = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+      pendiente = true ;
+   }
+   else
+   {
+      std::vector<unsigned char> bytes( tam );
+      glReadPixels( x0, y0, ancho, alto, GL_RGBA, GL_UNSIGNED_BYTE, bytes.data() );
+      copiar( bytes.data() );
+      pendiente = false ;
+   }
+   pedida = true ;
+}
+// -----------------------------------------------------------------------------
+
+bool BufferSeleccion::terminarLectura( const bool esperar )
+{
+   if ( ! pendiente )
+      return true ;
+
+   // (la orden de vaciar la cola de OpenGL hace que la valla llegue a
+   // señalarse aunque no se espere)
+   GLenum res ;
+   do
+      res = glClientWaitSync( valla, GL_SYNC_FLUSH_COMMANDS_BIT, esperar ? 1000000000 : 0 );
+   while ( esperar && res == GL_TIMEOUT_EXPIRED );
+   if ( res == GL_TIMEOUT_EXPIRED )
+      return false ;
+   glDeleteSync( valla );
+   valla = 0 ;
+
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, pbo );
+   const unsigned char * bytes = (const unsigned char *) glMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY );
+   if ( bytes != nullptr )
+   {  copiar( bytes );
+      glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+   }
+   else
+      idents.assign( ancho*alto, 0 );
+   glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+   pendiente = false ;
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+bool BufferSeleccion::leer( const int x, const int y, const bool esperar, int & ident )
+{
+   if ( ! pedida || ! terminarLectura( esperar ) || ! contiene( x, y, x, y ) )
+      return false ;
+   ident = idents[ (y-y0)*ancho + (x-x0) ] ;
+   return true ;
+}
+// -----------------------------------------------------------------------------
+// cada hebra cuenta los pixels de un trozo en su propia tabla, y las tablas
+// se juntan al final (hay pocos identificadores distintos)
+
+bool BufferSeleccion::histograma( const int xa, const int ya, const int xb, const int yb,
+                                  const bool esperar, std::vector< std::pair<int,unsigned> > & cuenta )
+{
+   cuenta.clear();
+   if ( ! pedida || ! terminarLectura( esperar ) )
+      return false ;
+
+   const int xmin = std::max( std::min( xa, xb ), x0 ),
+             xmax = std::min( std::max( xa, xb ), x0+ancho-1 ),
+             ymin = std::max( std::min( ya, yb ), y0 ),
+             ymax = std::min( std::max( ya, yb ), y0+alto-1 );
+   if ( xmax < xmin || ymax < ymin )
+      return true ;
+
+   const unsigned long ancho_r = xmax-xmin+1, num = ancho_r*(ymax-ymin+1) ;
+   std::unordered_map<int,unsigned> total ;
+   std::mutex                       cerrojo ;
+   EnParalelo( num, [&]( unsigned long ini, unsigned long fin )
+   {  std::unordered_map<int,unsigned> parcial ;
+      for( unsigned long p = ini ; p < fin ; p++ )
+      {  const int id = idents[ ( ymin-y0 + p/ancho_r )*ancho + ( xmin-x0 + p%ancho_r ) ] ;
+         if ( id > 0 )
+            parcial[id]++ ;
+      }
+      std::lock_guard<std::mutex> bloqueo( cerrojo );
+      for( const auto & c : parcial )
+         total[c.first] += c.second ;
+   });
+
+   cuenta.assign( total.begin(), total.end() );
+   std::sort( cuenta.begin(), cuenta.end() );
+   return true ;
+}
+// -----------------------------------------------------------------------------
+// el identificador va en el color (ver FijarColorIdent): rojo el byte menos
+// significativo, azul el más significativo
+
+void BufferSeleccion::copiar( const unsigned char * bytes )
+{
+   idents.resize( ancho*alto );
+   for( int i = 0 ; i < ancho*alto ; i++ )
+      idents[i] = bytes[4*i] + 0x100*bytes[4*i+1] + 0x10000*bytes[4*i+2] ;
+}
@@ -0,0 +1,103 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Buffer de selección de una región de la ventana (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_BUFFERSELECCION_HPP
+#define IG_BUFFERSELECCION_HPP
+
+#include <vector>
+#include <utility>
+#include "aux.hpp"
+#include "Camara.hpp"
+
+class Objeto3D ;
+
+// ---------------------------------------------------------------------
+// identificadores de los pixels de una región pequeña de la ventana,
+// alrededor del cursor: para seleccionar (y resaltar el objeto bajo el
+// cursor) no hace falta visualizar toda la escena en modo selección.
+//
+// - Solo se limpia y se dibuja la región (con 'glScissor'), y solo se
+//   visitan las hojas que caen dentro (con la pirámide de visión de la
+//   región). En modo selección no se activan materiales, iluminación ni
+//   texturas, y las mallas solo envían las posiciones.
+// - La región se lee en un 'pixel buffer object' y se pone una valla
+//   ('glFenceSync'): la lectura no para la CPU hasta que hacen falta los
+//   identificadores (ver 'leer'). Sin PBOs se lee directamente.
+// - La región leída se guarda: mientras no cambien la cámara, el viewport
+//   ni la escena (sus invalidaciones y cambios de estructura), los pixels
+//   que caen dentro no se vuelven a visualizar.
+//
+// Para seleccionar con un rectángulo, la región es el rectángulo (se lee
+// entero de una vez) y se cuentan los pixels de cada identificador.
+
+class BufferSeleccion
+{
+   public:
+      // 'p_lado' es el lado de la región, en pixels
+      BufferSeleccion( const int p_lado = 32 );
+      ~BufferSeleccion();
+
+      // visualizar 'escena' en modo selección con 'camara' en la región de
+      // 'vp' centrada en (x,y) (sobre el buffer trasero) y empezar a leerla.
+      // No hace nada si (x,y) está en la región guardada o pedida y no ha
+      // cambiado nada. Devuelve true si ha visualizado
+      bool solicitar( Objeto3D * escena, const Camara & camara, const Viewport & vp,
+                      const int x, const int y );
+
+      // igual, pero la región es el rectángulo con esquinas opuestas (xa,ya)
+      // y (xb,yb) (incluidas), recortado al viewport
+      bool solicitarRectangulo( Objeto3D * escena, const Camara & camara, const Viewport & vp,
+                                const int xa, const int ya, const int xb, const int yb );
+
+      // identificador del pixel (x,y) de la última región pedida. Si la
+      // lectura no ha terminado, espera si 'esperar' es true y si no
+      // devuelve false (también si (x,y) no está en la región)
+      bool leer( const int x, const int y, const bool esperar, int & ident );
+
+      // identificadores (mayores que 0) de los pixels del rectángulo con
+      // esquinas (xa,ya) y (xb,yb) que están en la última región pedida, de
+      // menor a mayor, con el número de pixels de cada uno. Se cuentan en
+      // paralelo (ver EnParalelo). Espera como 'leer'
+      bool histograma( const int xa, const int ya, const int xb, const int yb,
+                       const bool esperar, std::vector< std::pair<int,unsigned> > & cuenta );
+
+      // true si la región pedida no se ha terminado de leer
+      bool lecturaPendiente() const { return pendiente ; }
+
+      // olvidar la región guardada
+      void invalidar();
+
+   private:
+      int lado ;
+      int x0 = 0, y0 = 0, ancho = 0, alto = 0 ; // región pedida (en pixels del viewport)
+      bool pedida = false ,    // hay una región pedida (leída o no)
+           pendiente = false ; // la región pedida no se ha leído todavía
+      std::vector<int> idents ; // identificadores de la región leída, por filas
+
+      // lo que se usó para visualizar la región
+      Objeto3D *    escena = nullptr ;
+      Matriz4f      vista, proy ;
+      int           vp_x = 0, vp_y = 0, vp_ancho = 0, vp_alto = 0 ;
+      unsigned long invalidaciones = 0, estructura = 0 ;
+
+      // PBO (y su tamaño en bytes) y valla de la lectura pendiente
+      bool     usarPBO ;
+      GLuint   pbo = 0 ;
+      unsigned tam_pbo = 0 ;
+      GLsync   valla = 0 ;
+
+      bool mismaVista( Objeto3D * p_escena, const Camara & camara, const Viewport & vp );
+      bool contiene( const int xa, const int ya, const int xb, const int yb ) const ;
+      // visualizar la región (x0,y0,ancho,alto) y empezar a leerla
+      void visualizarRegion( Objeto3D * p_escena, const Camara & camara, const Viewport & vp );
+      // terminar la lectura pendiente, si la hay (false si no ha terminado)
+      bool terminarLectura( const bool esperar );
+      void copiar( const unsigned char * bytes );
+} ;
+
+#endif
@@ -0,0 +1,231 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Caché en disco de mallas indexadas ya construidas (.mallabin)
+// **
+// *********************************************************************
+
+#include <cstdio>     // rename, remove
+#include <cstring>    // memcmp, memcpy
+#include <cstdint>    // uint32_t, uint64_t
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <fcntl.h>    // open
+#include <unistd.h>   // close, getpid
+#include <sys/stat.h> // stat, mkdir
+#include <sys/mman.h> // mmap, munmap
+#include "CacheMallas.hpp"
+
+using namespace std ;
+
+// *****************************************************************************
+// constantes y tipos auxiliares
+
+static const char *   carpeta_cache = "../cache" ; // relativa a 'alum-srcs', como '../plys'
+static const char     magia_cache[8] = { 'I','G','M','A','L','L','A', 0 } ;
+static const uint32_t version_cache = 1 ;
+static const uint32_t orden_bytes   = 0x01020304 ; // para detectar cachés de otra arquitectura
+static const unsigned num_tablas    = 6 ;
+
+// las mallas se pueden construir en hebras secundarias (ver CargaDiferida.hpp),
+// así que los contadores son atómicos
+static std::atomic<unsigned> num_leidas( 0 ) ;    // mallas leídas de la caché desde el último informe
+static std::atomic<unsigned> num_generadas( 0 ) ; // mallas generadas (y guardadas) desde el último informe
+static std::atomic<unsigned> num_temporales( 0 ) ; // para dar nombres distintos a los temporales
+
+struct CabeceraCache
+{
+   char     magia[8] ;
+   uint32_t version ;
+   uint32_t orden ;
+   uint32_t tam_clave ;           // bytes de la clave (sin terminador)
+   uint32_t num[num_tablas] ;     // número de elementos de cada tabla
+} ;
+
+// tamaño de los elementos de cada tabla, en el orden en que se guardan:
+// vertices, caras, normales_vertices, normales_caras, col_ver, cctt
+static const size_t tam_elem[num_tablas] =
+   { sizeof(Tupla3f), sizeof(Tupla3i), sizeof(Tupla3f), sizeof(Tupla3f), sizeof(Tupla3f), sizeof(Tupla2f) } ;
+
+// -----------------------------------------------------------------------------
+// copia 'num' elementos desde 'src' a una tabla, devuelve los bytes leídos
+
+template< class T >
+static size_t LeerTabla( const char * src, const uint32_t num, std::vector<T> * tabla )
+{
+   tabla->resize( num );
+   if ( num > 0 )
+      memcpy( (void *) tabla->data(), src, num*sizeof(T) );
+   return num*sizeof(T) ;
+}
+
+// -----------------------------------------------------------------------------
+// escribe los elementos de una tabla
+
+template< class T >
+static void EscribirTabla( ofstream & dst, const std::vector<T> * tabla )
+{
+   if ( tabla->size() > 0 )
+      dst.write( (const char *) tabla->data(), streamsize( tabla->size()*sizeof(T) ) );
+}
+
+// -----------------------------------------------------------------------------
+// desplazamiento de las tablas tras la cabecera y la clave (alineado a 16)
+
+static size_t InicioTablas( const size_t tam_clave )
+{
+   return ( sizeof(CabeceraCache) + tam_clave + 15 ) & ~size_t(15) ;
+}
+
+// -----------------------------------------------------------------------------
+// nombre del archivo de la caché: hash FNV-1a (64 bits) de la clave
+
+static string ArchivoCache( const string & clave )
+{
+   uint64_t h = 14695981039346656037ULL ;
+   for( unsigned i = 0 ; i < clave.size() ; i++ )
+   {  h ^= (unsigned char) clave[i] ;
+      h *= 1099511628211ULL ;
+   }
+   char hex[17] ;
+   snprintf( hex, sizeof(hex), "%016llx", (unsigned long long) h );
+   return string(carpeta_cache) + "/" + hex + ".mallabin" ;
+}
+
+// *****************************************************************************
+
+std::string CacheMalla_Clave( const std::string & ruta_fuente, const std::string & parametros )
+{
+   string clave = "v" + to_string( version_cache ) + "|" + parametros ;
+
+   if ( ruta_fuente != "" )
+   {
+      struct stat info ;
+      if ( stat( ruta_fuente.c_str(), &info ) != 0 )
+         return "" ;
+      clave += "|" + ruta_fuente + "|" + to_string( (long long) info.st_mtime ) +
+               "|" + to_string( (long long) info.st_size ) ;
+   }
+   return clave ;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CacheMalla_Leer( const std::string & clave, TablasMalla & tablas )
+{
+   if ( clave == "" )
+      return false ;
+
+   const string nombre = ArchivoCache( clave );
+   const int    fd     = open( nombre.c_str(), O_RDONLY );
+   if ( fd < 0 )
+      return false ;
+
+   struct stat info ;
+   if ( fstat( fd, &info ) != 0 || size_t(info.st_size) < sizeof(CabeceraCache) )
+   {  close( fd );
+      return false ;
+   }
+   const size_t tam  = size_t( info.st_size );
+   void *       ptr  = mmap( nullptr, tam, PROT_READ, MAP_PRIVATE, fd, 0 );
+   close( fd );
+   if ( ptr == MAP_FAILED )
+      return false ;
+
+   const char *          datos = (const char *) ptr ;
+   const CabeceraCache * cab   = (const CabeceraCache *) datos ;
+   bool                  valida ;
+
+   // comprobar cabecera, clave y tamaño total antes de copiar nada
+   valida = memcmp( cab->magia, magia_cache, sizeof(magia_cache) ) == 0 &&
+            cab->version == version_cache && cab->orden == orden_bytes &&
+            cab->tam_clave == clave.size() &&
+            sizeof(CabeceraCache)+clave.size() <= tam &&
+            memcmp( datos+sizeof(CabeceraCache), clave.data(), clave.size() ) == 0 ;
+
+   size_t fin = InicioTablas( clave.size() );
+   for( unsigned i = 0 ; i < num_tablas && valida ; i++ )
+      fin += size_t( cab->num[i] )*tam_elem[i] ;
+   valida = valida && fin <= tam ;
+
+   if ( valida )
+   {
+      const char * p = datos + InicioTablas( clave.size() );
+      p += LeerTabla( p, cab->num[0], tablas.vertices );
+      p += LeerTabla( p, cab->num[1], tablas.caras );
+      p += LeerTabla( p, cab->num[2], tablas.normales_vertices );
+      p += LeerTabla( p, cab->num[3], tablas.normales_caras );
+      p += LeerTabla( p, cab->num[4], tablas.col_ver );
+      p += LeerTabla( p, cab->num[5], tablas.cctt );
+      num_leidas++ ;
+   }
+   munmap( ptr, tam );
+   return valida ;
+}
+
+// -----------------------------------------------------------------------------
+
+void CacheMalla_Guardar( const std::string & clave, const TablasMalla & tablas )
+{
+   num_generadas++ ;
+   if ( clave == "" )
+      return ;
+
+   mkdir( carpeta_cache, 0755 ); // si ya existe no pasa nada
+
+   // se escribe en un temporal y se renombra, así nunca se lee un archivo a medias
+   // (el temporal es distinto en cada llamada, varias hebras pueden estar
+   // guardando a la vez la misma malla)
+   const string nombre     = ArchivoCache( clave ),
+                nombre_tmp = nombre + "." + to_string( (long long) getpid() ) + "-" +
+                             to_string( num_temporales++ ) + ".tmp" ;
+   ofstream     dst( nombre_tmp.c_str(), ios::out | ios::binary | ios::trunc );
+
+   if ( ! dst.is_open() )
+   {  cout << "aviso: no se puede escribir la caché de mallas en '" << nombre_tmp << "'" << endl ;
+      return ;
+   }
+
+   CabeceraCache cab ;
+   const char    relleno[16] = { 0 } ;
+
+   memcpy( cab.magia, magia_cache, sizeof(magia_cache) );
+   cab.version   = version_cache ;
+   cab.orden     = orden_bytes ;
+   cab.tam_clave = uint32_t( clave.size() );
+   cab.num[0]    = uint32_t( tablas.vertices->size() );
+   cab.num[1]    = uint32_t( tablas.caras->size() );
+   cab.num[2]    = uint32_t( tablas.normales_vertices->size() );
+   cab.num[3]    = uint32_t( tablas.normales_caras->size() );
+   cab.num[4]    = uint32_t( tablas.col_ver->size() );
+   cab.num[5]    = uint32_t( tablas.cctt->size() );
+
+   dst.write( (const char *) &cab, sizeof(cab) );
+   dst.write( clave.data(), clave.size() );
+   dst.write( relleno, InicioTablas( clave.size() ) - sizeof(cab) - clave.size() );
+   EscribirTabla( dst, tablas.vertices );
+   EscribirTabla( dst, tablas.caras );
+   EscribirTabla( dst, tablas.normales_vertices );
+   EscribirTabla( dst, tablas.normales_caras );
+   EscribirTabla( dst, tablas.col_ver );
+   EscribirTabla( dst, tablas.cctt );
+   dst.close();
+
+   if ( ! dst || rename( nombre_tmp.c_str(), nombre.c_str() ) != 0 )
+   {  remove( nombre_tmp.c_str() );
+      cout << "aviso: no se puede escribir la caché de mallas en '" << nombre << "'" << endl ;
+   }
+}
+
+// -----------------------------------------------------------------------------
+
+void CacheMalla_Informe( const std::string & fase, const double segundos )
+{
+   const unsigned leidas = num_leidas.exchange( 0 ), generadas = num_generadas.exchange( 0 );
+
+   cout << fase << ": " << segundos << " seg. (mallas leídas de la caché: " << leidas
+        << ", generadas: " << generadas << ", arranque "
+        << ( generadas == 0 && leidas > 0 ? "en caliente" : "en frío" ) << ")" << endl ;
+}
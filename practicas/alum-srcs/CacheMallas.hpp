@@ -0,0 +1,53 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Caché en disco de mallas indexadas ya construidas (.mallabin)
+// **
+// *********************************************************************
+
+#ifndef IG_CACHEMALLAS_HPP
+#define IG_CACHEMALLAS_HPP
+
+#include <string>
+#include <vector>
+#include <tuplasg.hpp>
+
+// ---------------------------------------------------------------------
+// Cada malla se guarda en un archivo '<carpeta_cache>/<hash de la clave>.mallabin'
+// con una cabecera (versión, orden de bytes, tamaños), la clave completa
+// (para descartar colisiones del hash) y las tablas tal cual están en memoria.
+// La clave incluye la ruta del archivo fuente, su fecha de modificación y
+// tamaño, y los parámetros con los que se genera la malla. Si cambia el
+// formato o el código que genera las mallas hay que incrementar
+// 'version_cache' en CacheMallas.cpp.
+
+// tablas de una malla indexada que se guardan y se leen de la caché
+struct TablasMalla
+{
+   std::vector<Tupla3f> * vertices ;
+   std::vector<Tupla3i> * caras ;
+   std::vector<Tupla3f> * normales_vertices ;
+   std::vector<Tupla3f> * normales_caras ;
+   std::vector<Tupla3f> * col_ver ;
+   std::vector<Tupla2f> * cctt ;
+} ;
+
+// construye la clave de una malla generada a partir de 'ruta_fuente'
+// (puede ser vacía si la malla es procedural) con unos 'parametros'.
+// Devuelve una cadena vacía si no se puede acceder al archivo fuente
+// (en ese caso no se usa la caché)
+std::string CacheMalla_Clave( const std::string & ruta_fuente, const std::string & parametros );
+
+// lee de la caché las tablas de la malla con esa clave (proyectando el
+// archivo en memoria). Devuelve false si no está (o no es válida)
+bool CacheMalla_Leer( const std::string & clave, TablasMalla & tablas );
+
+// guarda en la caché las tablas de una malla recién construida
+void CacheMalla_Guardar( const std::string & clave, const TablasMalla & tablas );
+
+// escribe en 'cout' el número de mallas leídas de la caché y generadas
+// desde el último informe, y el tiempo indicado
+void CacheMalla_Informe( const std::string & fase, const double segundos );
+
+#endif
@@ -0,0 +1,76 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Cajas englobantes alineadas con los ejes (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <algorithm>
+#include "CajaEngf.hpp"
+
+// -----------------------------------------------------------------------------
+
+CajaEngf::CajaEngf()
+{
+   minimo = maximo = Tupla3f( 0.0, 0.0, 0.0 );
+   vacia  = true ;
+}
+// -----------------------------------------------------------------------------
+
+CajaEngf::CajaEngf( const Tupla3f & pmin, const Tupla3f & pmax )
+{
+   minimo = pmin ;
+   maximo = pmax ;
+   vacia  = false ;
+}
+// -----------------------------------------------------------------------------
+
+void CajaEngf::unir( const CajaEngf & otra )
+{
+   if ( otra.vacia )
+      return ;
+   if ( vacia )
+   {  *this = otra ;
+      return ;
+   }
+   for( unsigned i = 0 ; i < 3 ; i++ )
+   {  minimo(i) = std::min( minimo(i), otra.minimo(i) );
+      maximo(i) = std::max( maximo(i), otra.maximo(i) );
+   }
+}
+// -----------------------------------------------------------------------------
+
+void CajaEngf::unir( const Tupla3f & punto )
+{
+   unir( CajaEngf( punto, punto ) );
+}
+// -----------------------------------------------------------------------------
+
+Tupla3f CajaEngf::centro() const
+{
+   if ( vacia )
+      return Tupla3f( 0.0, 0.0, 0.0 );
+   return (minimo+maximo)*0.5f ;
+}
+// -----------------------------------------------------------------------------
+
+CajaEngf CajaEngf::transformada( const Matriz4f & m ) const
+{
+   if ( vacia )
+      return CajaEngf();
+
+   const Tupla3f c = centro(),
+                 s = (maximo-minimo)*0.5f ;
+   Tupla3f       c_nuevo, s_nuevo ;
+   for( unsigned i = 0 ; i < 3 ; i++ )
+   {  c_nuevo(i) = m(i,3) ;
+      s_nuevo(i) = 0.0f ;
+      for( unsigned j = 0 ; j < 3 ; j++ )
+      {  c_nuevo(i) += m(i,j)*c(j) ;
+         s_nuevo(i) += std::fabs( m(i,j) )*s(j) ;
+      }
+   }
+   return CajaEngf( c_nuevo-s_nuevo, c_nuevo+s_nuevo );
+}
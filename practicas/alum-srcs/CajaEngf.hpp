@@ -0,0 +1,43 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Cajas englobantes alineadas con los ejes (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_CAJAENGF_HPP
+#define IG_CAJAENGF_HPP
+
+#include <tuplasg.hpp>
+#include <matrizg.hpp>
+
+// ---------------------------------------------------------------------
+// caja englobante alineada con los ejes (AABB), dada por el mínimo y el
+// máximo de cada coordenada. Puede estar vacía (no contiene ningún punto)
+
+class CajaEngf
+{
+   public:
+      Tupla3f minimo, maximo ; // sin significado si la caja está vacía
+      bool    vacia ;
+
+      // caja vacía
+      CajaEngf() ;
+      // caja con esas esquinas
+      CajaEngf( const Tupla3f & pmin, const Tupla3f & pmax );
+
+      // ampliar la caja para que contenga otra caja o un punto
+      void unir( const CajaEngf & otra );
+      void unir( const Tupla3f & punto );
+
+      // centro de la caja (el origen si está vacía)
+      Tupla3f centro() const ;
+
+      // caja englobante de esta caja transformada por 'm' (se transforma el
+      // centro y se suman los valores absolutos de la matriz por el semilado,
+      // sin transformar las 8 esquinas)
+      CajaEngf transformada( const Matriz4f & m ) const ;
+} ;
+
+#endif
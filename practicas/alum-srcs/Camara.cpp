@@ -145,6 +145,20 @@ void Camara::activar()
    glMultMatrixf( mcv.matrizVista ); // matriz de vista
 }
 
+// ---------------------------------------------------------------------
+// rayo que pasa por el centro de un pixel
+
+Rayo Camara::rayoPixel( const Viewport & vp, const int x, const int y ) const
+{
+   // punto del pixel en el plano delantero, en coordenadas de cámara
+   const float px = vf.left   + ( vf.right-vf.left )*( x-vp.org_x+0.5f )/vp.ancho,
+               py = vf.bottom + ( vf.top-vf.bottom )*( y-vp.org_y+0.5f )/vp.alto ;
+
+   const Rayo rayo_cam = vf.persp ? Rayo( Tupla3f( 0.0, 0.0, 0.0 ), Tupla3f( px, py, -vf.near ) )
+                                  : Rayo( Tupla3f( px, py, 0.0 ),  Tupla3f( 0.0, 0.0, -1.0 ) );
+   return rayo_cam.transformado( mcv.matrizVistaInv );
+}
+
 
 
 
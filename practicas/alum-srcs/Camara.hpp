@@ -14,6 +14,7 @@
 
 #include "tuplasg.hpp"
 #include "matrices-tr.hpp"
+#include "Rayo.hpp"
 
 
 // *********************************************************************
@@ -62,6 +63,8 @@ class ViewFrustum
 // *********************************************************************
 // clase: Camara
 
+class Viewport ;
+
 class Camara
 {
    public:
@@ -71,6 +74,11 @@ class Camara
    Camara() ;            // usa constructores por defecto para {\ttbf mc} y {\ttbf vf}
 
    void activar() ;  // fijar matrices {\ttbf MODELVIEW} y {\ttbf PROJECTION} de OpenGL
+
+   // rayo (en coordenadas de mundo) que sale del observador y pasa por el
+   // centro del pixel (x,y) de 'vp' (origen abajo a la izquierda, como en
+   // 'glReadPixels'). En cámaras ortográficas sale del plano de la cámara
+   Rayo rayoPixel( const Viewport & vp, const int x, const int y ) const ;
 } ;
 
 // *********************************************************************
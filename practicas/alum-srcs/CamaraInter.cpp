@@ -82,7 +82,7 @@ void CamaraInteractiva::calcularMarcoCamara()
     mcv.eje[0] = matriz*Tupla4f(1.0, 0.0, 0.0, 0.0);
     mcv.eje[1] = matriz*Tupla4f(0.0, 1.0, 0.0, 0.0);
     mcv.eje[2] = matriz*Tupla4f(0.0, 0.0, 1.0, 0.0);
-    mcv.eje[3] = matriz*Tupla4f(0.0, 0.0, 0.0, 1.0);
+    mcv.org    = matriz*Tupla4f(0.0, 0.0, 0.0, 1.0);
   //    (3) recalcular matrices marco camara
     recalcularMatrMCV();
 }
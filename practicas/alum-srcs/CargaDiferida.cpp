@@ -0,0 +1,330 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Carga de mallas en segundo plano (implementación)
+// **
+// *********************************************************************
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "aux.hpp"
+#include "CacheMallas.hpp"
+#include "CargaDiferida.hpp"
+
+using namespace std ;
+
+typedef std::chrono::steady_clock Reloj ;
+
+// *****************************************************************************
+// estado compartido entre un objeto 'MallaDiferida' y su tarea
+
+struct EstadoCarga
+{
+   std::string     nombre ;
+   FuncCrearObjeto crear ;
+   std::mutex      cerrojo ;              // protege los tres campos siguientes
+   Objeto3D *      malla      = nullptr ; // malla construida
+   bool            terminada  = false ,   // la tarea ha terminado
+                   abandonada = false ;   // el objeto 'MallaDiferida' ya no existe
+} ;
+
+// *****************************************************************************
+// conjunto de hebras que construyen las mallas (una cola de tareas FIFO)
+
+class HebrasCarga
+{
+   private:
+      std::vector<std::thread>                      hebras ;
+      std::deque< std::shared_ptr<EstadoCarga> >    cola ;
+      std::mutex                                    cerrojo ;
+      std::condition_variable                       hay_tareas ;
+      bool                                          terminar = false ;
+      unsigned                                      pendientes = 0 ; // en la cola o construyéndose
+      Reloj::time_point                             t_inicio ;       // primera tarea del lote actual
+
+      void ejecutarTareas() ;
+      void construir( EstadoCarga & est ) ;
+
+   public:
+      std::atomic<bool> hay_nuevas ,  // alguna malla ha terminado desde la última consulta
+                        despertar ;   // despertar a 'glfwWaitEvents' al terminar una malla
+
+      HebrasCarga() ;
+      void     encolar( const std::shared_ptr<EstadoCarga> & est ) ;
+      unsigned numPendientes() ;
+      void     parar() ;
+      ~HebrasCarga() ;
+} ;
+
+// -----------------------------------------------------------------------------
+
+HebrasCarga::HebrasCarga()
+:  hay_nuevas( false ),
+   despertar( true )
+{
+   // al menos una hebra aunque 'hardware_concurrency' no lo sepa (devuelve 0).
+   // Las mallas PLY ya se leen en paralelo, así que no hacen falta más hebras que núcleos
+   const unsigned num_hebras = std::max( 1u, std::thread::hardware_concurrency() );
+
+   for( unsigned i = 0 ; i < num_hebras ; i++ )
+      hebras.push_back( std::thread( &HebrasCarga::ejecutarTareas, this ) );
+}
+// -----------------------------------------------------------------------------
+
+void HebrasCarga::encolar( const std::shared_ptr<EstadoCarga> & est )
+{
+   {
+      std::lock_guard<std::mutex> guarda( cerrojo );
+      if ( pendientes == 0 )
+         t_inicio = Reloj::now();
+      pendientes++ ;
+      cola.push_back( est );
+   }
+   hay_tareas.notify_one();
+}
+// -----------------------------------------------------------------------------
+
+unsigned HebrasCarga::numPendientes()
+{
+   std::lock_guard<std::mutex> guarda( cerrojo );
+   return pendientes ;
+}
+// -----------------------------------------------------------------------------
+// bucle de cada hebra: saca tareas de la cola hasta que se pide terminar
+
+void HebrasCarga::ejecutarTareas()
+{
+   while( true )
+   {
+      std::shared_ptr<EstadoCarga> est ;
+      {
+         std::unique_lock<std::mutex> guarda( cerrojo );
+         hay_tareas.wait( guarda, [this]{ return terminar || ! cola.empty() ; } );
+         if ( terminar )
+            return ;
+         est = cola.front();
+         cola.pop_front();
+      }
+      construir( *est );
+   }
+}
+// -----------------------------------------------------------------------------
+
+void HebrasCarga::construir( EstadoCarga & est )
+{
+   const Reloj::time_point t0 = Reloj::now();
+   Objeto3D * malla = est.crear() ;
+   const double segundos = std::chrono::duration<double>( Reloj::now() - t0 ).count();
+
+   est.crear = nullptr ; // libera lo que haya capturado la función
+   {
+      std::lock_guard<std::mutex> guarda( est.cerrojo );
+      if ( est.abandonada )
+         delete malla ;
+      else
+         est.malla = malla ;
+      est.terminada = true ;
+   }
+
+   unsigned quedan ;
+   double   seg_lote ;
+   {
+      std::lock_guard<std::mutex> guarda( cerrojo );
+      quedan   = --pendientes ;
+      seg_lote = std::chrono::duration<double>( Reloj::now() - t_inicio ).count();
+      cout << "carga en segundo plano: '" << est.nombre << "' lista en " << segundos
+           << " seg. (quedan " << quedan << ")" << endl ;
+      if ( quedan == 0 )
+         CacheMalla_Informe( "tiempo de carga de las mallas en segundo plano", seg_lote );
+   }
+
+   hay_nuevas = true ;
+   if ( despertar )
+      glfwPostEmptyEvent();
+}
+// -----------------------------------------------------------------------------
+// descarta las tareas que no han empezado y espera a las que se están ejecutando
+
+void HebrasCarga::parar()
+{
+   despertar = false ;
+   {
+      std::lock_guard<std::mutex> guarda( cerrojo );
+      if ( terminar )
+         return ;
+      terminar = true ;
+      pendientes -= cola.size();
+      cola.clear();
+   }
+   hay_tareas.notify_all();
+   for( unsigned i = 0 ; i < hebras.size() ; i++ )
+      hebras[i].join();
+}
+// -----------------------------------------------------------------------------
+
+HebrasCarga::~HebrasCarga()
+{
+   parar();
+}
+// -----------------------------------------------------------------------------
+// las hebras se crean la primera vez que se encola una malla
+
+static HebrasCarga & Hebras()
+{
+   static HebrasCarga hebras ;
+   return hebras ;
+}
+
+// *****************************************************************************
+// objeto que sustituye a la malla en el grafo de escena
+
+MallaDiferida::MallaDiferida( const std::string & nombre, FuncCrearObjeto crear,
+                              const Tupla3f & pcaja_min, const Tupla3f & pcaja_max )
+{
+   ponerNombre( nombre );
+   malla        = nullptr ;
+   caja_min     = pcaja_min ;
+   caja_max     = pcaja_max ;
+   color_fijado = false ;
+   centro_oc    = 0.5f*( caja_min + caja_max );
+
+   estado         = std::make_shared<EstadoCarga>();
+   estado->nombre = nombre ;
+   estado->crear  = crear ;
+   Hebras().encolar( estado );
+}
+// -----------------------------------------------------------------------------
+
+bool MallaDiferida::comprobarLista()
+{
+   if ( malla != nullptr )
+      return true ;
+
+   {
+      std::lock_guard<std::mutex> guarda( estado->cerrojo );
+      malla = estado->malla ;
+   }
+   if ( malla == nullptr )
+      return false ;
+
+   // el color fijado mientras se construía la malla se aplica ahora (hebra principal)
+   if ( color_fijado )
+      malla->fijarColorNodo( color );
+   // la caja ya no es la provisional
+   invalidarCaja();
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+CajaEngf MallaDiferida::cajaEnglobante()
+{
+   comprobarLista();
+   return Objeto3D::cajaEnglobante();
+}
+// -----------------------------------------------------------------------------
+
+CajaEngf MallaDiferida::calcularCajaEnglobante()
+{
+   if ( malla != nullptr )
+      return malla->cajaEnglobante();
+   return CajaEngf( caja_min, caja_max );
+}
+// -----------------------------------------------------------------------------
+
+bool MallaDiferida::lista()
+{
+   return comprobarLista();
+}
+// -----------------------------------------------------------------------------
+
+bool MallaDiferida::intersectarRayo( const Rayo & rayo, float & t )
+{
+   if ( comprobarLista() )
+      return malla->intersectarRayo( rayo, t );
+   return Objeto3D::intersectarRayo( rayo, t );
+}
+// -----------------------------------------------------------------------------
+
+void MallaDiferida::visualizarGL( ContextoVis & cv )
+{
+   if ( comprobarLista() )
+      malla->visualizarGL( cv );
+   else
+      visualizarCaja();
+}
+// -----------------------------------------------------------------------------
+// caja englobante en alambre, sin iluminación ni textura
+
+void MallaDiferida::visualizarCaja()
+{
+   const float x0 = caja_min(0), y0 = caja_min(1), z0 = caja_min(2),
+               x1 = caja_max(0), y1 = caja_max(1), z1 = caja_max(2) ;
+   const GLfloat v[8][3] =
+      { {x0,y0,z0},{x1,y0,z0},{x1,y1,z0},{x0,y1,z0},
+        {x0,y0,z1},{x1,y0,z1},{x1,y1,z1},{x0,y1,z1} } ;
+   const unsigned aristas[12][2] =
+      { {0,1},{1,2},{2,3},{3,0}, {4,5},{5,6},{6,7},{7,4}, {0,4},{1,5},{2,6},{3,7} } ;
+
+   glPushAttrib( GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT );
+   glDisable( GL_LIGHTING );
+   glDisable( GL_TEXTURE_2D );
+   glLineWidth( 1.0 );
+   if ( color_fijado )
+      glColor3fv( color );
+   else
+      glColor3f( 0.6, 0.6, 0.6 );
+
+   glBegin( GL_LINES );
+   for( unsigned i = 0 ; i < 12 ; i++ )
+   {  glVertex3fv( v[aristas[i][0]] );
+      glVertex3fv( v[aristas[i][1]] );
+   }
+   glEnd();
+   glPopAttrib();
+}
+// -----------------------------------------------------------------------------
+
+void MallaDiferida::fijarColorNodo( const Tupla3f & nuevo_color )
+{
+   color        = nuevo_color ;
+   color_fijado = true ;
+   if ( malla != nullptr )
+      malla->fijarColorNodo( nuevo_color );
+}
+// -----------------------------------------------------------------------------
+
+MallaDiferida::~MallaDiferida()
+{
+   std::lock_guard<std::mutex> guarda( estado->cerrojo );
+   if ( estado->terminada )
+      delete estado->malla ;
+   else
+      estado->abandonada = true ;
+}
+
+// *****************************************************************************
+
+bool CargaDiferida_HayNuevas()
+{
+   return Hebras().hay_nuevas.exchange( false );
+}
+// -----------------------------------------------------------------------------
+
+unsigned CargaDiferida_Pendientes()
+{
+   return Hebras().numPendientes();
+}
+// -----------------------------------------------------------------------------
+
+void CargaDiferida_Terminar()
+{
+   Hebras().parar();
+}
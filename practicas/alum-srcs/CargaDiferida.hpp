@@ -0,0 +1,91 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Carga de mallas en segundo plano (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_CARGADIFERIDA_HPP
+#define IG_CARGADIFERIDA_HPP
+
+#include <string>
+#include <memory>       // std::shared_ptr
+#include <functional>   // std::function
+#include "Objeto3D.hpp"
+
+// ---------------------------------------------------------------------
+// Las mallas grandes (MallaPLY, MallaRevol, ...) se construyen en un
+// conjunto de hebras secundarias, de forma que la ventana se puede dibujar
+// desde el principio. Mientras tanto, en el grafo de escena hay un objeto
+// 'MallaDiferida' que dibuja una caja englobante en alambre y que, cuando
+// la malla está lista, se limita a visualizarla.
+//
+// La construcción de las mallas no usa OpenGL: los VBOs se crean en la
+// hebra principal la primera vez que se visualiza la malla (ver
+// MallaInd::visualizarDE_VBOs), así que la función que construye la malla
+// no debe hacer llamadas a OpenGL.
+
+// función que construye la malla (se ejecuta en una hebra secundaria)
+typedef std::function< Objeto3D * () > FuncCrearObjeto ;
+
+// estado compartido entre el objeto 'MallaDiferida' y la tarea que construye la malla
+struct EstadoCarga ;
+
+class MallaDiferida : public Objeto3D
+{
+   private:
+      std::shared_ptr<EstadoCarga> estado ;
+      Objeto3D * malla ;          // malla ya construida (nullptr mientras no esté lista)
+      Tupla3f    caja_min,        // caja que se dibuja mientras se construye la malla
+                 caja_max ;
+      Tupla3f    color ;          // último color fijado con 'fijarColorNodo'
+      bool       color_fijado ;
+
+      // comprueba (sin esperar) si la malla ya está construida
+      bool comprobarLista() ;
+      void visualizarCaja() ;
+
+   protected:
+      // la de la malla si ya está lista, si no la caja provisional
+      virtual CajaEngf calcularCajaEnglobante() ;
+
+   public:
+      // encola la construcción de la malla con 'crear'.
+      // 'caja_min' y 'caja_max' delimitan la caja que se dibuja mientras tanto
+      MallaDiferida( const std::string & nombre, FuncCrearObjeto crear,
+                     const Tupla3f & caja_min = Tupla3f( -1.0, -1.0, -1.0 ),
+                     const Tupla3f & caja_max = Tupla3f( +1.0, +1.0, +1.0 ) );
+
+      // dibuja la caja o la malla, si ya está lista
+      virtual void visualizarGL( ContextoVis & cv ) ;
+
+      // comprueba antes si la malla ya está lista (y cambia la caja)
+      virtual CajaEngf cajaEnglobante() ;
+
+      // si la malla no está lista se guarda el color y se aplica al terminar
+      virtual void fijarColorNodo( const Tupla3f & nuevo_color ) ;
+
+      // corta con la malla si ya está lista, si no con la caja provisional
+      virtual bool intersectarRayo( const Rayo & rayo, float & t ) ;
+
+      // true si la malla ya se ha construido
+      bool lista() ;
+
+      // si la malla aún se está construyendo, la destruye la hebra al terminar
+      virtual ~MallaDiferida() ;
+} ;
+
+// ---------------------------------------------------------------------
+// devuelve true si alguna malla ha terminado de construirse desde la última
+// llamada (se usa en el bucle de eventos para redibujar la ventana).
+// Cada vez que termina una malla se despierta a 'glfwWaitEvents'
+bool CargaDiferida_HayNuevas() ;
+
+// número de mallas que están pendientes o construyéndose
+unsigned CargaDiferida_Pendientes() ;
+
+// deja de despertar al bucle de eventos (se llama antes de 'glfwTerminate')
+void CargaDiferida_Terminar() ;
+
+#endif
@@ -0,0 +1,222 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Cola de visualización de un grafo de escena (implementación)
+// **
+// *********************************************************************
+
+#include <algorithm>
+#include "aux.hpp"
+#include "ColaVisualizacion.hpp"
+#include "Objeto3D.hpp"
+#include "materiales.hpp"
+#include "grafo-escena.hpp"
+
+// -----------------------------------------------------------------------------
+
+void ColaVisualizacion::vaciar()
+{
+   instancias.clear();
+   elementos.clear();
+}
+// -----------------------------------------------------------------------------
+
+int ColaVisualizacion::agregarInstancia( NodoGrafoEscena * nodo, const int padre,
+                                         const unsigned entrada )
+{
+   InstanciaNodo inst ;
+   inst.nodo                 = nodo ;
+   inst.padre                = padre ;
+   inst.entrada              = entrada ;
+   inst.matriz               = matrizMundo( padre, entrada );
+   inst.num_cambios_matrices = nodo->leerNumCambiosMatrices();
+   inst.actualizada          = false ;
+   instancias.push_back( inst );
+   return instancias.size()-1 ;
+}
+// -----------------------------------------------------------------------------
+
+void ColaVisualizacion::agregar( const ElementoCola & elemento )
+{
+   elementos.push_back( elemento );
+
+   ElementoCola & e = elementos.back() ;
+   e.orden  = elementos.size()-1 ;
+   e.matriz = matrizMundo( e.instancia, e.entrada );
+   if ( e.material != nullptr )
+      e.matriz_material = matrizMundo( e.instancia_material, e.entrada_material );
+   e.caja           = e.objeto->cajaEnglobante().transformada( e.matriz );
+   e.invalidaciones = e.objeto->leerNumInvalidaciones();
+}
+// -----------------------------------------------------------------------------
+
+Matriz4f ColaVisualizacion::matrizMundo( const int instancia, const unsigned entrada ) const
+{
+   if ( instancia < 0 )
+      return MAT_Ident();
+   const InstanciaNodo & inst = instancias[instancia] ;
+   return inst.matriz*inst.nodo->matrizEntrada( entrada );
+}
+// -----------------------------------------------------------------------------
+// las instancias están en el orden del recorrido, así que cada padre se
+// actualiza antes que sus hijos. Una instancia cambia si han cambiado las
+// matrices de su nodo (sus entradas) o si ha cambiado su padre (su matriz)
+
+unsigned ColaVisualizacion::actualizar()
+{
+   for( unsigned k = 0 ; k < instancias.size() ; k++ )
+   {
+      InstanciaNodo &     inst    = instancias[k] ;
+      const bool          mueve   = inst.padre >= 0 && instancias[inst.padre].actualizada ;
+      const unsigned long cambios = inst.nodo->leerNumCambiosMatrices();
+
+      inst.actualizada          = mueve || cambios != inst.num_cambios_matrices ;
+      inst.num_cambios_matrices = cambios ;
+      if ( mueve )
+         inst.matriz = matrizMundo( inst.padre, inst.entrada );
+   }
+
+   unsigned num_recalculados = 0 ;
+   for( unsigned i = 0 ; i < elementos.size() ; i++ )
+   {
+      ElementoCola &      e     = elementos[i] ;
+      const bool          mueve = instancias[e.instancia].actualizada ;
+      const unsigned long inval = e.objeto->leerNumInvalidaciones();
+
+      if ( mueve )
+         e.matriz = matrizMundo( e.instancia, e.entrada );
+      if ( e.material != nullptr && instancias[e.instancia_material].actualizada )
+         e.matriz_material = matrizMundo( e.instancia_material, e.entrada_material );
+      if ( mueve || inval != e.invalidaciones )
+      {  e.caja           = e.objeto->cajaEnglobante().transformada( e.matriz );
+         e.invalidaciones = e.objeto->leerNumInvalidaciones();
+         num_recalculados++ ;
+      }
+   }
+   return num_recalculados ;
+}
+// -----------------------------------------------------------------------------
+
+void ColaVisualizacion::ordenar()
+{
+   std::sort( elementos.begin(), elementos.end(),
+      []( const ElementoCola & a, const ElementoCola & b )
+      {
+         if ( (a.material != nullptr) != (b.material != nullptr) )
+            return a.material == nullptr ;
+         if ( a.material != nullptr && a.material->tex != b.material->tex )
+            return std::less<Textura *>()( a.material->tex, b.material->tex );
+         if ( a.material != b.material )
+            return std::less<Material *>()( a.material, b.material );
+         if ( a.objeto != b.objeto )
+            return std::less<Objeto3D *>()( a.objeto, b.objeto );
+         return a.orden < b.orden ;
+      } );
+}
+// -----------------------------------------------------------------------------
+
+static bool MismaMatriz( const Matriz4f & a, const Matriz4f & b )
+{
+   const float * pa = a, * pb = b ;
+   return std::equal( pa, pa+16, pb );
+}
+// -----------------------------------------------------------------------------
+// en lugar de componer matrices en la pila de OpenGL se carga directamente
+// vista*modelado de cada hoja. El material solo se activa cuando cambia (o
+// cuando su textura genera coordenadas en el ojo y cambia la matriz del nodo
+// donde se activó, que es la que se usa para los planos de generación)
+
+void ColaVisualizacion::visualizarGL( ContextoVis & cv )
+{
+   const bool recortar = cv.recortarVista && cv.piramideVision.valida ;
+   Matriz4f   vista ;
+   glGetFloatv( GL_MODELVIEW_MATRIX, vista );
+
+   glMatrixMode( GL_MODELVIEW );
+   glPushMatrix();
+   cv.pilaMateriales.push();
+
+   Material *       material_act        = nullptr ;
+   const Matriz4f * matriz_material_act = nullptr ;
+
+   for( unsigned i = 0 ; i < elementos.size() ; i++ )
+   {
+      const ElementoCola & e = elementos[i] ;
+
+      if ( recortar )
+      {  unsigned planos = todos_los_planos ;
+         if ( cv.piramideVision.clasificar( e.caja, planos ) == PosicionCaja::fuera )
+         {  cv.numNodosDescartados++ ;
+            continue ;
+         }
+      }
+
+      // en modo selección los materiales no cuentan (solo el color del
+      // identificador)
+      if ( e.material != nullptr && ! cv.modoSeleccionFBO )
+      {
+         const bool cambia = e.material != material_act ,
+                    ojo    = e.material->tex != nullptr &&
+                             e.material->tex->leerModoGenCT() == mgct_coords_ojo ;
+         if ( cambia || ( ojo && ! MismaMatriz( *matriz_material_act, e.matriz_material ) ) )
+         {
+            if ( ojo )
+               glLoadMatrixf( vista*e.matriz_material );
+            if ( cambia )
+               cv.pilaMateriales.activarMaterial( e.material );
+            else
+               cv.pilaMateriales.activarActual();
+            material_act        = e.material ;
+            matriz_material_act = &e.matriz_material ;
+         }
+      }
+
+      // las hojas sin identificador tapan lo que hay detrás con el fondo (0)
+      if ( cv.modoSeleccionFBO )
+         FijarColorIdent( e.identificador > 0 ? e.identificador : 0 );
+
+      glLoadMatrixf( vista*e.matriz );
+      e.objeto->visualizarGL( cv );
+   }
+
+   if ( cv.identResaltado > 0 && ! cv.modoSeleccionFBO )
+      visualizarResaltado( cv, vista );
+
+   cv.pilaMateriales.pop();
+   glMatrixMode( GL_MODELVIEW );
+   glPopMatrix();
+}
+// -----------------------------------------------------------------------------
+// las hojas resaltadas se vuelven a dibujar en alambre, de un solo color y sin
+// iluminación ni texturas, como en modo selección (solo las posiciones). No
+// cuentan en los contadores del cuadro: ya se han contado al dibujarlas
+
+void ColaVisualizacion::visualizarResaltado( ContextoVis & cv, const Matriz4f & vista )
+{
+   const unsigned long num_triangulos = cv.numTriangulos, num_visitados = cv.numNodosVisitados,
+                       num_descartados = cv.numNodosDescartados, num_dibujados = cv.numNodosDibujados ;
+   const ModosVis modo_ant = cv.modoVis ;
+   cv.modoVis          = modoAlambre ;
+   cv.modoSeleccionFBO = true ;
+
+   glPushAttrib( GL_ENABLE_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT | GL_LINE_BIT );
+   glDisable( GL_LIGHTING );
+   glDisable( GL_TEXTURE_2D );
+   glDepthFunc( GL_LEQUAL );
+   glColor3f( 1.0, 0.85, 0.0 );
+
+   for( unsigned i = 0 ; i < elementos.size() ; i++ )
+      if ( elementos[i].identificador == cv.identResaltado )
+      {  glLoadMatrixf( vista*elementos[i].matriz );
+         elementos[i].objeto->visualizarGL( cv );
+      }
+
+   glPopAttrib();
+   cv.modoSeleccionFBO    = false ;
+   cv.modoVis             = modo_ant ;
+   cv.numTriangulos       = num_triangulos ;
+   cv.numNodosVisitados   = num_visitados ;
+   cv.numNodosDescartados = num_descartados ;
+   cv.numNodosDibujados   = num_dibujados ;
+}
@@ -0,0 +1,120 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Cola de visualización de un grafo de escena (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_COLAVISUALIZACION_HPP
+#define IG_COLAVISUALIZACION_HPP
+
+#include <vector>
+#include <matrizg.hpp>
+#include "CajaEngf.hpp"
+#include "practicas.hpp"   // declaración de 'ContextoVis'
+
+class Objeto3D ;
+class Material ;
+class NodoGrafoEscena ;
+
+// ---------------------------------------------------------------------
+// cada aparición de un nodo en el grafo (un nodo compartido aparece varias
+// veces), con su matriz de modelado en coordenadas de mundo en caché
+
+struct InstanciaNodo
+{
+   NodoGrafoEscena * nodo ;
+   int               padre ;    // instancia del nodo padre (-1 en la raíz)
+   unsigned          entrada ;  // entrada del padre que contiene este nodo
+   Matriz4f          matriz ;   // coords. del nodo --> coords. de mundo
+   unsigned long     num_cambios_matrices ; // los del nodo, la última vez que se miró
+   bool              actualizada ;          // true si han cambiado sus matrices en la última actualización
+} ;
+
+// ---------------------------------------------------------------------
+// estado del recorrido al aplanar un nodo: lo que en la visualización se
+// acumula en las pilas de OpenGL y de materiales
+
+struct EstadoAplanado
+{
+   int        instancia ;           // instancia del nodo padre (-1 si no hay)
+   unsigned   entrada ;             // entrada del padre
+   Material * material ;            // material activo (nullptr si no hay)
+   int        instancia_material ;  // instancia y entrada donde se activó el material
+   unsigned   entrada_material ;
+   int        identificador ;       // identificador del padre
+} ;
+
+// ---------------------------------------------------------------------
+// una hoja del grafo de escena, lista para visualizarse sin recorrer el
+// grafo. Las matrices y la caja se calculan a partir de las instancias
+
+struct ElementoCola
+{
+   Objeto3D * objeto ;           // hoja (malla, o cualquier objeto que no es un nodo)
+   int        instancia ;        // instancia del nodo padre y entrada que contiene la hoja
+   unsigned   entrada ;
+   Material * material ;         // material activo en la hoja (nullptr si no hay)
+   int        instancia_material ; // instancia y entrada donde se activó el material
+   unsigned   entrada_material ;
+   int        identificador ;    // identificador de la hoja, o el heredado del padre
+   unsigned   orden ;            // posición en el recorrido del grafo
+
+   // calculados en la cola
+   Matriz4f   matriz ;           // coords. de la hoja --> coords. de mundo
+   Matriz4f   matriz_material ;  // coords. de mundo del nodo donde se activó el material
+                                 // (importa para texturas con coords. generadas en el ojo)
+   CajaEngf   caja ;             // caja englobante en coords. de mundo
+   unsigned long invalidaciones ; // las de la caja de la hoja cuando se calculó 'caja'
+} ;
+
+// ---------------------------------------------------------------------
+// cola de visualización: las hojas de un grafo de escena en un vector,
+// ordenadas por textura, material y malla para cambiar el estado de OpenGL
+// lo menos posible. La construye NodoGrafoEscena::compilarCola, y solo hay
+// que volver a construirla cuando cambian las entradas de algún nodo: si
+// solo cambian matrices, 'actualizar' recalcula las matrices de mundo de las
+// instancias afectadas y de sus hojas, y nada más
+
+class ColaVisualizacion
+{
+   public:
+      std::vector<InstanciaNodo> instancias ; // padres antes que hijos
+      std::vector<ElementoCola>  elementos ;
+
+      void vaciar();
+
+      // añadir una instancia de 'nodo', en la entrada 'entrada' de la
+      // instancia 'padre' (-1 si es la raíz). Devuelve su índice
+      int agregarInstancia( NodoGrafoEscena * nodo, const int padre, const unsigned entrada );
+
+      // añadir un elemento al final (en el orden del recorrido), calculando
+      // sus matrices y su caja
+      void agregar( const ElementoCola & elemento );
+
+      // matriz de modelado (coords. de mundo) de la entrada 'entrada' de la
+      // instancia 'instancia' (la identidad si 'instancia' es -1)
+      Matriz4f matrizMundo( const int instancia, const unsigned entrada ) const ;
+
+      // recalcular las matrices de las instancias cuyo nodo (o alguno de
+      // sus antecesores) ha cambiado de matrices, y las matrices y cajas de
+      // sus hojas, y las cajas de las hojas que han cambiado de geometría.
+      // Devuelve el número de elementos recalculados
+      unsigned actualizar();
+
+      // ordenar los elementos: primero los que no tienen material, después
+      // por textura, material y objeto, y si no, en el orden del recorrido
+      void ordenar();
+
+      // visualizar todos los elementos con la matriz de vista que haya en
+      // MODELVIEW (la misma con la que se visualizaría el nodo raíz),
+      // descartando los que quedan fuera de la pirámide de visión, y después
+      // resaltar los que tienen el identificador 'cv.identResaltado'
+      void visualizarGL( ContextoVis & cv );
+
+   private:
+      void visualizarResaltado( ContextoVis & cv, const Matriz4f & vista );
+} ;
+
+#endif
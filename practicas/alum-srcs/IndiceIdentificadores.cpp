@@ -0,0 +1,74 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Índice de identificadores de un grafo de escena (implementación)
+// **
+// *********************************************************************
+
+#include <cassert>
+#include "matrices-tr.hpp"
+#include "IndiceIdentificadores.hpp"
+#include "grafo-escena.hpp"
+
+// -----------------------------------------------------------------------------
+
+void IndiceIdentificadores::vaciar()
+{
+   pasos.clear();
+   posiciones.clear();
+}
+// -----------------------------------------------------------------------------
+
+int IndiceIdentificadores::agregarPaso( NodoGrafoEscena * nodo, const unsigned entrada,
+                                        const int anterior )
+{
+   Paso p ;
+   p.nodo     = nodo ;
+   p.entrada  = entrada ;
+   p.anterior = anterior ;
+   pasos.push_back( p );
+   return pasos.size()-1 ;
+}
+// -----------------------------------------------------------------------------
+
+void IndiceIdentificadores::agregar( const int ident, const int paso )
+{
+   // 'insert' no cambia el paso si el identificador ya estaba
+   if ( ident > 0 )
+      posiciones.insert( std::make_pair( ident, paso ) );
+}
+// -----------------------------------------------------------------------------
+
+bool IndiceIdentificadores::buscar( const int ident, int & paso ) const
+{
+   const auto it = posiciones.find( ident );
+   if ( it == posiciones.end() )
+      return false ;
+   paso = it->second ;
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+Objeto3D * IndiceIdentificadores::objeto( const int paso ) const
+{
+   assert( 0 <= paso && paso < int(pasos.size()) );
+   return pasos[paso].nodo->leerObjeto( pasos[paso].entrada );
+}
+// -----------------------------------------------------------------------------
+// se compone de abajo arriba: las matrices de cada nodo (en caché, ver
+// NodoGrafoEscena::matrizEntrada) multiplican por la izquierda
+
+Matriz4f IndiceIdentificadores::matriz( const int paso ) const
+{
+   Matriz4f m = MAT_Ident();
+   for( int p = paso ; p >= 0 ; p = pasos[p].anterior )
+      m = pasos[p].nodo->matrizEntrada( pasos[p].entrada )*m ;
+   return m ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned IndiceIdentificadores::numIdentificadores() const
+{
+   return posiciones.size() ;
+}
@@ -0,0 +1,66 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Índice de identificadores de un grafo de escena (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_INDICEIDENTIFICADORES_HPP
+#define IG_INDICEIDENTIFICADORES_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <matrizg.hpp>
+
+class Objeto3D ;
+class NodoGrafoEscena ;
+
+// ---------------------------------------------------------------------
+// índice de los identificadores de los objetos que hay por debajo de un
+// nodo (el nodo del índice): para cada identificador se guarda el paso por
+// el que se llega al objeto, es decir, el nodo y la entrada que lo contiene,
+// y el paso por el que se llega a ese nodo. Así, para encontrar un objeto y
+// su matriz de modelado basta con subir por su camino, sin recorrer el grafo.
+//
+// Lo construye Objeto3D::indexar, en el mismo orden que recorre el grafo
+// 'buscarObjeto': si un identificador se repite, se queda el primero.
+
+class IndiceIdentificadores
+{
+   public:
+      struct Paso
+      {
+         NodoGrafoEscena * nodo ;     // nodo que contiene el objeto
+         unsigned          entrada ;  // entrada del nodo con el objeto
+         int               anterior ; // paso por el que se llega al nodo (-1 si es el del índice)
+      } ;
+
+      void vaciar();
+
+      // añadir un paso y devolver su índice
+      int agregarPaso( NodoGrafoEscena * nodo, const unsigned entrada, const int anterior );
+
+      // añadir el identificador 'ident' del objeto al que se llega por
+      // 'paso', si es mayor que 0 y no estaba ya
+      void agregar( const int ident, const int paso );
+
+      // paso por el que se llega al objeto con identificador 'ident' (-1 si
+      // es el nodo del índice). Devuelve false si no está
+      bool buscar( const int ident, int & paso ) const ;
+
+      // objeto al que se llega por 'paso' (no vale para -1)
+      Objeto3D * objeto( const int paso ) const ;
+
+      // matriz de modelado del objeto al que se llega por 'paso', respecto
+      // del nodo del índice (la composición de las matrices del camino)
+      Matriz4f matriz( const int paso ) const ;
+
+      unsigned numIdentificadores() const ;
+
+   private:
+      std::vector<Paso>            pasos ;
+      std::unordered_map<int,int>  posiciones ; // identificador --> paso
+} ;
+
+#endif
@@ -10,10 +10,196 @@
 #include <tuplasg.hpp>
 //#include <tuplasg_impl.hpp>
 #include "MallaInd.hpp"
+#include "Paralelo.hpp"
+#include "CacheMallas.hpp"
+#include "OptimizarMalla.hpp"
+#include "SimplificarMalla.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// en OSX (OpenGL 2.1) los VAOs son la extensión de Apple
+#ifdef OSX
+#define glGenVertexArrays    glGenVertexArraysAPPLE
+#define glBindVertexArray    glBindVertexArrayAPPLE
+#define glDeleteVertexArrays glDeleteVertexArraysAPPLE
+#endif
 
 // *****************************************************************************
 // funciones auxiliares
 
+// las tablas de Tupla3f se recorren como arrays de floats (x,y,z,x,y,z,...)
+static_assert( sizeof(Tupla3f) == 3*sizeof(float), "Tupla3f debe ser float[3]" );
+
+// -----------------------------------------------------------------------------
+// normaliza 'num' vectores consecutivos. Los nulos pasan a ser (1,0,0), igual
+// que en MallaInd::normalizar (que se usa también para los que no caben en
+// grupos de 4 o si no hay SSE)
+
+static void NormalizarTabla( Tupla3f * tabla, const unsigned long num )
+{
+   unsigned long i = 0 ;
+
+#ifdef __SSE2__
+   // grupos de 4 vectores (12 floats, 3 registros): se calculan las 4 longitudes
+   // a la vez transponiendo los cuadrados, y se multiplica cada componente por
+   // el inverso de la longitud de su vector
+   const __m128 cero = _mm_setzero_ps(), uno = _mm_set1_ps( 1.0f );
+
+   for( ; i+4 <= num ; i += 4 )
+   {
+      float * p = (float *) (tabla+i) ;
+      __m128  a = _mm_loadu_ps( p ),   // x0 y0 z0 x1
+              b = _mm_loadu_ps( p+4 ), // y1 z1 x2 y2
+              c = _mm_loadu_ps( p+8 ); // z2 x3 y3 z3
+      const __m128
+         sa = _mm_mul_ps( a, a ), sb = _mm_mul_ps( b, b ), sc = _mm_mul_ps( c, c ),
+         t1 = _mm_shuffle_ps( sa, sb, _MM_SHUFFLE(2,2,3,0) ),
+         t2 = _mm_shuffle_ps( sb, sc, _MM_SHUFFLE(1,1,2,2) ),
+         t3 = _mm_shuffle_ps( sa, sb, _MM_SHUFFLE(0,0,1,1) ),
+         t4 = _mm_shuffle_ps( sb, sc, _MM_SHUFFLE(2,2,3,3) ),
+         t5 = _mm_shuffle_ps( sa, sb, _MM_SHUFFLE(1,1,2,2) ),
+         t6 = _mm_shuffle_ps( sc, sc, _MM_SHUFFLE(3,3,0,0) ),
+         xx = _mm_shuffle_ps( t1, t2, _MM_SHUFFLE(2,0,1,0) ), // x0² x1² x2² x3²
+         yy = _mm_shuffle_ps( t3, t4, _MM_SHUFFLE(2,0,2,0) ), // y0² y1² y2² y3²
+         zz = _mm_shuffle_ps( t5, t6, _MM_SHUFFLE(2,0,2,0) ), // z0² z1² z2² z3²
+         lsq = _mm_add_ps( _mm_add_ps( xx, yy ), zz );
+
+      // si algún vector es nulo (o no es finito) se hace el grupo sin SSE
+      if ( _mm_movemask_ps( _mm_cmpgt_ps( lsq, cero ) ) != 0xF )
+      {  for( unsigned j = 0 ; j < 4 ; j++ )
+            tabla[i+j] = MallaInd::normalizar( tabla[i+j] );
+         continue ;
+      }
+      const __m128 inv = _mm_div_ps( uno, _mm_sqrt_ps( lsq ) );
+      a = _mm_mul_ps( a, _mm_shuffle_ps( inv, inv, _MM_SHUFFLE(1,0,0,0) ) );
+      b = _mm_mul_ps( b, _mm_shuffle_ps( inv, inv, _MM_SHUFFLE(2,2,1,1) ) );
+      c = _mm_mul_ps( c, _mm_shuffle_ps( inv, inv, _MM_SHUFFLE(3,3,3,2) ) );
+      _mm_storeu_ps( p,   a );
+      _mm_storeu_ps( p+4, b );
+      _mm_storeu_ps( p+8, c );
+   }
+#endif
+
+   for( ; i < num ; i++ )
+      tabla[i] = MallaInd::normalizar( tabla[i] );
+}
+
+// -----------------------------------------------------------------------------
+// igual que 'NormalizarTabla', pero con las componentes en tres arrays (SoA):
+// no hace falta transponer, cada registro tiene la misma componente de 4 vectores
+
+static void NormalizarSoA( float * x, float * y, float * z, const unsigned long num )
+{
+   unsigned long i = 0 ;
+
+#ifdef __SSE2__
+   const __m128 cero = _mm_setzero_ps(), uno = _mm_set1_ps( 1.0f );
+
+   for( ; i+4 <= num ; i += 4 )
+   {
+      const __m128 vx  = _mm_loadu_ps( x+i ), vy = _mm_loadu_ps( y+i ), vz = _mm_loadu_ps( z+i ),
+                   lsq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ),
+                                     _mm_mul_ps( vz, vz ) );
+
+      if ( _mm_movemask_ps( _mm_cmpgt_ps( lsq, cero ) ) != 0xF )
+      {  for( unsigned long j = i ; j < i+4 ; j++ )
+         {  const Tupla3f n = MallaInd::normalizar( Tupla3f( x[j], y[j], z[j] ) );
+            x[j] = n(0) ; y[j] = n(1) ; z[j] = n(2) ;
+         }
+         continue ;
+      }
+      const __m128 inv = _mm_div_ps( uno, _mm_sqrt_ps( lsq ) );
+      _mm_storeu_ps( x+i, _mm_mul_ps( vx, inv ) );
+      _mm_storeu_ps( y+i, _mm_mul_ps( vy, inv ) );
+      _mm_storeu_ps( z+i, _mm_mul_ps( vz, inv ) );
+   }
+#endif
+
+   for( ; i < num ; i++ )
+   {  const Tupla3f n = MallaInd::normalizar( Tupla3f( x[i], y[i], z[i] ) );
+      x[i] = n(0) ; y[i] = n(1) ; z[i] = n(2) ;
+   }
+}
+
+// -----------------------------------------------------------------------------
+// mínimo y máximo de un array de flotantes alineado (num > 0). Se usan tres
+// pares de acumuladores independientes, como en MinMaxAoS: con uno solo
+// cada min/max espera al anterior y el recorrido va más lento que en AoS
+
+static void MinMaxSoA( const float * v, const unsigned long num, float & vmin, float & vmax )
+{
+   unsigned long i = 0 ;
+   vmin = vmax = v[0] ;
+
+#ifdef __SSE2__
+   if ( num >= 12 )
+   {  __m128 mn0 = _mm_load_ps( v ),   mx0 = mn0 ,
+             mn1 = _mm_load_ps( v+4 ), mx1 = mn1 ,
+             mn2 = _mm_load_ps( v+8 ), mx2 = mn2 ;
+      for( i = 12 ; i+12 <= num ; i += 12 )
+      {  const __m128 a0 = _mm_load_ps( v+i ), a1 = _mm_load_ps( v+i+4 ), a2 = _mm_load_ps( v+i+8 );
+         mn0 = _mm_min_ps( mn0, a0 ); mx0 = _mm_max_ps( mx0, a0 );
+         mn1 = _mm_min_ps( mn1, a1 ); mx1 = _mm_max_ps( mx1, a1 );
+         mn2 = _mm_min_ps( mn2, a2 ); mx2 = _mm_max_ps( mx2, a2 );
+      }
+      float amn[4], amx[4] ;
+      _mm_storeu_ps( amn, _mm_min_ps( mn0, _mm_min_ps( mn1, mn2 ) ) );
+      _mm_storeu_ps( amx, _mm_max_ps( mx0, _mm_max_ps( mx1, mx2 ) ) );
+      for( unsigned j = 0 ; j < 4 ; j++ )
+      {  vmin = std::min( vmin, amn[j] );
+         vmax = std::max( vmax, amx[j] );
+      }
+   }
+#endif
+
+   for( ; i < num ; i++ )
+   {  vmin = std::min( vmin, v[i] );
+      vmax = std::max( vmax, v[i] );
+   }
+}
+
+
+// -----------------------------------------------------------------------------
+// mínimo y máximo de cada coordenada de 'num' tuplas de 3 flotantes
+// consecutivas (x,y,z,x,y,z,...). Con SSE se leen 4 tuplas (3 registros) por
+// iteración: cada posición de cada registro es siempre la misma coordenada
+
+static void MinMaxAoS( const float * v, const unsigned long num, float vmin[3], float vmax[3] )
+{
+   unsigned long i = 0 ;
+   for( unsigned k = 0 ; k < 3 ; k++ )
+      vmin[k] = vmax[k] = v[k] ;
+
+#ifdef __SSE2__
+   if ( num >= 4 )
+   {  __m128 mn0 = _mm_loadu_ps( v ),   mx0 = mn0 , // x y z x
+             mn1 = _mm_loadu_ps( v+4 ), mx1 = mn1 , // y z x y
+             mn2 = _mm_loadu_ps( v+8 ), mx2 = mn2 ; // z x y z
+      for( i = 4 ; i+4 <= num ; i += 4 )
+      {  const float * p = v+3*i ;
+         const __m128 a0 = _mm_loadu_ps( p ), a1 = _mm_loadu_ps( p+4 ), a2 = _mm_loadu_ps( p+8 );
+         mn0 = _mm_min_ps( mn0, a0 ); mx0 = _mm_max_ps( mx0, a0 );
+         mn1 = _mm_min_ps( mn1, a1 ); mx1 = _mm_max_ps( mx1, a1 );
+         mn2 = _mm_min_ps( mn2, a2 ); mx2 = _mm_max_ps( mx2, a2 );
+      }
+      float amn[12], amx[12] ;
+      _mm_storeu_ps( amn, mn0 ); _mm_storeu_ps( amn+4, mn1 ); _mm_storeu_ps( amn+8, mn2 );
+      _mm_storeu_ps( amx, mx0 ); _mm_storeu_ps( amx+4, mx1 ); _mm_storeu_ps( amx+8, mx2 );
+      for( unsigned j = 0 ; j < 12 ; j++ )
+      {  vmin[j%3] = std::min( vmin[j%3], amn[j] );
+         vmax[j%3] = std::max( vmax[j%3], amx[j] );
+      }
+   }
+#endif
+
+   for( ; i < num ; i++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  vmin[k] = std::min( vmin[k], v[3*i+k] );
+         vmax[k] = std::max( vmax[k], v[3*i+k] );
+      }
+}
 
 // *****************************************************************************
 // métodos de la clase MallaInd.
@@ -29,15 +215,16 @@ MallaInd::MallaInd( const string & nombreIni )
 {
    // 'identificador' puesto a 0 por defecto, 'centro_oc' puesto a (0,0,0)
    ponerNombre(nombreIni) ;
-   modoVBO = false;
-   id_vbo_ver = 0;
-   id_vbo_tri = 0;
-   id_vbo_col_ver = 0;
-   id_vbo_norm_ver = 0;
-   id_vbo_cctt = 0;
    centro_oc = {0.0, 0.0, 0.0};
 }
 // -----------------------------------------------------------------------------
+
+MallaInd::~MallaInd()
+{
+   destruirVBOs();
+   delete bvh ;
+}
+// -----------------------------------------------------------------------------
 // calcula las dos tablas de normales
 Tupla3f MallaInd::normalizar(Tupla3f tupla){
   if(tupla[0]==0 && tupla[1]==0 && tupla[2]==0){
@@ -46,40 +233,87 @@ Tupla3f MallaInd::normalizar(Tupla3f tupla){
   return tupla.normalized();
 }
 
+//Para las caras producto cruz de dos de sus lados y normalizando
+//(cada hebra calcula y normaliza un trozo de la tabla)
+void MallaInd::calcular_normales_caras(){
+  const bool soa = disposicion == DisposicionMalla::soa;
+  normales_caras.resize(caras.size());
+  EnParalelo(caras.size(), [this,soa](unsigned long ini, unsigned long fin){
+    for(unsigned long i=ini; i<fin;i++){
+      Tupla3f v1, v2, v3;
+      if(soa){
+        v1 = vertices_soa(caras[i](0));
+        v2 = vertices_soa(caras[i](1));
+        v3 = vertices_soa(caras[i](2));
+      }
+      else{
+        v1 = vertices[caras[i](0)];
+        v2 = vertices[caras[i](1)];
+        v3 = vertices[caras[i](2)];
+      }
+      //sacamos dos aristas
+      const Tupla3f a1 = v2-v1;
+      const Tupla3f a2 = v3-v1;
+      normales_caras[i] = a1.cross(a2);
+    }
+    NormalizarTabla(normales_caras.data()+ini, fin-ini);
+  });
+}
+
 void MallaInd::calcular_normales(){
-  normales_vertices.clear();
-  normales_caras.clear();
-  //cout << "inicializando tabla normales..." << endl;
-  //Para las caras producto cruz de dos de sus lados y normalizando
+  const unsigned long nv = numVertices(), nc = caras.size();
+  const bool soa = disposicion == DisposicionMalla::soa;
+
   //Para los vertices, es la combinacion de las normales de las caras que rodean
-  for(unsigned i=0; i<vertices.size();i++){
-    normales_vertices.push_back(Tupla3f(0.0,0.0,0.0));
-  } //inicializamos tabla de vertices porque tendremos que sumar
-  for(unsigned i=0; i<caras.size();i++){
-    normales_caras.push_back(Tupla3f(0.0,0.0,0.0));
+  calcular_normales_caras();
+
+  //adyacencia vértice -> caras en formato CSR: las caras del vértice v son
+  //caras_ver[primera[v]] ... caras_ver[primera[v+1]-1], en orden creciente,
+  //así cada hebra suma las de sus vértices sin conflictos y en el mismo
+  //orden que si se recorrieran las caras una a una
+  vector<unsigned> primera(nv+1, 0), caras_ver(3*nc);
+  for(unsigned long i=0; i<nc;i++){
+    primera[caras[i](0)+1]++;
+    primera[caras[i](1)+1]++;
+    primera[caras[i](2)+1]++;
   }
-
-  for(unsigned i=0; i<caras.size();i++){
-    Tupla3f v1 = vertices[caras.at(i)[0]];
-    Tupla3f v2 = vertices[caras.at(i)[1]];
-    Tupla3f v3 = vertices[caras.at(i)[2]];
-    //sacamos dos aristas
-    Tupla3f a1 = v2-v1;
-    Tupla3f a2 = v3-v1;
-    Tupla3f v = a1.cross(a2);
-
-    normales_caras.at(i) = normalizar(v);
-
-  //añadimos ahora a tabla de vertices
-    normales_vertices[caras.at(i)[0]] = normales_vertices[caras.at(i)[0]]+normales_caras.at(i);
-    normales_vertices[caras.at(i)[1]] = normales_vertices[caras.at(i)[1]]+normales_caras.at(i);
-    normales_vertices[caras.at(i)[2]] = normales_vertices[caras.at(i)[2]]+normales_caras.at(i);
+  for(unsigned long v=0; v<nv;v++){
+    primera[v+1] += primera[v];
+  }
+  vector<unsigned> siguiente(primera.begin(), primera.end()-1);
+  for(unsigned long i=0; i<nc;i++){
+    caras_ver[siguiente[caras[i](0)]++] = i;
+    caras_ver[siguiente[caras[i](1)]++] = i;
+    caras_ver[siguiente[caras[i](2)]++] = i;
   }
 
-  for(unsigned i=0; i<vertices.size(); i++){
-    Tupla3f nv = normales_vertices.at(i);
-    normales_vertices.at(i) = normalizar(nv);
+  if(soa){
+    normales_soa.resize(nv);
+  }
+  else{
+    normales_vertices.resize(nv);
   }
+  EnParalelo(nv, [&](unsigned long ini, unsigned long fin){
+    for(unsigned long v=ini; v<fin;v++){
+      Tupla3f suma(0.0,0.0,0.0);
+      for(unsigned k=primera[v]; k<primera[v+1];k++){
+        suma = suma+normales_caras[caras_ver[k]];
+      }
+      if(soa){
+        normales_soa.poner(v, suma);
+      }
+      else{
+        normales_vertices[v] = suma;
+      }
+    }
+    if(soa){
+      NormalizarSoA(normales_soa.x.data()+ini, normales_soa.y.data()+ini,
+                    normales_soa.z.data()+ini, fin-ini);
+    }
+    else{
+      NormalizarTabla(normales_vertices.data()+ini, fin-ini);
+    }
+  });
 }
 
 GLuint MallaInd::VBO_Crear(GLuint tipo, GLuint tamanio, GLvoid * puntero){
@@ -92,25 +326,132 @@ GLuint MallaInd::VBO_Crear(GLuint tipo, GLuint tamanio, GLvoid * puntero){
   return id_vbo;
 }
 
+// true si se pueden usar VAOs (OpenGL 3.0 o la extensión correspondiente)
+static bool HayVAOs(){
+#ifdef OSX
+  return true;
+#else
+  return GLEW_VERSION_3_0 || GLEW_ARB_vertex_array_object;
+#endif
+}
+
 void MallaInd::crearVBOs(){
-  //crear VBO conteniendo la tabla de vértices
-  id_vbo_ver = VBO_Crear(GL_ARRAY_BUFFER, 3*sizeof(float)*vertices.size(), vertices.data());
-  //crear VBO conteniendo la tabla de caras
-  id_vbo_tri = VBO_Crear(GL_ELEMENT_ARRAY_BUFFER, 3*sizeof(int)*caras.size(),caras.data());
-  //si hay tabla de colores, crear VBO conteniendo la tabla de colores
-  if( col_ver.size() > 0){
-    id_vbo_col_ver = VBO_Crear( GL_ARRAY_BUFFER, 3*sizeof(float)*vertices.size(), col_ver.data());
+  const unsigned nv = numVertices();
+  const bool hay_nor = tieneNormales(), hay_col = tieneColores(),
+             hay_cctt = cctt.size() >= nv && nv > 0;
+
+  //formato de cada vértice: posición, normal, color y coords. de textura
+  //(solo los que haya), todo en flotantes
+  unsigned nf = 3;
+  desp_nor = desp_col = desp_cctt = -1;
+  if(hay_nor){ desp_nor = nf*sizeof(float); nf += 3; }
+  if(hay_col){ desp_col = nf*sizeof(float); nf += 3; }
+  if(hay_cctt){ desp_cctt = nf*sizeof(float); nf += 2; }
+  tam_vertice = nf*sizeof(float);
+
+  //tabla entrelazada (se lee con los accesores, vale para AoS y SoA)
+  vector<float> atr(size_t(nf)*nv);
+  for(unsigned i=0; i<nv;i++){
+    float * p = &atr[size_t(nf)*i];
+    const Tupla3f v = leerVertice(i);
+    p[0] = v(0); p[1] = v(1); p[2] = v(2); p += 3;
+    if(hay_nor){
+      const Tupla3f n = leerNormal(i);
+      p[0] = n(0); p[1] = n(1); p[2] = n(2); p += 3;
+    }
+    if(hay_col){
+      const Tupla3f c = leerColor(i);
+      p[0] = c(0); p[1] = c(1); p[2] = c(2); p += 3;
+    }
+    if(hay_cctt){
+      p[0] = cctt[i](0); p[1] = cctt[i](1);
+    }
+  }
+
+  //crear VBO con los atributos y VBO con la tabla de caras
+  id_vbo_atr = VBO_Crear(GL_ARRAY_BUFFER, sizeof(float)*atr.size(), atr.data());
+  crearVBOIndices();
+
+  //el VAO guarda los punteros, los arrays activados y el VBO de caras,
+  //así al visualizar basta con activarlo
+  if(HayVAOs()){
+    glGenVertexArrays(1, &id_vao);
+    glBindVertexArray(id_vao);
+    activarPunterosVBO();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
+}
+
+//los índices se guardan en el VBO con el tipo más pequeño en el que caben
+//(8, 16 o 32 bits), que se elige según el número de vértices
+template< class T >
+static GLuint VBO_Indices( const vector<Tupla3i> & caras ){
+  vector<T> ind(3*caras.size());
+  for(unsigned i=0; i<caras.size();i++){
+    ind[3*i+0] = T(caras[i](0));
+    ind[3*i+1] = T(caras[i](1));
+    ind[3*i+2] = T(caras[i](2));
   }
-  //si hay tabla de normales, crear VBO
-  if( normales_vertices.size() > 0){
-    id_vbo_norm_ver = VBO_Crear( GL_ARRAY_BUFFER, 3*sizeof(float)*vertices.size(), normales_vertices.data());
+  GLuint id_vbo;
+  glGenBuffers(1, &id_vbo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_vbo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(T)*ind.size(), ind.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  return id_vbo;
+}
+
+void MallaInd::crearVBOIndices(){
+  const unsigned nv = numVertices();
+  if(nv <= 256){
+    tipo_indices = GL_UNSIGNED_BYTE;
+    id_vbo_tri = VBO_Indices<GLubyte>(caras);
   }
-  //si hay tabla de texturas, crear VBO
-  if( cctt.size() > 0){
-    id_vbo_cctt = VBO_Crear( GL_ARRAY_BUFFER, 2*sizeof(float), cctt.data());
+  else if(nv <= 65536){
+    tipo_indices = GL_UNSIGNED_SHORT;
+    id_vbo_tri = VBO_Indices<GLushort>(caras);
+  }
+  else{
+    tipo_indices = GL_UNSIGNED_INT;
+    id_vbo_tri = VBO_Crear(GL_ELEMENT_ARRAY_BUFFER, 3*sizeof(int)*caras.size(),caras.data());
   }
 }
 
+void MallaInd::activarPunterosVBO(){
+  const char * base = nullptr; //los 'punteros' son desplazamientos en el VBO
+  glBindBuffer(GL_ARRAY_BUFFER, id_vbo_atr);
+  glVertexPointer(3, GL_FLOAT, tam_vertice, base);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  if(desp_nor >= 0){
+    glNormalPointer(GL_FLOAT, tam_vertice, base+desp_nor);
+    glEnableClientState(GL_NORMAL_ARRAY);
+  }
+  if(desp_col >= 0){
+    glColorPointer(3, GL_FLOAT, tam_vertice, base+desp_col);
+    glEnableClientState(GL_COLOR_ARRAY);
+  }
+  if(desp_cctt >= 0){
+    glTexCoordPointer(2, GL_FLOAT, tam_vertice, base+desp_cctt);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_vbo_tri);
+}
+
+//libera los VBOs y el VAO (se vuelven a crear al visualizar)
+void MallaInd::destruirVBOs(){
+  if(!modoVBO){
+    return;
+  }
+  if(id_vao != 0){
+    glDeleteVertexArrays(1, &id_vao);
+  }
+  glDeleteBuffers(1, &id_vbo_atr);
+  glDeleteBuffers(1, &id_vbo_tri);
+  id_vao = id_vbo_atr = id_vbo_tri = 0;
+  modoVBO = false;
+}
+
 // -----------------------------------------------------------------------------
 
 void MallaInd::setLineasPuntos(float grosorL, float grosorP){
@@ -151,6 +492,11 @@ void MallaInd::visualizarDE(){
 //drawElements
 void MallaInd::visualizarDE_MI( ContextoVis & cv )
 {
+  //las tablas SoA no se pueden pasar a glVertexPointer: se usan los VBOs
+  if(disposicion == DisposicionMalla::soa){
+    visualizarDE_VBOs(cv);
+    return;
+  }
   setPolygonMode(cv);
   setLineasPuntos(2,4);
 
@@ -178,18 +524,6 @@ void MallaInd::visualizarDE_MI( ContextoVis & cv )
 
 // ----------------------------------------------------------------------------
 //VISUALIZAR MODO DIFERIDO (vertex buffer objects)
-void MallaInd::visualizarVBOs(){
-  glBindBuffer(GL_ARRAY_BUFFER, id_vbo_ver); //activar VBO usando su ident
-  glVertexPointer( 3, GL_FLOAT, 0, 0); // Establecer dirección y offset
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glEnableClientState(GL_VERTEX_ARRAY); //usar tabla de vertices
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_vbo_tri);
-  glDrawElements( GL_TRIANGLES, 3*caras.size(), GL_UNSIGNED_INT, nullptr);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  glDisableClientState(GL_VERTEX_ARRAY); //desactivar puntero a vertices
-}
-
 void MallaInd::visualizarDE_VBOs( ContextoVis & cv ){
   setPolygonMode(cv);
   setLineasPuntos(2,4);
@@ -199,45 +533,66 @@ void MallaInd::visualizarDE_VBOs( ContextoVis & cv ){
     modoVBO = true;
   }
 
-  if(col_ver.size() > 0){
-    glBindBuffer(GL_ARRAY_BUFFER, id_vbo_col_ver); //act. VBO col.v
-    glColorPointer(3, GL_FLOAT, 0, 0); //formato y offset de colores
-    glEnableClientState( GL_COLOR_ARRAY ); //activa uso de colores de v.
+  if(id_vao != 0){
+    glBindVertexArray(id_vao);
+    glDrawElements( GL_TRIANGLES, 3*caras.size(), tipo_indices, nullptr);
+    glBindVertexArray(0);
+    return;
   }
 
-  if(normales_vertices.size() > 0){
-    glBindBuffer(GL_ARRAY_BUFFER, id_vbo_norm_ver);
-    glNormalPointer(GL_FLOAT, 0, 0);
-    glEnableClientState(GL_NORMAL_ARRAY);
-  }
-
-  if(cctt.size()>0){
-    glBindBuffer(GL_ARRAY_BUFFER, id_vbo_cctt);
-    glTexCoordPointer(2, GL_FLOAT, 0,0);
-    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-  }
-
-  visualizarVBOs();
-
+  //sin VAOs: hay que activar los punteros en cada visualización
+  activarPunterosVBO();
+  glDrawElements( GL_TRIANGLES, 3*caras.size(), tipo_indices, nullptr);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
   glDisableClientState(GL_COLOR_ARRAY );
   glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+//VISUALIZAR EN MODO SELECCIÓN: solo las posiciones, el color es el del
+//identificador (ver FijarColorIdent)
+void MallaInd::visualizarSeleccion( ContextoVis & cv ){
+  setPolygonMode(cv);
+  if(!cv.modoVBO && disposicion != DisposicionMalla::soa){
+    visualizarDE();
+    return;
+  }
+  if(!modoVBO){
+    crearVBOs();
+    modoVBO = true;
+  }
+  //sin el VAO, que activa también normales, colores y coordenadas de textura
+  glBindBuffer(GL_ARRAY_BUFFER, id_vbo_atr);
+  glVertexPointer(3, GL_FLOAT, tam_vertice, nullptr);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_vbo_tri);
+  glDrawElements( GL_TRIANGLES, 3*caras.size(), tipo_indices, nullptr);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void MallaInd::visualizarDE_Plano(ContextoVis & cv){
+  //si las normales de los vertices venian del archivo, las de las caras
+  //no se han calculado todavia
+  if(normales_caras.size() != caras.size()){
+    calcular_normales_caras();
+  }
   glBegin(GL_TRIANGLES);
   for(unsigned i=0; i<caras.size(); i++){
     glNormal3fv(normales_caras.at(i));
     for(unsigned j=0; j<3; j++){
       unsigned iv = caras.at(i)[j];
-      if(col_ver.size()>0){
-        glColor3fv(col_ver.at(iv)); //color actual i-esimo triangulo
+      if(tieneColores()){
+        glColor3fv(leerColor(iv)); //color actual i-esimo triangulo
       }
       if(cctt.size()>0){
         glTexCoord2fv(cctt.at(iv)); //textura actual
       }
       //enviar coordenadas del vertice j del triangulo i
-      glVertex3fv(vertices.at(iv));
+      glVertex3fv(leerVertice(iv));
     }
   }
 
@@ -246,6 +601,12 @@ void MallaInd::visualizarDE_Plano(ContextoVis & cv){
 
 // -----------------------------------------------------------------------------
 void MallaInd::visualizarGL( ContextoVis & cv){
+  cv.numTriangulos += caras.size();
+  cv.numNodosDibujados++ ;
+  if(cv.modoSeleccionFBO){
+    visualizarSeleccion(cv);
+    return;
+  }
   if(cv.modoVis==modoPuntos||cv.modoVis==modoAlambre||cv.modoVis==modoSolido){
     glDisable(GL_LIGHTING);
     glDisable(GL_TEXTURE_2D);
@@ -294,17 +655,174 @@ void MallaInd::setVertices(vector <Tupla3f> v){
   for(unsigned i=0; i<v.size();i++){
     vertices.push_back(v.at(i));
   }
+  invalidarCaja();
 }
 //setter caras
 void MallaInd::setCaras(vector <Tupla3i> c){
   for(unsigned i=0; i<c.size();i++){
     caras.push_back(c.at(i));
   }
+  invalidarCaja();
+}
+
+//caché en disco de las tablas
+bool MallaInd::leerCache( const string & clave ){
+  TablasMalla tablas = { &vertices, &caras, &normales_vertices, &normales_caras, &col_ver, &cctt };
+  return CacheMalla_Leer( clave, tablas );
+}
+
+void MallaInd::guardarCache( const string & clave ){
+  TablasMalla tablas = { &vertices, &caras, &normales_vertices, &normales_caras, &col_ver, &cctt };
+  CacheMalla_Guardar( clave, tablas );
+}
+
+void MallaInd::optimizarCacheVertices(){
+  TablasMalla tablas = { &vertices, &caras, &normales_vertices, &normales_caras, &col_ver, &cctt };
+  OptMalla_Optimizar( tablas, leerNombre() );
+}
+
+void MallaInd::soldarVertices( const float tolerancia ){
+  TablasMalla tablas = { &vertices, &caras, &normales_vertices, &normales_caras, &col_ver, &cctt };
+  OptMalla_SoldarVertices( tablas, tolerancia, leerNombre() );
+  invalidarCaja();
+}
+
+unsigned MallaInd::numCaras() const {
+  return caras.size();
+}
+
+bool MallaInd::intersectarRayo( const Rayo & rayo, float & t ){
+  //(re)construir el BVH si no está o si ha cambiado la geometría desde
+  //entonces (la caja tiene que ser válida para que cuente los cambios)
+  cajaEnglobante();
+  if(bvh == nullptr || invalidaciones_bvh != leerNumInvalidaciones()){
+    vector<CajaEngf> cajas(caras.size());
+    for(unsigned i=0; i<caras.size(); i++){
+      cajas[i].unir(leerVertice(caras[i](0)));
+      cajas[i].unir(leerVertice(caras[i](1)));
+      cajas[i].unir(leerVertice(caras[i](2)));
+    }
+    if(bvh == nullptr)
+      bvh = new BVH();
+    bvh->construir(cajas);
+    invalidaciones_bvh = leerNumInvalidaciones();
+  }
+
+  return bvh->intersectar(rayo, t, [&](const unsigned i, float & t_max){
+    return Rayo_CortaTriangulo(rayo, leerVertice(caras[i](0)), leerVertice(caras[i](1)),
+                               leerVertice(caras[i](2)), t_max, t_max);
+  });
+}
+
+MallaInd * MallaInd::crearSimplificada( const unsigned num_caras ){
+  MallaInd * malla = new MallaInd( leerNombre() + " (simplificada)" );
+  //la simplificación usa las tablas AoS
+  vector<Tupla3f> ver_aos, col_aos;
+  if(disposicion == DisposicionMalla::soa){
+    vertices_soa.aAoS(ver_aos);
+    col_ver_soa.aAoS(col_aos);
+  }
+  const bool soa = disposicion == DisposicionMalla::soa;
+  TablasMalla origen = { soa ? &ver_aos : &vertices, &caras, nullptr, nullptr,
+                         soa ? &col_aos : &col_ver, &cctt };
+  TablasMalla destino = { &malla->vertices, &malla->caras, &malla->normales_vertices,
+                          &malla->normales_caras, &malla->col_ver, &malla->cctt };
+  SimpMalla_Simplificar( origen, num_caras, destino, leerNombre() );
+  malla->calcular_normales();
+  malla->fijarDisposicion( disposicion );
+  return malla;
 }
 
 void MallaInd::fijarColorNodo( const Tupla3f & nuevo_color ){
+  destruirVBOs(); //el VBO tiene los colores anteriores
+  if(disposicion == DisposicionMalla::soa){
+    col_ver_soa.resize(numVertices());
+    for(unsigned i=0; i<numVertices();i++){
+      col_ver_soa.poner(i, nuevo_color);
+    }
+    return;
+  }
   col_ver.clear();
-  for(unsigned i=0; i<=vertices.size();i++){
+  for(unsigned i=0; i<vertices.size();i++){
     col_ver.push_back(nuevo_color);
   }
 }
+
+// -----------------------------------------------------------------------------
+// disposición de las tablas (AoS o SoA) y acceso a ellas
+
+void MallaInd::fijarDisposicion( DisposicionMalla nueva ){
+  if(nueva == disposicion){
+    return;
+  }
+  if(nueva == DisposicionMalla::soa){
+    vertices_soa.desdeAoS(vertices);
+    normales_soa.desdeAoS(normales_vertices);
+    col_ver_soa.desdeAoS(col_ver);
+    vector<Tupla3f>().swap(vertices); //liberar la memoria
+    vector<Tupla3f>().swap(normales_vertices);
+    vector<Tupla3f>().swap(col_ver);
+  }
+  else{
+    vertices_soa.aAoS(vertices);
+    normales_soa.aAoS(normales_vertices);
+    col_ver_soa.aAoS(col_ver);
+    vertices_soa.clear();
+    normales_soa.clear();
+    col_ver_soa.clear();
+  }
+  disposicion = nueva;
+}
+
+DisposicionMalla MallaInd::leerDisposicion() const {
+  return disposicion;
+}
+
+unsigned MallaInd::numVertices() const {
+  return disposicion == DisposicionMalla::soa ? vertices_soa.size() : vertices.size();
+}
+
+Tupla3f MallaInd::leerVertice( unsigned i ) const {
+  return disposicion == DisposicionMalla::soa ? vertices_soa(i) : vertices[i];
+}
+
+Tupla3f MallaInd::leerNormal( unsigned i ) const {
+  return disposicion == DisposicionMalla::soa ? normales_soa(i) : normales_vertices[i];
+}
+
+Tupla3f MallaInd::leerColor( unsigned i ) const {
+  return disposicion == DisposicionMalla::soa ? col_ver_soa(i) : col_ver[i];
+}
+
+bool MallaInd::tieneNormales() const {
+  return disposicion == DisposicionMalla::soa ? normales_soa.size() > 0 : normales_vertices.size() > 0;
+}
+
+bool MallaInd::tieneColores() const {
+  return disposicion == DisposicionMalla::soa ? col_ver_soa.size() > 0 : col_ver.size() > 0;
+}
+
+void MallaInd::calcularCajaVertices( Tupla3f & cmin, Tupla3f & cmax ) const {
+  const unsigned nv = numVertices();
+  cmin = cmax = Tupla3f(0.0,0.0,0.0);
+  if(nv == 0){
+    return;
+  }
+  if(disposicion == DisposicionMalla::soa){
+    //cada coordenada es un array alineado: mínimo y máximo con SIMD
+    MinMaxSoA(vertices_soa.x.data(), nv, cmin(0), cmax(0));
+    MinMaxSoA(vertices_soa.y.data(), nv, cmin(1), cmax(1));
+    MinMaxSoA(vertices_soa.z.data(), nv, cmin(2), cmax(2));
+    return;
+  }
+  MinMaxAoS((const float *) vertices.data(), nv, cmin, cmax);
+}
+
+CajaEngf MallaInd::calcularCajaEnglobante(){
+  if(numVertices() == 0){
+    return CajaEngf();
+  }
+  Tupla3f cmin, cmax;
+  calcularCajaVertices(cmin, cmax);
+  return CajaEngf(cmin, cmax);
+}
@@ -11,8 +11,17 @@
 
 #include <vector>          // usar std::vector
 #include "Objeto3D.hpp"   // declaración de 'Objeto3D'
+#include "TablaSoA.hpp"   // tablas en disposición SoA
+#include "OptimizarMalla.hpp" // tolerancia_soldadura
+#include "BVH.hpp"        // BVH de los triángulos
 
 using namespace std;
+
+// disposición en memoria de las tablas de vértices, normales y colores:
+// array de Tupla3f (AoS, la usada al construir las mallas) o tres arrays
+// de flotantes alineados por tabla (SoA, ver TablaSoA.hpp)
+enum class DisposicionMalla { aos, soa } ;
+
 // ---------------------------------------------------------------------
 // clase para objetos gráficos genéricos
 
@@ -33,13 +42,28 @@ class MallaInd : public Objeto3D
       //textura
       vector <Tupla2f> cctt; //tabla de coords de textura
 
-      //identificadores y VBOs
+      //tablas en disposición SoA: solo se usan si 'disposicion' es 'soa', y
+      //entonces 'vertices', 'normales_vertices' y 'col_ver' están vacías
+      DisposicionMalla disposicion = DisposicionMalla::aos ;
+      TablaSoA3f vertices_soa ;
+      TablaSoA3f normales_soa ;
+      TablaSoA3f col_ver_soa ;
+
+      //identificadores y VBOs: todos los atributos de cada vértice van
+      //seguidos en un único VBO (posición, normal, color, coords. de textura,
+      //los que haya), y un VAO guarda la configuración de los punteros
       bool modoVBO = false ;
-      GLuint id_vbo_ver ; //identificador del VBO con la tabla de vertices
-      GLuint id_vbo_tri ; //identificador del VBO con la tabla de caras
-      GLuint id_vbo_col_ver ; //identificador del VBO con la tabla de colores vertices
-      GLuint id_vbo_norm_ver ;
-      GLuint id_vbo_cctt ; //identificador de VBO de la tabla de texturas
+      GLuint id_vbo_atr = 0 ; //identificador del VBO con los atributos entrelazados
+      GLuint id_vbo_tri = 0 ; //identificador del VBO con la tabla de caras
+      GLuint id_vao     = 0 ; //identificador del VAO (0 si no hay VAOs)
+      GLsizei tam_vertice = 0 ; //bytes por vértice en 'id_vbo_atr'
+      GLenum tipo_indices = GL_UNSIGNED_INT ; //tipo de los índices en 'id_vbo_tri'
+      GLsizei desp_nor = -1, desp_col = -1, desp_cctt = -1 ; //desplazamientos (-1: no hay)
+
+      //BVH de los triángulos para cortar rayos (se construye la primera vez
+      //que se necesita, y otra vez si cambia la geometría, ver intersectarRayo)
+      BVH * bvh = nullptr ;
+      unsigned long invalidaciones_bvh = 0 ; //las de la caja cuando se construyó
 
       //tamaños
       unsigned num_tri; //caras.size()
@@ -47,8 +71,8 @@ class MallaInd : public Objeto3D
       unsigned tam_cctt;
 
       // calculo de las normales de esta malla
-      Tupla3f normalizar(Tupla3f tupla);
       Tupla3f hallarNormal(Tupla3f tupla1, Tupla3f tupla2);
+      void calcular_normales_caras();
       void calcular_normales();
 
       //////////////////// visualizacion //////////////////
@@ -56,6 +80,10 @@ class MallaInd : public Objeto3D
       //vbo unico
       GLuint VBO_Crear(GLuint tipo, GLuint tamanio, GLvoid * puntero);
       void crearVBOs();
+      void crearVBOIndices();
+      void destruirVBOs();
+      //activa los punteros a los atributos del VBO entrelazado
+      void activarPunterosVBO();
 
       //establece el modo
       void setPolygonMode(ContextoVis & cv);
@@ -67,10 +95,12 @@ class MallaInd : public Objeto3D
       void visualizarDE_NT( ContextoVis & cv );
       //DIFERIDO
       // visualizar con 'draw elements', en modo diferido (con VBOS)
-      void visualizarVBOs(); //aux
       void visualizarDE_VBOs( ContextoVis & cv );
       //void visualizarVBOs_NT( ContextoVis & cv );
       void visualizarDE_Plano( ContextoVis & cv );
+      //SELECCIÓN
+      // visualizar solo las posiciones (modo selección, o resaltado)
+      void visualizarSeleccion( ContextoVis & cv );
 
       // colores
       void fijarColorNodo( const Tupla3f & nuevo_color );
@@ -79,14 +109,62 @@ class MallaInd : public Objeto3D
       void setCaras(vector <Tupla3i> c);
       void setLineasPuntos(float grosorL, float grosorP);
 
+      // caché en disco de las tablas (ver CacheMallas.hpp), siempre con
+      // disposición AoS: leerCache devuelve true si se han leído todas las tablas
+      bool leerCache( const string & clave );
+      void guardarCache( const string & clave );
+
+      // caja englobante de los vértices (ver calcularCajaVertices)
+      virtual CajaEngf calcularCajaEnglobante() ;
+
+      // reordena caras y vértices para la caché de vértices de la GPU
+      // (ver OptimizarMalla.hpp), con disposición AoS
+      void optimizarCacheVertices();
+      // suelda los vértices repetidos salvo 'tolerancia' y quita las caras
+      // degeneradas (ver OptimizarMalla.hpp), con disposición AoS
+      void soldarVertices( const float tolerancia = tolerancia_soldadura );
+
    public:
+      // vector normalizado, o (1,0,0) si es nulo
+      static Tupla3f normalizar(Tupla3f tupla);
+
       // crea una malla vacía (nombre: "malla indexada nueva vacía")
       MallaInd() ;
       // crea una malla vacía con un nombre concreto:
       MallaInd( const string & nombreIni );
+      // libera los VBOs, si los hay (se destruye en la hebra principal)
+      virtual ~MallaInd() ;
       // visualizar el objeto con OpenGL
       virtual void visualizarGL( ContextoVis & cv) ;
 
+      // cambia la disposición de las tablas de vértices, normales y colores
+      // (las copia). Con SoA se visualiza siempre con VBOs
+      void fijarDisposicion( DisposicionMalla nueva );
+      DisposicionMalla leerDisposicion() const ;
+
+      // acceso a las tablas con cualquier disposición
+      unsigned numVertices() const ;
+      Tupla3f  leerVertice( unsigned i ) const ;
+      Tupla3f  leerNormal( unsigned i ) const ;
+      Tupla3f  leerColor( unsigned i ) const ;
+      bool     tieneNormales() const ;
+      bool     tieneColores() const ;
+
+      // caja englobante de los vértices: mínimo y máximo de cada coordenada
+      // (los dos a cero si no hay vértices)
+      void calcularCajaVertices( Tupla3f & cmin, Tupla3f & cmax ) const ;
+
+      // número de caras (triángulos)
+      unsigned numCaras() const ;
+
+      // corte más cercano con los triángulos (con el BVH de la malla)
+      virtual bool intersectarRayo( const Rayo & rayo, float & t ) ;
+
+      // crea una malla nueva con esta simplificada hasta 'num_caras' caras
+      // (ver SimplificarMalla.hpp), con la misma disposición y normales
+      // recalculadas
+      MallaInd * crearSimplificada( const unsigned num_caras ) ;
+
 } ;
 // ---------------------------------------------------------------------
 
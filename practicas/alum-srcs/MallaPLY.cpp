@@ -12,37 +12,53 @@
 #include <tuplasg.hpp>
 #include <file_ply_stl.hpp>
 #include "MallaPLY.hpp"
+#include "CacheMallas.hpp"
 
 using namespace std ;
 
 // *****************************************************************************
 
-MallaPLY::MallaPLY( const std::string & nombre_arch )
+MallaPLY::MallaPLY( const std::string & nombre_arch, const bool optimizar,
+                    const float tolerancia_soldar )
 {
+   // Tupla3f, Tupla3i y Tupla2f son tres/dos float/int consecutivos, así que
+   // el archivo se puede leer directamente sobre las tablas, sin copias
+   static_assert( sizeof(Tupla3f) == 3*sizeof(float), "Tupla3f no es compatible con float[3]" );
+   static_assert( sizeof(Tupla3i) == 3*sizeof(int), "Tupla3i no es compatible con int[3]" );
+   static_assert( sizeof(Tupla2f) == 2*sizeof(float), "Tupla2f no es compatible con float[2]" );
+
    ponerNombre(string("malla leída del archivo '") + nombre_arch + "'" );
-   vector <float> vertices;
-   vector <int> caras;
-   //lee un archivo ply y lo carga en vertices y caras
-   //convertimos nombre_arch a cadena de caracteres para no tener problemas
-   const char *nombre_arch_c = nombre_arch.c_str();
-   ply::read(nombre_arch_c, vertices, caras);
-   setVertices(vertices);
-   setCaras(caras);
-   calcular_normales();
-}
-//guardamos los vertices en tuplas
-void MallaPLY::setVertices(vector <float> vertices){
-  for(int i=0; i<vertices.size(); i+=3){
-    Tupla3f t(vertices.at(i),vertices.at(i+1),vertices.at(i+2));
-    this->vertices.push_back(t);
-  }
-}
-//guardamos las caras en tuplas
-void MallaPLY::setCaras(vector <int> caras){
-  for(int i=0; i<caras.size(); i+=3){
-    Tupla3i t(caras.at(i),caras.at(i+1), caras.at(i+2));
-    this->caras.push_back(t);
-  }
+
+   // si la malla ya se construyó en otra ejecución, se lee de la caché
+   const bool   soldar = tolerancia_soldar >= 0.0f ;
+   const string clave  = CacheMalla_Clave( nombre_arch, string("MallaPLY")
+      + ( soldar ? "|soldada=" + to_string( tolerancia_soldar ) : "" )
+      + ( optimizar ? "|optimizada" : "" ) );
+   if ( leerCache( clave ) )
+      return ;
+
+   // normales, colores y coordenadas de textura, si están en el archivo
+   ply::ReservaAtributos atributos ;
+   atributos.normales = [this]( unsigned n ) { normales_vertices.resize(n); return (float *) normales_vertices.data(); } ;
+   atributos.colores  = [this]( unsigned n ) { col_ver.resize(n); return (float *) col_ver.data(); } ;
+   atributos.cctt     = [this]( unsigned n ) { cctt.resize(n); return (float *) cctt.data(); } ;
+
+   ply::read_mmap( nombre_arch.c_str(),
+      [this]( unsigned n ) { vertices.resize(n); return (float *) vertices.data(); },
+      [this]( unsigned n ) { caras.resize(n); return (int *) caras.data(); },
+      atributos );
+
+   if ( soldar )
+      soldarVertices( tolerancia_soldar );
+   if ( optimizar )
+      optimizarCacheVertices();
+
+   // si el archivo trae normales se usan esas (las de las caras se
+   // calculan solo si hacen falta, al visualizar en modo plano)
+   if ( normales_vertices.size() == 0 )
+      calcular_normales();
+
+   guardarCache( clave );
 }
 
 
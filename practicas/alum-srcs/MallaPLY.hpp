@@ -19,11 +19,12 @@
 class MallaPLY : public MallaInd
 {
    public:
-      // crea una malla de revolucion
-      MallaPLY( const std::string & nombre_arch ) ;
-      //setters
-      void setVertices(std::vector <float> vertices) ;
-      void setCaras(std::vector <int> caras) ;
+      // crea una malla leyendo un archivo PLY. Si 'optimizar' es true, se
+      // reordenan caras y vértices para la caché de vértices, y si
+      // 'tolerancia_soldar' no es negativa, antes se sueldan los vértices
+      // repetidos con esa tolerancia (ver OptimizarMalla.hpp)
+      MallaPLY( const std::string & nombre_arch, const bool optimizar = false,
+                const float tolerancia_soldar = -1.0f ) ;
 } ;
 
 #endif
@@ -12,9 +12,19 @@
 #include <matrices-tr.hpp>
 #include <math.h>
 #include "MallaRevol.hpp"
+#include "CacheMallas.hpp"
 
 
 // *****************************************************************************
+//parametros de generacion de una malla de revolucion (para la clave de la cache)
+static string ParametrosRevol(const string & clase, const string & perfil,
+                              const unsigned nperfiles, const bool crear_tapas,
+                              const bool cerrar_malla, const bool usar_texturas){
+  return clase + "(" + perfil + ") nper=" + to_string(nperfiles) +
+         " tapas=" + to_string(crear_tapas) + " cerrar=" + to_string(cerrar_malla) +
+         " texturas=" + to_string(usar_texturas) + " soldada";
+}
+
 //constructor por defecto
 MallaRevol::MallaRevol(){}
 
@@ -98,9 +108,17 @@ void MallaRevol::crearMallaRevol(const std::vector <Tupla3f> &perfil_original, /
 
    }
 
+   //sin texturas, el primer perfil repetido (si no se cierra la malla), los
+   //vertices de los polos repetidos en cada perfil y los centros de las tapas
+   //que coinciden con ellos sobran, y dan costuras en las normales
+   const bool texturas = usar_texturas & !crear_tapas;
+   if(!texturas){
+     soldarVertices();
+   }
+
    calcular_normales();
 
-   if(usar_texturas & !crear_tapas){
+   if(texturas){
      calcularDistancias(perfil_original);
      iniCoordenadasTextura();
    }
@@ -114,6 +132,12 @@ MallaRevol::MallaRevol( const std::string & nombre_arch,
    //ponemos nombre a la malla de revolucion
    nper = nperfiles;
    ponerNombre( std::string("malla por revolución del perfil en '"+ nombre_arch + "'" ));
+   //si ya se genero en otra ejecucion, se lee de la cache
+   const string clave = CacheMalla_Clave(nombre_arch,
+      ParametrosRevol("MallaRevol", "", nperfiles, crear_tapas, cerrar_malla, false));
+   if(leerCache(clave)){
+     return;
+   }
    //leer perfil del archivo
    std::vector <float> perfil_original;
    const char *nombreArch = nombre_arch.c_str();
@@ -127,6 +151,7 @@ MallaRevol::MallaRevol( const std::string & nombre_arch,
    nvp = perfil.size();
    //crear malla revolucion
    crearMallaRevol(perfil, nper, crear_tapas, cerrar_malla, false);
+   guardarCache(clave);
 }
 
 MallaRevol::MallaRevol( const std::string & nombre_arch,
@@ -137,6 +162,12 @@ MallaRevol::MallaRevol( const std::string & nombre_arch,
    //ponemos nombre a la malla de revolucion
    nper = nperfiles;
    ponerNombre( std::string("malla por revolución del perfil en '"+ nombre_arch + "'" ));
+   //si ya se genero en otra ejecucion, se lee de la cache
+   const string clave = CacheMalla_Clave(nombre_arch,
+      ParametrosRevol("MallaRevol", "", nperfiles, crear_tapas, cerrar_malla, usar_texturas));
+   if(leerCache(clave)){
+     return;
+   }
    //leer perfil del archivo
    std::vector <float> perfil_original;
    const char *nombreArch = nombre_arch.c_str();
@@ -150,6 +181,7 @@ MallaRevol::MallaRevol( const std::string & nombre_arch,
    nvp = perfil.size();
    //crear malla revolucion
    crearMallaRevol(perfil, nper, crear_tapas, cerrar_malla, usar_texturas);
+   guardarCache(clave);
 }
 
 Cilindro::Cilindro(const int num_verts_per, //numero de vertices del perfil original (M)
@@ -159,11 +191,17 @@ Cilindro::Cilindro(const int num_verts_per, //numero de vertices del perfil orig
    setnper(nperfiles);
    setnvp(num_verts_per);
    ponerNombre( std::string("malla por revolución del cilindro" ));
+   const string clave = CacheMalla_Clave("",
+      ParametrosRevol("Cilindro", to_string(num_verts_per), nperfiles, crear_tapas, cerrar_malla, false));
+   if(leerCache(clave)){
+     return;
+   }
    std::vector <Tupla3f> perfil;
    for(unsigned i=0; i<num_verts_per;i++){
      perfil.push_back(Tupla3f(1.0,(1.0/num_verts_per)*i,0.0));
    }
    crearMallaRevol(perfil,nperfiles,crear_tapas,cerrar_malla, false);
+   guardarCache(clave);
 }
 Cono::Cono(
           const int num_verts_per, //numero de vertices del perfil original (M)
@@ -173,6 +211,11 @@ Cono::Cono(
    setnper(nperfiles);
    setnvp(num_verts_per);
    ponerNombre( std::string("malla por revolución del cono" ));
+   const string clave = CacheMalla_Clave("",
+      ParametrosRevol("Cono", to_string(num_verts_per), nperfiles, crear_tapas, cerrar_malla, false));
+   if(leerCache(clave)){
+     return;
+   }
    float radio = 1.0;
    float altura = 1.0;
 
@@ -183,6 +226,7 @@ Cono::Cono(
                               0.0));
    }
    crearMallaRevol(perfil,nperfiles,crear_tapas,cerrar_malla, false);
+   guardarCache(clave);
 }
 Esfera::Esfera(
               const int num_verts_per, //numero de vertices del perfil original(M)
@@ -193,6 +237,11 @@ Esfera::Esfera(
    setnper(nperfiles);
    setnvp(num_verts_per);
    ponerNombre( std::string("malla por revolución de la esfera" ));
+   const string clave = CacheMalla_Clave("",
+      ParametrosRevol("Esfera", to_string(num_verts_per), nperfiles, crear_tapas, cerrar_malla, false));
+   if(leerCache(clave)){
+     return;
+   }
    std::vector <Tupla3f> perfil;
    float radio = 1.0;
    float seccion = (radio*2.0)/(num_verts_per-1.0);
@@ -201,6 +250,7 @@ Esfera::Esfera(
      perfil.push_back(Tupla3f(sqrt(radio*radio-y*y), y ,0.0));
    }
    crearMallaRevol(perfil,nperfiles,crear_tapas,cerrar_malla, false);
+   guardarCache(clave);
 }
 
 ConoTruncado::ConoTruncado(float radioBase, float radioTapa,
@@ -209,6 +259,12 @@ ConoTruncado::ConoTruncado(float radioBase, float radioTapa,
     setnper(nperfiles);
     setnvp(num_verts_per);
     ponerNombre( std::string("malla por revolución del cono truncado" ));
+    const string clave = CacheMalla_Clave("",
+       ParametrosRevol("ConoTruncado", to_string(radioBase) + "," + to_string(radioTapa) + "," +
+                       to_string(num_verts_per), nperfiles, crear_tapas, cerrar_malla, false));
+    if(leerCache(clave)){
+      return;
+    }
     std::vector <Tupla3f> perfil;
     for(unsigned i=0; i<num_verts_per;i++){
       perfil.push_back(Tupla3f(((radioBase-radioTapa)/(num_verts_per-1.0))*(num_verts_per-1.0-i)+radioTapa,
@@ -216,6 +272,7 @@ ConoTruncado::ConoTruncado(float radioBase, float radioTapa,
                                0.0));
     }
     crearMallaRevol(perfil,nperfiles,crear_tapas,cerrar_malla, false);
+    guardarCache(clave);
   }
 
   void MallaRevol::iniCoordenadasTextura(){
@@ -0,0 +1,123 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Nodo con niveles de detalle de una malla (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <algorithm>
+#include "aux.hpp"
+#include "NodoLOD.hpp"
+#include "Arena.hpp"
+
+using namespace std ;
+
+// *****************************************************************************
+
+NodoLOD::NodoLOD( MallaInd * malla, const std::vector<float> & proporciones,
+                  const float densidad_ini )
+{
+   assert( malla != nullptr );
+   ponerNombre( malla->leerNombre() + " (con niveles de detalle)" );
+   densidad  = densidad_ini ;
+   nivel_act = 0 ;
+
+   // cada nivel se obtiene del anterior, que ya es más simple que el original
+   niveles.push_back( malla );
+   for( unsigned i = 0 ; i < proporciones.size() ; i++ )
+   {  const unsigned num_caras = unsigned( proporciones[i]*malla->numCaras() );
+      if ( num_caras < 4 || num_caras >= niveles.back()->numCaras() )
+         continue ;
+      niveles.push_back( niveles.back()->crearSimplificada( num_caras ) );
+      niveles.back()->ponerNombre( malla->leerNombre() + " (nivel " + to_string( niveles.size()-1 ) + ")" );
+   }
+
+   // esfera englobante: la que contiene a la caja de la malla original
+   const CajaEngf caja = malla->cajaEnglobante();
+   centro_esf = caja.centro();
+   radio_esf  = std::sqrt( (caja.maximo-caja.minimo).lengthSq() )*0.5f ;
+   ponerCentroOC( centro_esf );
+}
+// -----------------------------------------------------------------------------
+
+CajaEngf NodoLOD::calcularCajaEnglobante()
+{
+   return niveles[0]->cajaEnglobante();
+}
+// -----------------------------------------------------------------------------
+
+bool NodoLOD::intersectarRayo( const Rayo & rayo, float & t )
+{
+   return niveles[0]->intersectarRayo( rayo, t );
+}
+// -----------------------------------------------------------------------------
+
+float NodoLOD::radioProyectado()
+{
+   GLfloat mv[16], pr[16] ;
+   GLint   vp[4] ;
+   glGetFloatv( GL_MODELVIEW_MATRIX, mv );
+   glGetFloatv( GL_PROJECTION_MATRIX, pr );
+   glGetIntegerv( GL_VIEWPORT, vp );
+
+   // el radio se escala con el mayor factor de escala de la matriz de modelado
+   float escala2 = 0.0f ;
+   for( unsigned j = 0 ; j < 3 ; j++ )
+      escala2 = std::max( escala2, mv[4*j]*mv[4*j] + mv[4*j+1]*mv[4*j+1] + mv[4*j+2]*mv[4*j+2] );
+   const float r          = radio_esf*std::sqrt( escala2 ),
+               medio_alto = 0.5f*vp[3] ;
+
+   // proyección ortográfica: el tamaño no depende de la distancia
+   if ( pr[15] != 0.0f )
+      return r*pr[5]*medio_alto ;
+
+   // perspectiva: se divide por la distancia del centro al observador
+   // (si el observador está dentro de la esfera, el tamaño es ilimitado)
+   const float dist = -( mv[2]*centro_esf(0) + mv[6]*centro_esf(1) + mv[10]*centro_esf(2) + mv[14] );
+   if ( dist <= r )
+      return INFINITY ;
+   return r*pr[5]*medio_alto/dist ;
+}
+// -----------------------------------------------------------------------------
+
+void NodoLOD::visualizarGL( ContextoVis & cv )
+{
+   // el nivel más simple con al menos 'densidad' triángulos por pixel
+   const float    radio_px = radioProyectado(),
+                  objetivo = densidad*float(M_PI)*radio_px*radio_px ;
+   unsigned nivel = niveles.size()-1 ;
+   while( nivel > 0 && float( niveles[nivel]->numCaras() ) < objetivo )
+      nivel-- ;
+
+   nivel_act = nivel ;
+   niveles[nivel]->visualizarGL( cv );
+}
+// -----------------------------------------------------------------------------
+
+void NodoLOD::fijarColorNodo( const Tupla3f & nuevo_color )
+{
+   // (en MallaInd 'fijarColorNodo' es protegido, se llama como Objeto3D)
+   for( unsigned i = 0 ; i < niveles.size() ; i++ )
+      static_cast<Objeto3D *>( niveles[i] )->fijarColorNodo( nuevo_color );
+}
+// -----------------------------------------------------------------------------
+
+unsigned NodoLOD::numNiveles() const
+{
+   return niveles.size() ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned NodoLOD::nivelActual() const
+{
+   return nivel_act ;
+}
+// -----------------------------------------------------------------------------
+
+NodoLOD::~NodoLOD()
+{
+   for( unsigned i = 0 ; i < niveles.size() ; i++ )
+      Arena_Borrar( niveles[i] ); // los de una arena los destruye ella
+}
@@ -0,0 +1,70 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Nodo con niveles de detalle de una malla (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_NODOLOD_HPP
+#define IG_NODOLOD_HPP
+
+#include <vector>
+#include "MallaInd.hpp"
+
+// ---------------------------------------------------------------------
+// Objeto con una cadena de mallas cada vez más simplificadas (niveles de
+// detalle, LOD) de una malla original, obtenidas con cuádricas de error
+// (ver SimplificarMalla.hpp). Al visualizar se elige el nivel según el
+// tamaño en pantalla de la esfera englobante de la malla, proyectada con
+// las matrices de OpenGL actuales (las que ha fijado la cámara activa,
+// incluidas las transformaciones de los nodos padre).
+
+// proporciones de caras (respecto de la original) de los niveles por defecto
+const std::vector<float> proporciones_lod = { 0.5f, 0.25f, 0.1f } ;
+
+// triángulos por pixel de la esfera proyectada, por defecto
+const float densidad_lod = 0.5f ;
+
+class NodoLOD : public Objeto3D
+{
+   private:
+      std::vector<MallaInd *> niveles ;   // niveles[0] es la malla original (propietario de todos)
+      Tupla3f                 centro_esf ; // esfera englobante en coordenadas de objeto
+      float                   radio_esf ,
+                              densidad ;   // triángulos por pixel que se quieren dibujar
+      unsigned                nivel_act ;  // último nivel visualizado
+
+      // radio en pixels de la esfera englobante proyectada
+      float radioProyectado() ;
+
+   protected:
+      // la de la malla original
+      virtual CajaEngf calcularCajaEnglobante() ;
+
+   public:
+      // construye los niveles simplificando 'malla' (que pasa a ser de este
+      // nodo) con cada proporción de 'proporciones' (en orden decreciente).
+      // Se usa el nivel más simple que tenga al menos 'densidad' triángulos
+      // por pixel de la esfera proyectada
+      NodoLOD( MallaInd * malla,
+               const std::vector<float> & proporciones = proporciones_lod,
+               const float densidad_ini = densidad_lod );
+
+      // visualiza el nivel adecuado
+      virtual void visualizarGL( ContextoVis & cv ) ;
+
+      // fija el color en todos los niveles
+      virtual void fijarColorNodo( const Tupla3f & nuevo_color ) ;
+
+      // corta con la malla original (la selección no depende del nivel)
+      virtual bool intersectarRayo( const Rayo & rayo, float & t ) ;
+
+      // número de niveles y nivel visualizado la última vez
+      unsigned numNiveles() const ;
+      unsigned nivelActual() const ;
+
+      virtual ~NodoLOD() ;
+} ;
+
+#endif
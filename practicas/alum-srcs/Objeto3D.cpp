@@ -7,7 +7,11 @@
 // *********************************************************************
 
 #include <iostream>
+#include <algorithm>
 #include "Objeto3D.hpp"
+#include "ColaVisualizacion.hpp"
+#include "IndiceIdentificadores.hpp"
+#include "Arena.hpp"
 
 using namespace std ;
 
@@ -15,6 +19,9 @@ using namespace std ;
 Objeto3D::Objeto3D()
 {
   centro_calculado = false;
+  caja_calculada = false;
+  num_invalidaciones = 0;
+  num_cambios_estructura = 0;
    ponerIdentificador( 0 );
    ponerNombre("objeto anónimo");
    ponerCentroOC( Tupla3f( 0.0, 0.0, 0.0 ) );
@@ -45,6 +52,7 @@ int Objeto3D::leerIdentificador()
 void Objeto3D::ponerIdentificador( int nuevoIdent )
 {
    identificador = nuevoIdent ;
+   cambioEstructura();
    cout << "Identificador asignado objeto " << leerNombre() << " " << nuevoIdent << endl;
 }
 
@@ -72,6 +80,63 @@ void Objeto3D::calcularCentroOC()
 
 void Objeto3D::fijarColorNodo( const Tupla3f & nuevo_color ) {}
 
+// -----------------------------------------------------------------------------
+// caja englobante (con caché)
+
+CajaEngf Objeto3D::calcularCajaEnglobante()
+{
+   return CajaEngf();
+}
+
+CajaEngf Objeto3D::cajaEnglobante()
+{
+   if ( ! caja_calculada )
+   {  caja_oc        = calcularCajaEnglobante();
+      caja_calculada = true ;
+   }
+   return caja_oc ;
+}
+
+void Objeto3D::invalidarCaja()
+{
+   // si la caja ya no era válida, tampoco lo son las de los padres
+   // (cuando se calcula la caja de un nodo, antes se calculan las de sus hijos)
+   if ( ! caja_calculada && ! centro_calculado )
+      return ;
+   caja_calculada   = false ;
+   centro_calculado = false ;
+   num_invalidaciones++ ;
+   for( unsigned i = 0 ; i < padres.size() ; i++ )
+      padres[i]->invalidarCaja();
+}
+
+unsigned long Objeto3D::leerNumInvalidaciones() const
+{
+   return num_invalidaciones ;
+}
+
+void Objeto3D::cambioEstructura()
+{
+   num_cambios_estructura++ ;
+   for( unsigned i = 0 ; i < padres.size() ; i++ )
+      padres[i]->cambioEstructura();
+}
+
+unsigned long Objeto3D::leerNumCambiosEstructura() const
+{
+   return num_cambios_estructura ;
+}
+
+void Objeto3D::agregarPadre( Objeto3D * padre )
+{
+   padres.push_back( padre );
+}
+
+void Objeto3D::quitarPadre( Objeto3D * padre )
+{
+   padres.erase( std::remove( padres.begin(), padres.end(), padre ), padres.end() );
+}
+
 // -----------------------------------------------------------------------------
 // buscar un identificador (implementación por defecto para todos los Objeto3D)
 
@@ -96,6 +161,67 @@ bool Objeto3D::buscarObjeto
       return false ;
 }
 
+// -----------------------------------------------------------------------------
+// buscar varios objetos (implementación por defecto: solo el propio objeto)
+
+void Objeto3D::buscarObjetos
+(
+   const std::vector<int> &  idents,
+   const Matriz4f &          mmodelado,
+   std::vector<Objeto3D *> & objetos,
+   std::vector<Tupla3f> &    centros_wc,
+   unsigned &                pendientes
+)
+{
+   const auto it = lower_bound( idents.begin(), idents.end(), identificador );
+   if ( it == idents.end() || *it != identificador )
+      return ;
+   const unsigned i = it - idents.begin();
+   if ( objetos[i] != nullptr )
+      return ;
+   objetos[i]    = this ;
+   centros_wc[i] = mmodelado*leerCentroOC();
+   pendientes-- ;
+}
+
+// -----------------------------------------------------------------------------
+// corte de un rayo (implementación por defecto: la caja englobante)
+
+bool Objeto3D::intersectarRayo( const Rayo & rayo, float & t )
+{
+   float t_caja ;
+   if ( ! Rayo_CortaCaja( rayo, cajaEnglobante(), t, t_caja ) )
+      return false ;
+   t = t_caja ;
+   return true ;
+}
+
+// -----------------------------------------------------------------------------
+// añadir el objeto a una cola de visualización (implementación por defecto
+// para todos los Objeto3D: son hojas)
+
+void Objeto3D::aplanar( ColaVisualizacion & cola, const EstadoAplanado & estado )
+{
+   ElementoCola e ;
+   e.objeto             = this ;
+   e.instancia          = estado.instancia ;
+   e.entrada            = estado.entrada ;
+   e.material           = estado.material ;
+   e.instancia_material = estado.instancia_material ;
+   e.entrada_material   = estado.entrada_material ;
+   e.identificador      = ( identificador == -1 ) ? estado.identificador : identificador ;
+   cola.agregar( e );
+}
+
+// -----------------------------------------------------------------------------
+// añadir el identificador del objeto a un índice (implementación por defecto
+// para todos los Objeto3D: no tienen nada por debajo)
+
+void Objeto3D::indexar( IndiceIdentificadores & indice, const int paso )
+{
+   indice.agregar( identificador, paso );
+}
+
 // -----------------------------------------------------------------------------
 // destructor
 Objeto3D::~Objeto3D()
@@ -103,3 +229,15 @@ Objeto3D::~Objeto3D()
    using namespace std ;
    cout << "destruyendo objeto3D de nombre: " << nombre_obj << endl << flush ;
 }
+// -----------------------------------------------------------------------------
+
+void * Objeto3D::operator new( std::size_t tam )
+{
+   return Arena_Reservar( tam, []( void * p ) { static_cast<Objeto3D *>( p )->~Objeto3D(); } );
+}
+// -----------------------------------------------------------------------------
+
+void Objeto3D::operator delete( void * p )
+{
+   Arena_Liberar( p );
+}
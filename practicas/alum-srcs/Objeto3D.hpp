@@ -10,9 +10,16 @@
 #define IG_OBJETO3D_HPP
 
 #include <string>          // usar std::string
+#include <vector>          // usar std::vector
 #include "practicas.hpp"   // declaración de 'ContextoVis'
+#include "CajaEngf.hpp"    // declaración de 'CajaEngf'
+#include "Rayo.hpp"        // declaración de 'Rayo'
 #include <tuplasg.hpp>
 
+class ColaVisualizacion ;
+class IndiceIdentificadores ;
+struct EstadoAplanado ;
+
 // ---------------------------------------------------------------------
 // clase para objetos gráficos genéricos
 
@@ -23,10 +30,20 @@ class Objeto3D
       int          identificador ; // identificador de este objeto
                                    // 0: no tiene identificador, -1: identificador del padre,
                                    // >0: tiene este identificador
+      CajaEngf     caja_oc ;       // caja englobante en coordenadas de objeto (si 'caja_calculada')
+      bool         caja_calculada ;
+      unsigned long num_invalidaciones ; // veces que la caja ha dejado de ser válida
+      unsigned long num_cambios_estructura ; // veces que han cambiado las entradas por debajo
+      std::vector<Objeto3D *> padres ; // nodos que contienen este objeto (no propietario)
+
       protected:
       Tupla3f      centro_oc ;     // punto central o representativo del objeto, en coordenadas de objeto
       bool centro_calculado;
 
+      // calcula la caja englobante en coordenadas de objeto (por defecto
+      // vacía). Solo se llama desde 'cajaEnglobante' si la caja no es válida
+      virtual CajaEngf calcularCajaEnglobante() ;
+
    public:
       // pone el identificador a '0', siempre
       Objeto3D() ;
@@ -43,7 +60,9 @@ class Objeto3D
       // devuelve el identificador del objeto:
       int leerIdentificador() ;
 
-      // ponerle un identificador al objeto
+      // ponerle un identificador al objeto (cuenta como un cambio de
+      // estructura: las colas e índices de los nodos que lo contienen
+      // guardan los identificadores)
       void ponerIdentificador( int nuevoIdent );
 
       // poner el centro del objeto:
@@ -57,9 +76,37 @@ class Objeto3D
 
       virtual void fijarColorNodo( const Tupla3f & nuevo_color ) ;
 
+      // caja englobante en coordenadas de objeto, se recalcula solo si se ha
+      // invalidado desde la última vez
+      virtual CajaEngf cajaEnglobante() ;
+
+      // marca como no válidas la caja (y el centro) de este objeto y de los
+      // nodos que lo contienen. Hay que llamarlo si cambia la geometría o
+      // alguna matriz de un nodo
+      void invalidarCaja() ;
+
+      // número de veces que la caja ha pasado de válida a no válida: si no
+      // cambia, no ha cambiado nada de lo que hay por debajo del objeto
+      unsigned long leerNumInvalidaciones() const ;
+
+      // hay que llamarlo si cambian las entradas de un nodo por debajo de este
+      // objeto (no solo sus matrices): aumenta el número de cambios de
+      // estructura de este objeto y de todos los nodos que lo contienen
+      void cambioEstructura() ;
+      unsigned long leerNumCambiosEstructura() const ;
+
+      // añadir o quitar un nodo de la lista de nodos que contienen este
+      // objeto (lo hace NodoGrafoEscena al agregar entradas o destruirse)
+      void agregarPadre( Objeto3D * padre );
+      void quitarPadre( Objeto3D * padre );
+
       // destructor
       virtual ~Objeto3D();
 
+      // los objetos se crean en la arena activa, si la hay (ver Arena.hpp)
+      static void * operator new( std::size_t tam ) ;
+      static void   operator delete( void * p ) ;
+
       // método para buscar un objeto con un identificador y devolver
       // un puntero al objeto y el punto central
       //
@@ -78,6 +125,32 @@ class Objeto3D
       virtual bool buscarObjeto( const int ident_busc,
          const Matriz4f & mmodelado, Objeto3D ** objeto, Tupla3f & centro_wc )  ;
 
+      // buscar a la vez varios objetos, en un solo recorrido: 'idents' son
+      // los identificadores a buscar, de menor a mayor. Para cada uno que se
+      // encuentra (el primero, como 'buscarObjeto') se ponen en la misma
+      // posición de 'objetos' y 'centros_wc' el objeto y su centro, y se
+      // decrementa 'pendientes' (el recorrido para cuando llega a 0). Las
+      // posiciones de 'objetos' no encontrados tienen que estar a nullptr
+      virtual void buscarObjetos( const std::vector<int> & idents, const Matriz4f & mmodelado,
+         std::vector<Objeto3D *> & objetos, std::vector<Tupla3f> & centros_wc,
+         unsigned & pendientes ) ;
+
+      // corte del rayo 'rayo' (en coordenadas de objeto) con el objeto: si
+      // lo corta antes de 't', pone en 't' el parámetro del corte más
+      // cercano y devuelve true (ver Rayo.hpp). Por defecto se corta con la
+      // caja englobante
+      virtual bool intersectarRayo( const Rayo & rayo, float & t ) ;
+
+      // añadir a 'cola' las hojas de este objeto (ver ColaVisualizacion.hpp),
+      // con el estado del recorrido en el padre. Por defecto el objeto es una
+      // hoja: se añade él mismo
+      virtual void aplanar( ColaVisualizacion & cola, const EstadoAplanado & estado ) ;
+
+      // añadir a 'indice' el identificador de este objeto y los de los que
+      // hay por debajo (ver IndiceIdentificadores.hpp), siendo 'paso' por
+      // el que se llega a él. Por defecto solo el del objeto
+      virtual void indexar( IndiceIdentificadores & indice, const int paso ) ;
+
 } ;
 
 
@@ -0,0 +1,426 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Soldadura de vértices y reordenación para la caché de vértices (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include "OptimizarMalla.hpp"
+#include "Paralelo.hpp"
+
+using namespace std ;
+
+// *****************************************************************************
+// constantes del algoritmo de Forsyth (los valores del artículo original)
+
+static const unsigned tam_cache_forsyth  = 32 ;    // tamaño de la caché LRU simulada
+static const float    potencia_decaim    = 1.5f ,  // caída de la puntuación con la posición
+                      puntos_ultima_cara = 0.75f , // vértices de la última cara emitida
+                      escala_valencia    = 2.0f ,  // premio a vértices con pocas caras pendientes
+                      potencia_valencia  = 0.5f ;
+static const unsigned max_valencia_tabla = 64 ;    // valencias con puntuación precalculada
+
+// -----------------------------------------------------------------------------
+// puntuación de un vértice según su posición en la caché (-1 si no está)
+// y el número de caras que le quedan por emitir
+
+static float PuntuacionVertice( const int pos_cache, const unsigned restantes )
+{
+   // tablas precalculadas (la inicialización de una variable local estática
+   // es segura aunque se optimicen mallas en varias hebras a la vez)
+   struct Tablas
+   {  float cache[tam_cache_forsyth], valencia[max_valencia_tabla] ;
+      Tablas()
+      {  for( unsigned i = 0 ; i < tam_cache_forsyth ; i++ )
+            cache[i] = i < 3 ? puntos_ultima_cara :
+               pow( 1.0f - float(i-3)/float(tam_cache_forsyth-3), potencia_decaim );
+         valencia[0] = 0.0f ;
+         for( unsigned i = 1 ; i < max_valencia_tabla ; i++ )
+            valencia[i] = escala_valencia*pow( float(i), -potencia_valencia );
+      }
+   } ;
+   static const Tablas tablas ;
+
+   if ( restantes == 0 )
+      return -1.0f ;
+
+   const float p = pos_cache < 0 ? 0.0f : tablas.cache[pos_cache] ;
+   return p + ( restantes < max_valencia_tabla ? tablas.valencia[restantes] :
+                escala_valencia*pow( float(restantes), -potencia_valencia ) );
+}
+
+// -----------------------------------------------------------------------------
+// permuta una tabla por vértice (si tiene un elemento por vértice)
+
+template< class T >
+static void PermutarTabla( std::vector<T> * tabla, const std::vector<unsigned> & nuevo )
+{
+   if ( tabla == nullptr || tabla->size() != nuevo.size() )
+      return ;
+   std::vector<T> perm( tabla->size() );
+   for( unsigned v = 0 ; v < nuevo.size() ; v++ )
+      perm[nuevo[v]] = (*tabla)[v] ;
+   tabla->swap( perm );
+}
+
+// -----------------------------------------------------------------------------
+// true si los elementos 'a' y 'b' de una tabla por vértice son iguales salvo
+// 'tol' en cada componente (las tablas vacías o con otro número de elementos
+// no se comparan)
+
+template< class T >
+static bool AtributosIguales( const std::vector<T> * tabla, const unsigned nv,
+                              const unsigned a, const unsigned b, const float tol )
+{
+   if ( tabla == nullptr || tabla->size() != nv )
+      return true ;
+   const float * pa = (const float *) &(*tabla)[a],
+               * pb = (const float *) &(*tabla)[b] ;
+   for( unsigned k = 0 ; k < sizeof(T)/sizeof(float) ; k++ )
+      if ( std::fabs( pa[k]-pb[k] ) > tol )
+         return false ;
+   return true ;
+}
+
+// -----------------------------------------------------------------------------
+// compacta una tabla por vértice: se quedan los vértices que son su propio
+// representante, el vértice 'v' pasa a la posición 'nuevo[v]'
+
+template< class T >
+static void CompactarTabla( std::vector<T> * tabla, const std::vector<unsigned> & repr,
+                            const std::vector<unsigned> & nuevo, const unsigned nv_nuevo )
+{
+   if ( tabla == nullptr || tabla->size() != repr.size() )
+      return ;
+   std::vector<T> comp( nv_nuevo );
+   for( unsigned v = 0 ; v < repr.size() ; v++ )
+      if ( repr[v] == v )
+         comp[nuevo[v]] = (*tabla)[v] ;
+   tabla->swap( comp );
+}
+
+// -----------------------------------------------------------------------------
+// bytes ocupados por las tablas de vértices y caras (sin las normales de caras)
+
+static unsigned long BytesTablas( const TablasMalla & tablas )
+{
+   return tablas.vertices->size()*sizeof(Tupla3f) + tablas.caras->size()*sizeof(Tupla3i)
+        + ( tablas.normales_vertices ? tablas.normales_vertices->size()*sizeof(Tupla3f) : 0 )
+        + ( tablas.col_ver ? tablas.col_ver->size()*sizeof(Tupla3f) : 0 )
+        + ( tablas.cctt ? tablas.cctt->size()*sizeof(Tupla2f) : 0 ) ;
+}
+
+// -----------------------------------------------------------------------------
+// celda de la rejilla y su posición en la tabla hash (de tamaño potencia de 2)
+
+struct CeldaRejilla
+{  int i, j, k ;
+} ;
+
+static inline unsigned HashCelda( const int i, const int j, const int k, const uint64_t mascara )
+{
+   return unsigned( ( uint64_t(uint32_t(i))*73856093ULL ^ uint64_t(uint32_t(j))*19349663ULL ^
+                      uint64_t(uint32_t(k))*83492791ULL ) & mascara );
+}
+
+// *****************************************************************************
+
+float OptMalla_ACMR( const std::vector<Tupla3i> & caras, const unsigned num_vertices,
+                     const unsigned tam_cache )
+{
+   if ( caras.size() == 0 )
+      return 0.0f ;
+
+   // un vértice está en la caché FIFO si ha entrado hace menos de 'tam_cache' fallos
+   std::vector<long> entrada( num_vertices, -1 );
+   long fallos = 0 ;
+
+   for( unsigned i = 0 ; i < caras.size() ; i++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  const unsigned v = caras[i](k) ;
+         if ( entrada[v] < 0 || fallos - entrada[v] >= long(tam_cache) )
+         {  entrada[v] = fallos ;
+            fallos++ ;
+         }
+      }
+   return float(fallos)/float(caras.size()) ;
+}
+
+// -----------------------------------------------------------------------------
+
+void OptMalla_ReordenarCaras( std::vector<Tupla3i> & caras, const unsigned num_vertices )
+{
+   const unsigned nc = caras.size(), nv = num_vertices ;
+   if ( nc == 0 )
+      return ;
+
+   // caras pendientes de cada vértice (CSR): lista[primera[v]] ... lista[primera[v]+restantes[v]-1]
+   std::vector<unsigned> primera( nv+1, 0 ), restantes( nv, 0 ), lista( 3*nc );
+   for( unsigned i = 0 ; i < nc ; i++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         primera[caras[i](k)+1]++ ;
+   for( unsigned v = 0 ; v < nv ; v++ )
+      primera[v+1] += primera[v] ;
+   for( unsigned i = 0 ; i < nc ; i++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  const unsigned v = caras[i](k) ;
+         lista[primera[v]+restantes[v]] = i ;
+         restantes[v]++ ;
+      }
+
+   std::vector<int>   pos_cache( nv, -1 );
+   std::vector<float> punt_ver( nv ), punt_cara( nc );
+   std::vector<bool>  emitida( nc, false );
+
+   for( unsigned v = 0 ; v < nv ; v++ )
+      punt_ver[v] = PuntuacionVertice( -1, restantes[v] );
+
+   int   mejor   = -1 ;
+   float punt_mejor = -1.0f ;
+   for( unsigned i = 0 ; i < nc ; i++ )
+   {  punt_cara[i] = punt_ver[caras[i](0)] + punt_ver[caras[i](1)] + punt_ver[caras[i](2)] ;
+      if ( punt_cara[i] > punt_mejor )
+      {  punt_mejor = punt_cara[i] ;
+         mejor      = i ;
+      }
+   }
+
+   std::vector<Tupla3i>  resultado ;
+   std::vector<unsigned> cache, nueva ;
+   unsigned              cursor = 0 ; // caras anteriores a 'cursor' ya emitidas
+   resultado.reserve( nc );
+
+   for( unsigned n = 0 ; n < nc ; n++ )
+   {
+      // si ninguna cara de los vértices de la caché está pendiente, se sigue
+      // por la primera pendiente en el orden original
+      if ( mejor < 0 )
+      {  while( emitida[cursor] )
+            cursor++ ;
+         mejor = cursor ;
+      }
+      const Tupla3i cara = caras[mejor] ;
+      resultado.push_back( cara );
+      emitida[mejor] = true ;
+
+      // quitar la cara de las listas de pendientes de sus vértices
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  const unsigned v = cara(k), ini = primera[v] ;
+         for( unsigned j = ini ; j < ini+restantes[v] ; j++ )
+            if ( lista[j] == unsigned(mejor) )
+            {  lista[j] = lista[ini+restantes[v]-1] ;
+               restantes[v]-- ;
+               break ;
+            }
+      }
+
+      // caché LRU: los vértices de la cara al principio, luego el resto
+      nueva.clear();
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         if ( ( k < 1 || cara(k) != cara(0) ) && ( k < 2 || cara(k) != cara(1) ) )
+            nueva.push_back( cara(k) );
+      for( unsigned j = 0 ; j < cache.size() ; j++ )
+         if ( cache[j] != unsigned(cara(0)) && cache[j] != unsigned(cara(1)) && cache[j] != unsigned(cara(2)) )
+            nueva.push_back( cache[j] );
+
+      // nuevas puntuaciones de los vértices que están (o salen de) la caché
+      for( unsigned j = 0 ; j < nueva.size() ; j++ )
+      {  const unsigned v = nueva[j] ;
+         pos_cache[v] = j < tam_cache_forsyth ? int(j) : -1 ;
+         punt_ver[v]  = PuntuacionVertice( pos_cache[v], restantes[v] );
+      }
+      // y de sus caras pendientes; la siguiente es la de más puntuación
+      mejor      = -1 ;
+      punt_mejor = -1.0f ;
+      for( unsigned j = 0 ; j < nueva.size() ; j++ )
+      {  const unsigned v = nueva[j] ;
+         for( unsigned l = primera[v] ; l < primera[v]+restantes[v] ; l++ )
+         {  const unsigned c = lista[l] ;
+            punt_cara[c] = punt_ver[caras[c](0)] + punt_ver[caras[c](1)] + punt_ver[caras[c](2)] ;
+            if ( punt_cara[c] > punt_mejor )
+            {  punt_mejor = punt_cara[c] ;
+               mejor      = c ;
+            }
+         }
+      }
+      if ( nueva.size() > tam_cache_forsyth )
+         nueva.resize( tam_cache_forsyth );
+      cache.swap( nueva );
+   }
+
+   caras.swap( resultado );
+}
+
+// -----------------------------------------------------------------------------
+
+void OptMalla_ReordenarVertices( TablasMalla & tablas )
+{
+   std::vector<Tupla3i> & caras = *tablas.caras ;
+   const unsigned         nv    = tablas.vertices->size() ;
+   const unsigned         nada  = ~0U ;
+   std::vector<unsigned>  nuevo( nv, nada );
+   unsigned               siguiente = 0 ;
+
+   for( unsigned i = 0 ; i < caras.size() ; i++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  const unsigned v = caras[i](k) ;
+         if ( nuevo[v] == nada )
+            nuevo[v] = siguiente++ ;
+         caras[i](k) = nuevo[v] ;
+      }
+   for( unsigned v = 0 ; v < nv ; v++ )
+      if ( nuevo[v] == nada )
+         nuevo[v] = siguiente++ ;
+
+   PermutarTabla( tablas.vertices, nuevo );
+   PermutarTabla( tablas.normales_vertices, nuevo );
+   PermutarTabla( tablas.col_ver, nuevo );
+   PermutarTabla( tablas.cctt, nuevo );
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned long OptMalla_SoldarVertices( TablasMalla & tablas, const float tolerancia,
+                                       const std::string & nombre )
+{
+   const auto             t_inicio = std::chrono::steady_clock::now();
+   std::vector<Tupla3f> & ver      = *tablas.vertices ;
+   std::vector<Tupla3i> & caras    = *tablas.caras ;
+   const unsigned         nv       = ver.size() ;
+   if ( nv == 0 )
+      return 0 ;
+   const unsigned long bytes_antes = BytesTablas( tablas );
+
+   // tolerancia absoluta, a partir de la diagonal de la caja englobante. Las
+   // celdas miden varias veces la tolerancia (con un mínimo para que los
+   // índices de celda quepan en un 'int'): dos vértices soldables están en
+   // la misma celda o en celdas vecinas, y solo hay que mirar las vecinas
+   // por los lados a los que el vértice esté a menos de la tolerancia
+   Tupla3f cmin = ver[0], cmax = ver[0] ;
+   for( unsigned v = 1 ; v < nv ; v++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  cmin(k) = std::min( cmin(k), ver[v](k) );
+         cmax(k) = std::max( cmax(k), ver[v](k) );
+      }
+   const float diag      = std::sqrt( (cmax-cmin).lengthSq() ),
+               eps       = std::max( 0.0f, tolerancia )*diag,
+               tam_celda = diag > 0.0f ? std::max( 4.0f*eps, 1e-7f*diag ) : 1.0f ;
+
+   // tabla hash de celdas en formato CSR: los vértices de la cubeta h son
+   // lista[primera[h]] ... lista[primera[h+1]-1], en orden creciente
+   unsigned num_cubetas = 1 ;
+   while( num_cubetas < nv )
+      num_cubetas *= 2 ;
+   const uint64_t mascara = num_cubetas-1 ;
+
+   std::vector<CeldaRejilla> celda( nv );
+   std::vector<unsigned>     cubeta( nv ), primera( num_cubetas+1, 0 ), lista( nv );
+   EnParalelo( nv, [&]( unsigned long ini, unsigned long fin )
+   {  for( unsigned long v = ini ; v < fin ; v++ )
+      {  CeldaRejilla & c = celda[v] ;
+         c.i = int( std::floor( (ver[v](0)-cmin(0))/tam_celda ) );
+         c.j = int( std::floor( (ver[v](1)-cmin(1))/tam_celda ) );
+         c.k = int( std::floor( (ver[v](2)-cmin(2))/tam_celda ) );
+         cubeta[v] = HashCelda( c.i, c.j, c.k, mascara );
+      }
+   });
+   for( unsigned v = 0 ; v < nv ; v++ )
+      primera[cubeta[v]+1]++ ;
+   for( unsigned h = 0 ; h < num_cubetas ; h++ )
+      primera[h+1] += primera[h] ;
+   std::vector<unsigned> siguiente( primera.begin(), primera.end()-1 );
+   for( unsigned v = 0 ; v < nv ; v++ )
+      lista[siguiente[cubeta[v]]++] = v ;
+
+   // representante de cada vértice: el de menor índice que se puede soldar
+   // con él, buscado en su celda y las vecinas necesarias (cada hebra
+   // escribe solo en sus vértices)
+   std::vector<unsigned> repr( nv );
+   const float eps2 = eps*eps ;
+   EnParalelo( nv, [&]( unsigned long ini, unsigned long fin )
+   {  for( unsigned long v = ini ; v < fin ; v++ )
+      {  const int c[3] = { celda[v].i, celda[v].j, celda[v].k } ;
+         int desde[3], hasta[3] ;
+         for( unsigned k = 0 ; k < 3 ; k++ )
+         {  const float f = ver[v](k)-cmin(k) - c[k]*tam_celda ; // posición en la celda
+            desde[k] = f <= eps ? -1 : 0 ;
+            hasta[k] = f >= tam_celda-eps ? 1 : 0 ;
+         }
+         unsigned r = v ;
+         for( int di = desde[0] ; di <= hasta[0] ; di++ )
+         for( int dj = desde[1] ; dj <= hasta[1] ; dj++ )
+         for( int dk = desde[2] ; dk <= hasta[2] ; dk++ )
+         {  const unsigned h = HashCelda( c[0]+di, c[1]+dj, c[2]+dk, mascara );
+            for( unsigned l = primera[h] ; l < primera[h+1] && lista[l] < r ; l++ )
+            {  const unsigned u = lista[l] ;
+               if ( (ver[u]-ver[v]).lengthSq() <= eps2 &&
+                    AtributosIguales( tablas.normales_vertices, nv, u, v, tolerancia ) &&
+                    AtributosIguales( tablas.col_ver, nv, u, v, tolerancia ) &&
+                    AtributosIguales( tablas.cctt, nv, u, v, tolerancia ) )
+               {  r = u ;
+                  break ;
+               }
+            }
+         }
+         repr[v] = r ;
+      }
+   });
+
+   // cadenas de vértices cercanos: cada uno va al representante de su
+   // representante (que es menor y ya es definitivo), luego se renumeran
+   std::vector<unsigned> nuevo( nv );
+   unsigned nv_nuevo = 0 ;
+   for( unsigned v = 0 ; v < nv ; v++ )
+   {  repr[v]  = repr[repr[v]] ;
+      nuevo[v] = repr[v] == v ? nv_nuevo++ : nuevo[repr[v]] ;
+   }
+
+   // caras con los nuevos índices, sin las degeneradas
+   EnParalelo( caras.size(), [&]( unsigned long ini, unsigned long fin )
+   {  for( unsigned long i = ini ; i < fin ; i++ )
+         for( unsigned k = 0 ; k < 3 ; k++ )
+            caras[i](k) = nuevo[caras[i](k)] ;
+   });
+   const unsigned nc = caras.size() ;
+   caras.erase( std::remove_if( caras.begin(), caras.end(), []( const Tupla3i & c )
+                { return c(0) == c(1) || c(1) == c(2) || c(2) == c(0) ; } ), caras.end() );
+
+   CompactarTabla( tablas.vertices, repr, nuevo, nv_nuevo );
+   CompactarTabla( tablas.normales_vertices, repr, nuevo, nv_nuevo );
+   CompactarTabla( tablas.col_ver, repr, nuevo, nv_nuevo );
+   CompactarTabla( tablas.cctt, repr, nuevo, nv_nuevo );
+   tablas.normales_caras->clear(); // ya no corresponden a las caras
+
+   const unsigned long ahorro = bytes_antes - BytesTablas( tablas );
+   cout << nombre << ": soldados " << nv-nv_nuevo << " vértices (" << nv << " -> "
+        << nv_nuevo << "), " << nc-caras.size() << " caras degeneradas quitadas, "
+        << ahorro << " bytes menos ("
+        << std::chrono::duration<double>( std::chrono::steady_clock::now()-t_inicio ).count()
+        << " seg.)" << endl ;
+   return ahorro ;
+}
+
+// -----------------------------------------------------------------------------
+
+void OptMalla_Optimizar( TablasMalla & tablas, const std::string & nombre )
+{
+   const auto     t_inicio = std::chrono::steady_clock::now();
+   const unsigned nv       = tablas.vertices->size() ;
+   const float    antes    = OptMalla_ACMR( *tablas.caras, nv );
+
+   OptMalla_ReordenarCaras( *tablas.caras, nv );
+   OptMalla_ReordenarVertices( tablas );
+   tablas.normales_caras->clear(); // ya no corresponden a las caras
+
+   cout << nombre << ": optimizada para la caché de vértices, ACMR "
+        << antes << " -> " << OptMalla_ACMR( *tablas.caras, nv ) << " ("
+        << tablas.caras->size() << " caras, FIFO de " << tam_cache_acmr << ", "
+        << std::chrono::duration<double>( std::chrono::steady_clock::now()-t_inicio ).count()
+        << " seg.)" << endl ;
+}
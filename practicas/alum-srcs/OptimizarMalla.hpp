@@ -0,0 +1,65 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Soldadura de vértices y reordenación para la caché de vértices (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_OPTIMIZARMALLA_HPP
+#define IG_OPTIMIZARMALLA_HPP
+
+#include <vector>
+#include <tuplasg.hpp>
+#include "CacheMallas.hpp"   // TablasMalla
+
+// ---------------------------------------------------------------------
+// La GPU guarda en una caché pequeña los últimos vértices transformados,
+// así que un vértice que aparece en varias caras seguidas se procesa una
+// sola vez. El ACMR (average cache miss ratio) es el número medio de
+// vértices procesados por triángulo: entre 0.5 (ideal) y 3 (sin reuso).
+//
+// La optimización tiene dos pasos:
+//   1. se reordenan las caras con el algoritmo de T. Forsyth ("Linear-Speed
+//      Vertex Cache Optimisation", 2006), que elige en cada paso la cara
+//      cuyos vértices puntúan más según su posición en una caché LRU
+//      simulada y el número de caras que les quedan.
+//   2. se renumeran los vértices en el orden en que los usan las caras,
+//      para que la lectura de sus atributos sea lo más secuencial posible.
+//
+// Antes se pueden soldar los vértices repetidos (misma posición, salvo una
+// tolerancia, y mismos atributos): se buscan con una rejilla de celdas del
+// tamaño de la tolerancia guardada en una tabla hash, así que el coste es
+// casi lineal, y la búsqueda de cada vértice se hace en paralelo.
+
+// tamaño de la caché FIFO con la que se calcula el ACMR
+const unsigned tam_cache_acmr = 32 ;
+
+// tolerancia de soldadura por defecto (relativa a la diagonal de la caja)
+const float tolerancia_soldadura = 1e-5f ;
+
+// ACMR de una tabla de caras, simulando una caché FIFO de 'tam_cache' vértices
+float OptMalla_ACMR( const std::vector<Tupla3i> & caras, const unsigned num_vertices,
+                     const unsigned tam_cache = tam_cache_acmr );
+
+// reordena las caras para la caché de vértices (algoritmo de Forsyth)
+void OptMalla_ReordenarCaras( std::vector<Tupla3i> & caras, const unsigned num_vertices );
+
+// renumera los vértices por orden de primer uso en 'caras' (los que no usa
+// ninguna cara quedan al final). Se permutan todas las tablas por vértice
+// que tengan un elemento por vértice; se vacía la de normales de caras, que
+// se vuelve a calcular si hace falta
+void OptMalla_ReordenarVertices( TablasMalla & tablas );
+
+// suelda los vértices que están a menos de 'tolerancia' (relativa a la
+// diagonal de la caja englobante) y tienen los mismos atributos en las
+// tablas por vértice, se queda con el de menor índice. Reescribe las caras,
+// quita las degeneradas (con dos índices iguales) y vacía la de normales de
+// caras. Escribe en 'cout' los vértices y bytes ahorrados, que devuelve
+unsigned long OptMalla_SoldarVertices( TablasMalla & tablas, const float tolerancia,
+                                       const std::string & nombre );
+
+// reordenación de caras y vértices, escribe en 'cout' el ACMR antes y después
+void OptMalla_Optimizar( TablasMalla & tablas, const std::string & nombre );
+
+#endif
@@ -0,0 +1,45 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Reparto de un recorrido entre hebras (implementación)
+// **
+// *********************************************************************
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include "Paralelo.hpp"
+
+// número mínimo de elementos por hebra (con menos no compensa crear hebras)
+static const unsigned long min_elem_hebra = 16384 ;
+
+// número de hebras fijado con FijarHebrasParalelo (0: las del hardware)
+static std::atomic<unsigned> hebras_fijadas( 0 );
+
+// -----------------------------------------------------------------------------
+
+void FijarHebrasParalelo( const unsigned n )
+{
+   hebras_fijadas = n ;
+}
+// -----------------------------------------------------------------------------
+
+unsigned EnParalelo( const unsigned long n,
+                     const std::function<void(unsigned long,unsigned long)> & tarea )
+{
+   const unsigned
+      num_hebras = hebras_fijadas > 0 ? unsigned( hebras_fijadas )
+                                      : std::max( 1U, std::thread::hardware_concurrency() ),
+      num_trozos = unsigned( std::min( (unsigned long) num_hebras,
+                                       std::max( 1UL, n/min_elem_hebra ) ) );
+   std::vector<std::thread> hebras ;
+
+   for( unsigned i = 1 ; i < num_trozos ; i++ )
+      hebras.push_back( std::thread( tarea, (n*i)/num_trozos, (n*(i+1))/num_trozos ) );
+   tarea( 0, n/num_trozos );
+   for( unsigned i = 0 ; i < hebras.size() ; i++ )
+      hebras[i].join();
+   return num_trozos ;
+}
@@ -0,0 +1,23 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Reparto de un recorrido entre hebras (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_PARALELO_HPP
+#define IG_PARALELO_HPP
+
+#include <functional>
+
+// ejecuta 'tarea(ini,fin)' sobre trozos consecutivos de [0,n), uno por hebra
+// (el primero en la hebra actual). Devuelve el número de trozos
+unsigned EnParalelo( const unsigned long n,
+                     const std::function<void(unsigned long,unsigned long)> & tarea );
+
+// fija el número de hebras de EnParalelo (0: una por núcleo del hardware,
+// el valor inicial). Sirve para medir cómo escalan los cálculos
+void FijarHebrasParalelo( const unsigned n );
+
+#endif
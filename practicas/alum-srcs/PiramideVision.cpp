@@ -0,0 +1,81 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Pirámide de visión y recortado de cajas englobantes (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include "PiramideVision.hpp"
+
+// -----------------------------------------------------------------------------
+
+PiramideVision::PiramideVision()
+{
+   for( unsigned i = 0 ; i < 6 ; i++ )
+      plano[i] = Tupla4f( 0.0, 0.0, 0.0, 1.0 );
+   valida = false ;
+}
+// -----------------------------------------------------------------------------
+// un punto en coordenadas de mundo p=(x,y,z,1) se transforma en q = M*p (con
+// M = proy*vista) y es visible si -q.w <= q.x,q.y,q.z <= q.w; cada una de
+// esas seis desigualdades es un plano: (fila 3 ± fila i de M)·p >= 0
+
+PiramideVision::PiramideVision( const Matriz4f & proy, const Matriz4f & vista )
+{
+   const Matriz4f m = proy*vista ;
+
+   for( unsigned i = 0 ; i < 3 ; i++ )
+   for( unsigned s = 0 ; s < 2 ; s++ )
+   {
+      const float signo = ( s == 0 ) ? 1.0f : -1.0f ;
+      Tupla4f &   p     = plano[2*i+s] ;
+
+      for( unsigned j = 0 ; j < 4 ; j++ )
+         p(j) = m(3,j) + signo*m(i,j) ;
+
+      const float lon = std::sqrt( p(0)*p(0) + p(1)*p(1) + p(2)*p(2) );
+      if ( lon > 0.0f )
+         for( unsigned j = 0 ; j < 4 ; j++ )
+            p(j) /= lon ;
+   }
+   valida = true ;
+}
+// -----------------------------------------------------------------------------
+
+PiramideVision::PiramideVision( const ViewFrustum & vf, const MarcoCoorVista & mcv )
+:  PiramideVision( vf.matrizProy, mcv.matrizVista )
+{
+}
+// -----------------------------------------------------------------------------
+// para cada plano se compara la distancia con signo del centro de la caja con
+// el radio de la caja en la dirección de la normal (la suma del semilado por
+// el valor absoluto de la normal): si el centro está más lejos por fuera que
+// ese radio la caja está fuera, y si lo está por dentro el plano no la corta
+
+PosicionCaja PiramideVision::clasificar( const CajaEngf & caja, unsigned & planos ) const
+{
+   if ( ! valida || caja.vacia )
+      return PosicionCaja::dentro ;
+
+   const Tupla3f c = caja.centro(),
+                 s = (caja.maximo-caja.minimo)*0.5f ;
+
+   for( unsigned i = 0 ; i < 6 ; i++ )
+   {
+      const unsigned bit = 1u << i ;
+      if ( ( planos & bit ) == 0 )
+         continue ;
+
+      const Tupla4f & p = plano[i] ;
+      const float dist  = p(0)*c(0) + p(1)*c(1) + p(2)*c(2) + p(3),
+                  radio = std::fabs(p(0))*s(0) + std::fabs(p(1))*s(1) + std::fabs(p(2))*s(2) ;
+
+      if ( dist + radio < 0.0f )
+         return PosicionCaja::fuera ;
+      if ( dist - radio >= 0.0f )
+         planos &= ~bit ;
+   }
+   return planos == 0 ? PosicionCaja::dentro : PosicionCaja::parcial ;
+}
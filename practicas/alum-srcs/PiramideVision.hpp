@@ -0,0 +1,52 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Pirámide de visión y recortado de cajas englobantes (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_PIRAMIDEVISION_HPP
+#define IG_PIRAMIDEVISION_HPP
+
+#include <tuplasg.hpp>
+#include <matrizg.hpp>
+#include "CajaEngf.hpp"
+#include "Camara.hpp"
+
+// resultado de comparar una caja con la pirámide de visión
+enum class PosicionCaja { fuera, dentro, parcial } ;
+
+// máscara con los seis planos de la pirámide (un bit por plano)
+const unsigned todos_los_planos = 0x3F ;
+
+// ---------------------------------------------------------------------
+// pirámide de visión (view-frustum) en coordenadas del mundo, como los seis
+// planos (izquierdo, derecho, inferior, superior, delantero y trasero) que
+// la limitan. Cada plano (a,b,c,d) tiene la normal (a,b,c) unitaria y
+// apuntando hacia dentro, de forma que un punto p está dentro de la
+// pirámide si a*p.x + b*p.y + c*p.z + d >= 0 para los seis
+
+class PiramideVision
+{
+   public:
+      Tupla4f plano[6] ;
+      bool    valida ;   // false: no hay pirámide, todo se considera visible
+
+      // pirámide no válida (no se recorta nada)
+      PiramideVision() ;
+      // pirámide de las matrices de proyección y de vista (se extraen los
+      // planos de las filas de 'proy*vista', método de Gribb y Hartmann)
+      PiramideVision( const Matriz4f & proy, const Matriz4f & vista );
+      // pirámide de una cámara: 'vf.matrizProy' y 'mcv.matrizVista'
+      PiramideVision( const ViewFrustum & vf, const MarcoCoorVista & mcv );
+
+      // posición de la caja 'caja' (en coordenadas de mundo) respecto de la
+      // pirámide, comprobando solo los planos cuyo bit está en 'planos'. Al
+      // volver, 'planos' tiene solo los planos que cortan a la caja (los
+      // que hay que comprobar para las cajas contenidas en ella). Las cajas
+      // vacías se consideran siempre dentro (no se sabe dónde están)
+      PosicionCaja clasificar( const CajaEngf & caja, unsigned & planos ) const ;
+} ;
+
+#endif
@@ -0,0 +1,147 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Rayos e intersecciones con cajas y triángulos (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <algorithm>
+#include <matrices-tr.hpp>
+#include "Rayo.hpp"
+
+// *****************************************************************************
+// Rayo
+
+Rayo::Rayo()
+{
+   origen    = Tupla3f( 0.0, 0.0, 0.0 );
+   direccion = Tupla3f( 0.0, 0.0, -1.0 );
+   inv_direccion = Tupla3f( INFINITY, INFINITY, -1.0 );
+}
+// -----------------------------------------------------------------------------
+
+Rayo::Rayo( const Tupla3f & p_origen, const Tupla3f & p_direccion )
+{
+   origen    = p_origen ;
+   direccion = p_direccion ;
+   // 1/0 es infinito (con signo), así que las franjas paralelas al rayo
+   // cortan siempre o nunca
+   for( unsigned i = 0 ; i < 3 ; i++ )
+      inv_direccion(i) = 1.0f/direccion(i) ;
+}
+// -----------------------------------------------------------------------------
+
+Tupla3f Rayo::punto( const float t ) const
+{
+   return origen + direccion*t ;
+}
+// -----------------------------------------------------------------------------
+
+Rayo Rayo::transformado( const Matriz4f & m ) const
+{
+   Tupla3f org, dir ;
+   for( unsigned i = 0 ; i < 3 ; i++ )
+   {  org(i) = m(i,3) ;
+      dir(i) = 0.0f ;
+      for( unsigned j = 0 ; j < 3 ; j++ )
+      {  org(i) += m(i,j)*origen(j) ;
+         dir(i) += m(i,j)*direccion(j) ;
+      }
+   }
+   return Rayo( org, dir );
+}
+
+// *****************************************************************************
+// intersecciones
+
+bool Rayo_CortaCaja( const Rayo & rayo, const float minimo[3], const float maximo[3],
+                     const float t_max, float & t_entrada )
+{
+   float t0 = 0.0f, t1 = t_max ;
+   for( unsigned i = 0 ; i < 3 ; i++ )
+   {
+      float ta = ( minimo[i] - rayo.origen(i) )*rayo.inv_direccion(i),
+            tb = ( maximo[i] - rayo.origen(i) )*rayo.inv_direccion(i);
+      if ( ta > tb )
+         std::swap( ta, tb );
+      // (si 'ta' o 'tb' es NaN, el rayo está en el plano de una cara: no
+      // se descarta la caja)
+      t0 = ta > t0 ? ta : t0 ;
+      t1 = tb < t1 ? tb : t1 ;
+      if ( t0 > t1 )
+         return false ;
+   }
+   t_entrada = t0 ;
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+bool Rayo_CortaCaja( const Rayo & rayo, const CajaEngf & caja,
+                     const float t_max, float & t_entrada )
+{
+   if ( caja.vacia )
+      return false ;
+   const float minimo[3] = { caja.minimo(0), caja.minimo(1), caja.minimo(2) },
+               maximo[3] = { caja.maximo(0), caja.maximo(1), caja.maximo(2) };
+   return Rayo_CortaCaja( rayo, minimo, maximo, t_max, t_entrada );
+}
+// -----------------------------------------------------------------------------
+
+bool Rayo_CortaTriangulo( const Rayo & rayo, const Tupla3f & a, const Tupla3f & b,
+                          const Tupla3f & c, const float t_max, float & t )
+{
+   const Tupla3f ab = b-a, ac = c-a,
+                 p  = rayo.direccion.cross( ac );
+   const float   det = ab.dot( p );
+   if ( det == 0.0f ) // rayo paralelo al triángulo (o triángulo degenerado)
+      return false ;
+
+   const float   inv_det = 1.0f/det ;
+   const Tupla3f s = rayo.origen-a ;
+   const float   u = s.dot( p )*inv_det ;
+   if ( u < 0.0f || u > 1.0f )
+      return false ;
+
+   const Tupla3f q = s.cross( ab );
+   const float   v = rayo.direccion.dot( q )*inv_det ;
+   if ( v < 0.0f || u+v > 1.0f )
+      return false ;
+
+   const float tc = ac.dot( q )*inv_det ;
+   if ( tc < 0.0f || tc >= t_max )
+      return false ;
+   t = tc ;
+   return true ;
+}
+
+// *****************************************************************************
+
+Matriz4f MAT_InversaAfin( const Matriz4f & m )
+{
+   // inversa de la parte lineal con los cofactores
+   const float c00 = m(1,1)*m(2,2) - m(1,2)*m(2,1),
+               c01 = m(1,2)*m(2,0) - m(1,0)*m(2,2),
+               c02 = m(1,0)*m(2,1) - m(1,1)*m(2,0),
+               det = m(0,0)*c00 + m(0,1)*c01 + m(0,2)*c02 ;
+   if ( det == 0.0f )
+      return MAT_Ident();
+
+   const float inv = 1.0f/det ;
+   Matriz4f r = MAT_Ident();
+   r(0,0) = c00*inv ;
+   r(1,0) = c01*inv ;
+   r(2,0) = c02*inv ;
+   r(0,1) = ( m(0,2)*m(2,1) - m(0,1)*m(2,2) )*inv ;
+   r(1,1) = ( m(0,0)*m(2,2) - m(0,2)*m(2,0) )*inv ;
+   r(2,1) = ( m(0,1)*m(2,0) - m(0,0)*m(2,1) )*inv ;
+   r(0,2) = ( m(0,1)*m(1,2) - m(0,2)*m(1,1) )*inv ;
+   r(1,2) = ( m(0,2)*m(1,0) - m(0,0)*m(1,2) )*inv ;
+   r(2,2) = ( m(0,0)*m(1,1) - m(0,1)*m(1,0) )*inv ;
+
+   // la traslación: -inversa*t
+   for( unsigned i = 0 ; i < 3 ; i++ )
+      r(i,3) = -( r(i,0)*m(0,3) + r(i,1)*m(1,3) + r(i,2)*m(2,3) );
+   return r ;
+}
@@ -0,0 +1,59 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Rayos e intersecciones con cajas y triángulos (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_RAYO_HPP
+#define IG_RAYO_HPP
+
+#include <tuplasg.hpp>
+#include <matrizg.hpp>
+#include "CajaEngf.hpp"
+
+// ---------------------------------------------------------------------
+// semirrecta de puntos origen + t*direccion, con t >= 0. La dirección no
+// tiene por qué ser unitaria: al transformar un rayo con una matriz afín
+// el parámetro t de cada punto no cambia, así que se pueden comparar las
+// distancias de cortes calculados en coordenadas de objeto distintas
+
+class Rayo
+{
+   public:
+      Tupla3f origen ,
+              direccion ,
+              inv_direccion ; // 1/direccion en cada coordenada (para las cajas)
+
+      Rayo() ;
+      Rayo( const Tupla3f & p_origen, const Tupla3f & p_direccion );
+
+      // punto del rayo con parámetro 't'
+      Tupla3f punto( const float t ) const ;
+
+      // rayo transformado por la matriz afín 'm' (mismo parámetro t)
+      Rayo transformado( const Matriz4f & m ) const ;
+} ;
+
+// ---------------------------------------------------------------------
+// intersecciones: devuelven true si el rayo corta antes de 't_max'
+
+// caja dada por sus esquinas (método de las franjas). En 't_entrada' se
+// devuelve el parámetro donde el rayo entra en la caja (0 si empieza dentro)
+bool Rayo_CortaCaja( const Rayo & rayo, const float minimo[3], const float maximo[3],
+                     const float t_max, float & t_entrada );
+bool Rayo_CortaCaja( const Rayo & rayo, const CajaEngf & caja,
+                     const float t_max, float & t_entrada );
+
+// triángulo (a,b,c) por las dos caras (método de Möller y Trumbore). En
+// 't' se devuelve el parámetro del punto de corte
+bool Rayo_CortaTriangulo( const Rayo & rayo, const Tupla3f & a, const Tupla3f & b,
+                          const Tupla3f & c, const float t_max, float & t );
+
+// ---------------------------------------------------------------------
+// inversa de una matriz afín (la última fila es 0,0,0,1). Si la parte
+// lineal no tiene inversa se devuelve la identidad
+Matriz4f MAT_InversaAfin( const Matriz4f & m );
+
+#endif
@@ -0,0 +1,98 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Selección de objetos con rayos en la CPU (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <cassert>
+#include "grafo-escena.hpp"
+#include "SeleccionRayo.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+
+SeleccionRayo::SeleccionRayo( NodoGrafoEscena * p_raiz )
+{
+   assert( p_raiz != nullptr );
+   raiz = p_raiz ;
+}
+// -----------------------------------------------------------------------------
+// como en NodoGrafoEscena::compilarCola, la caja de la raíz se calcula antes:
+// así cualquier cambio posterior aumenta sus invalidaciones
+
+void SeleccionRayo::actualizar()
+{
+   raiz->cajaEnglobante();
+   const unsigned long inv = raiz->leerNumInvalidaciones(),
+                       est = raiz->leerNumCambiosEstructura();
+   if ( construida && inv == invalidaciones && est == estructura )
+      return ;
+
+   if ( ! construida || est != estructura )
+   {
+      EstadoAplanado estado ;
+      estado.instancia          = -1 ;
+      estado.entrada            = 0 ;
+      estado.material           = nullptr ;
+      estado.instancia_material = -1 ;
+      estado.entrada_material   = 0 ;
+      estado.identificador      = 0 ;
+
+      cola.vaciar();
+      raiz->aplanar( cola, estado );
+   }
+   else
+      cola.actualizar();
+
+   // las matrices inversas y el BVH, con las cajas de mundo de las hojas
+   vector<CajaEngf> cajas( cola.elementos.size() );
+   inversas.resize( cola.elementos.size() );
+   for( unsigned i = 0 ; i < cola.elementos.size() ; i++ )
+   {  cajas[i]    = cola.elementos[i].caja ;
+      inversas[i] = MAT_InversaAfin( cola.elementos[i].matriz );
+   }
+   bvh.construir( cajas );
+
+   construida     = true ;
+   invalidaciones = inv ;
+   estructura     = est ;
+}
+// -----------------------------------------------------------------------------
+
+int SeleccionRayo::identificadorEnRayo( const Rayo & rayo, float * t )
+{
+   actualizar();
+
+   // el parámetro t es el mismo en coordenadas de mundo y de cada hoja
+   // (ver Rayo::transformado), así que se pueden comparar los cortes
+   float t_max = INFINITY ;
+   int   hoja  = -1 ;
+   bvh.intersectar( rayo, t_max, [&]( const unsigned i, float & t_max_act )
+   {
+      float t_hoja = t_max_act ;
+      if ( ! cola.elementos[i].objeto->intersectarRayo( rayo.transformado( inversas[i] ), t_hoja ) )
+         return false ;
+      t_max_act = t_hoja ;
+      hoja      = i ;
+      return true ;
+   } );
+
+   if ( hoja < 0 )
+      return 0 ;
+   if ( t != nullptr )
+      *t = t_max ;
+   return cola.elementos[hoja].identificador > 0 ? cola.elementos[hoja].identificador : 0 ;
+}
+// -----------------------------------------------------------------------------
+
+bool SeleccionRayo::seleccionar( const Rayo & rayo, Objeto3D ** objeto, Tupla3f & centro_wc )
+{
+   const int ident = identificadorEnRayo( rayo );
+   if ( ident <= 0 )
+      return false ;
+   return raiz->buscarObjeto( ident, MAT_Ident(), objeto, centro_wc );
+}
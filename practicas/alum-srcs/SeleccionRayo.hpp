@@ -0,0 +1,61 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Selección de objetos con rayos en la CPU (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_SELECCIONRAYO_HPP
+#define IG_SELECCIONRAYO_HPP
+
+#include <vector>
+#include "Rayo.hpp"
+#include "BVH.hpp"
+#include "ColaVisualizacion.hpp"
+
+class NodoGrafoEscena ;
+
+// ---------------------------------------------------------------------
+// Selección de objetos de un grafo de escena sin visualizarlo: se corta el
+// rayo del pixel con las hojas del grafo (un BVH sobre sus cajas en
+// coordenadas de mundo) y, dentro de cada hoja, con sus triángulos (el BVH
+// de cada malla, ver MallaInd::intersectarRayo).
+//
+// Las hojas y sus matrices se obtienen aplanando el grafo en una cola de
+// visualización propia (ver ColaVisualizacion.hpp), que, igual que la de
+// los nodos, solo se vuelve a construir si cambian las entradas de algún
+// nodo; si solo cambian matrices o mallas se actualiza.
+//
+// El identificador de una hoja es el mismo con el que se visualiza en modo
+// selección (el de la cola, ver Objeto3D::aplanar): si no es mayor que 0 la
+// hoja tapa lo que hay detrás, pero no se puede seleccionar.
+
+class SeleccionRayo
+{
+   public:
+      SeleccionRayo( NodoGrafoEscena * p_raiz );
+
+      // identificador de la hoja más cercana que corta 'rayo' (en
+      // coordenadas de mundo), 0 si no corta ninguna o no tiene. En 't' se
+      // devuelve el parámetro del corte, si no es nulo
+      int identificadorEnRayo( const Rayo & rayo, float * t = nullptr );
+
+      // como NodoGrafoEscena::buscarObjeto con el identificador de la hoja
+      // que corta el rayo (y la raíz como nodo de partida)
+      bool seleccionar( const Rayo & rayo, Objeto3D ** objeto, Tupla3f & centro_wc );
+
+   private:
+      NodoGrafoEscena *     raiz ;
+      ColaVisualizacion     cola ;
+      std::vector<Matriz4f> inversas ;   // coords. de mundo --> coords. de cada hoja
+      BVH                   bvh ;        // sobre las cajas de las hojas
+      bool                  construida = false ;
+      unsigned long         invalidaciones = 0, // las de la raíz la última vez
+                            estructura     = 0 ;
+
+      // reconstruir o actualizar la cola y el BVH si ha cambiado el grafo
+      void actualizar();
+} ;
+
+#endif
@@ -0,0 +1,310 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Simplificación de mallas con cuádricas de error (implementación)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <queue>
+#include <algorithm>
+#include <iostream>
+#include "SimplificarMalla.hpp"
+
+using namespace std ;
+
+// *****************************************************************************
+// parámetros de la simplificación
+
+static const double peso_borde      = 1000.0 ; // peso de los planos que conservan los bordes
+static const double min_coseno_cara = 0.2 ;    // un colapso no puede girar una cara más de ~78º
+
+// -----------------------------------------------------------------------------
+// cuádrica de error: matriz simétrica 4x4 (se guarda la mitad superior)
+// a00 a01 a02 a03 a11 a12 a13 a22 a23 a33
+
+struct Cuadrica
+{
+   double a[10] ;
+
+   Cuadrica()
+   {  std::fill( a, a+10, 0.0 );
+   }
+   // suma el plano n·x + d = 0, con peso 'w'
+   void sumarPlano( const double n[3], const double d, const double w )
+   {  a[0] += w*n[0]*n[0] ; a[1] += w*n[0]*n[1] ; a[2] += w*n[0]*n[2] ; a[3] += w*n[0]*d ;
+      a[4] += w*n[1]*n[1] ; a[5] += w*n[1]*n[2] ; a[6] += w*n[1]*d ;
+      a[7] += w*n[2]*n[2] ; a[8] += w*n[2]*d ;
+      a[9] += w*d*d ;
+   }
+   void operator += ( const Cuadrica & q )
+   {  for( unsigned i = 0 ; i < 10 ; i++ )
+         a[i] += q.a[i] ;
+   }
+   // error en el punto 'p' (suma de distancias al cuadrado a los planos)
+   double evaluar( const double p[3] ) const
+   {  const double x = p[0], y = p[1], z = p[2] ;
+      return a[0]*x*x + 2.0*a[1]*x*y + 2.0*a[2]*x*z + 2.0*a[3]*x
+           + a[4]*y*y + 2.0*a[5]*y*z + 2.0*a[6]*y
+           + a[7]*z*z + 2.0*a[8]*z
+           + a[9] ;
+   }
+   // punto de error mínimo, si el sistema no es (casi) singular
+   bool optimo( double p[3] ) const
+   {  const double
+         m00 = a[0], m01 = a[1], m02 = a[2],
+         m11 = a[4], m12 = a[5], m22 = a[7],
+         c00 = m11*m22-m12*m12, c01 = m02*m12-m01*m22, c02 = m01*m12-m02*m11,
+         det = m00*c00 + m01*c01 + m02*c02,
+         traza = m00+m11+m22 ;
+      if ( std::fabs( det ) <= 1e-9*traza*traza*traza )
+         return false ;
+      const double
+         c11 = m00*m22-m02*m02, c12 = m01*m02-m00*m12, c22 = m00*m11-m01*m01,
+         b0 = -a[3], b1 = -a[6], b2 = -a[8] ;
+      p[0] = ( c00*b0 + c01*b1 + c02*b2 )/det ;
+      p[1] = ( c01*b0 + c11*b1 + c12*b2 )/det ;
+      p[2] = ( c02*b0 + c12*b1 + c22*b2 )/det ;
+      return true ;
+   }
+} ;
+
+// -----------------------------------------------------------------------------
+// colapso de la arista (a,b) en el punto 'p', que conserva el vértice 'a'.
+// Queda obsoleto si cambia la versión de alguno de sus extremos
+
+struct Colapso
+{
+   double   coste ;
+   unsigned a, b, ver_a, ver_b ;
+   double   p[3] ;
+
+   // la cola de prioridad da primero el de menor coste
+   bool operator < ( const Colapso & otro ) const
+   {  return coste > otro.coste ;
+   }
+} ;
+
+// -----------------------------------------------------------------------------
+// normal (sin normalizar) del triángulo p0,p1,p2
+
+static void NormalTriangulo( const double p0[3], const double p1[3], const double p2[3],
+                             double n[3] )
+{
+   const double u[3] = { p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2] },
+                v[3] = { p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2] } ;
+   n[0] = u[1]*v[2]-u[2]*v[1] ;
+   n[1] = u[2]*v[0]-u[0]*v[2] ;
+   n[2] = u[0]*v[1]-u[1]*v[0] ;
+}
+
+static inline double Prod( const double u[3], const double v[3] )
+{
+   return u[0]*v[0] + u[1]*v[1] + u[2]*v[2] ;
+}
+
+// *****************************************************************************
+
+void SimpMalla_Simplificar( const TablasMalla & origen, const unsigned num_caras,
+                            TablasMalla & destino, const std::string & nombre )
+{
+   const auto t_inicio = std::chrono::steady_clock::now();
+   const std::vector<Tupla3f> & ver_o   = *origen.vertices ;
+   const std::vector<Tupla3i> & caras_o = *origen.caras ;
+   const unsigned nv = ver_o.size(), nc = caras_o.size() ;
+
+   std::vector<Tupla3i>               caras( caras_o );
+   std::vector<double>                pos( 3*nv );  // posiciones (cambian al colapsar)
+   std::vector<Cuadrica>              cuad( nv );
+   std::vector<unsigned>              version( nv, 0 );
+   std::vector<bool>                  eliminado( nv, false ), viva( nc, true );
+   std::vector<std::vector<unsigned>> caras_ver( nv ); // caras (quizás ya muertas) de cada vértice
+
+   for( unsigned v = 0 ; v < nv ; v++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         pos[3*v+k] = ver_o[v](k) ;
+
+   // cuádrica de cada vértice: planos de sus caras, con peso el área
+   std::vector<double> normal_cara( 3*nc );
+   for( unsigned i = 0 ; i < nc ; i++ )
+   {  double * n = &normal_cara[3*i] ;
+      NormalTriangulo( &pos[3*caras[i](0)], &pos[3*caras[i](1)], &pos[3*caras[i](2)], n );
+      const double lon = std::sqrt( Prod( n, n ) );
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         caras_ver[caras[i](k)].push_back( i );
+      if ( lon == 0.0 )
+         continue ;
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         n[k] /= lon ;
+      const double d = -Prod( n, &pos[3*caras[i](0)] );
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         cuad[caras[i](k)].sumarPlano( n, d, 0.5*lon );
+   }
+
+   // aristas (ordenadas por sus extremos): las que solo están en una cara
+   // son de borde, y se les añade un plano perpendicular a la cara
+   std::vector<std::pair<uint64_t,unsigned>> aristas ;
+   aristas.reserve( 3*nc );
+   for( unsigned i = 0 ; i < nc ; i++ )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  const uint64_t a = caras[i](k), b = caras[i]((k+1)%3) ;
+         if ( a != b )
+            aristas.push_back( std::make_pair( std::min(a,b) << 32 | std::max(a,b), i ) );
+      }
+   std::sort( aristas.begin(), aristas.end() );
+
+   // coste y posición del colapso de la arista (a,b)
+   auto calcular_colapso = [&]( const unsigned a, const unsigned b )
+   {  Colapso col ;
+      Cuadrica q = cuad[a] ;
+      q += cuad[b] ;
+      col.a = a ; col.b = b ; col.ver_a = version[a] ; col.ver_b = version[b] ;
+      if ( q.optimo( col.p ) )
+         col.coste = q.evaluar( col.p );
+      else // el mejor de los extremos y el punto medio
+      {  const double * pa = &pos[3*a], * pb = &pos[3*b] ;
+         const double medio[3] = { 0.5*(pa[0]+pb[0]), 0.5*(pa[1]+pb[1]), 0.5*(pa[2]+pb[2]) } ;
+         const double * cand[3] = { pa, pb, medio } ;
+         col.coste = -1.0 ;
+         for( unsigned c = 0 ; c < 3 ; c++ )
+         {  const double e = q.evaluar( cand[c] );
+            if ( col.coste < 0.0 || e < col.coste )
+            {  col.coste = e ;
+               std::copy( cand[c], cand[c]+3, col.p );
+            }
+         }
+      }
+      return col ;
+   } ;
+
+   std::priority_queue<Colapso> cola ;
+   for( unsigned i = 0 ; i < aristas.size() ; )
+   {  unsigned j = i+1 ;
+      while( j < aristas.size() && aristas[j].first == aristas[i].first )
+         j++ ;
+      const unsigned a = unsigned( aristas[i].first >> 32 ), b = unsigned( aristas[i].first ) ;
+      if ( j == i+1 )
+      {  const double * pa = &pos[3*a], * pb = &pos[3*b], * nf = &normal_cara[3*aristas[i].second] ;
+         const double e[3] = { pb[0]-pa[0], pb[1]-pa[1], pb[2]-pa[2] } ;
+         double m[3] = { e[1]*nf[2]-e[2]*nf[1], e[2]*nf[0]-e[0]*nf[2], e[0]*nf[1]-e[1]*nf[0] } ;
+         const double lon = std::sqrt( Prod( m, m ) );
+         if ( lon > 0.0 )
+         {  for( unsigned k = 0 ; k < 3 ; k++ )
+               m[k] /= lon ;
+            const double d = -Prod( m, pa );
+            cuad[a].sumarPlano( m, d, peso_borde*Prod( e, e ) );
+            cuad[b].sumarPlano( m, d, peso_borde*Prod( e, e ) );
+         }
+      }
+      i = j ;
+   }
+   for( unsigned i = 0 ; i < aristas.size() ; i++ )
+      if ( i == 0 || aristas[i].first != aristas[i-1].first )
+         cola.push( calcular_colapso( unsigned( aristas[i].first >> 32 ), unsigned( aristas[i].first ) ) );
+
+   // true si al mover 'v' a 'p' alguna de sus caras (salvo las que comparte
+   // con 'otro', que desaparecen) se da la vuelta o degenera
+   auto da_la_vuelta = [&]( const unsigned v, const unsigned otro, const double p[3] )
+   {  for( unsigned f : caras_ver[v] )
+      {  if ( ! viva[f] || caras[f](0) == int(otro) || caras[f](1) == int(otro) || caras[f](2) == int(otro) )
+            continue ;
+         const double * q[3], * q_nuevo[3] ;
+         for( unsigned k = 0 ; k < 3 ; k++ )
+         {  q[k]       = &pos[3*caras[f](k)] ;
+            q_nuevo[k] = caras[f](k) == int(v) ? p : q[k] ;
+         }
+         double n[3], n_nuevo[3] ;
+         NormalTriangulo( q[0], q[1], q[2], n );
+         NormalTriangulo( q_nuevo[0], q_nuevo[1], q_nuevo[2], n_nuevo );
+         const double l2 = Prod( n, n ), l2_nuevo = Prod( n_nuevo, n_nuevo );
+         if ( l2_nuevo == 0.0 || Prod( n, n_nuevo ) < min_coseno_cara*std::sqrt( l2*l2_nuevo ) )
+            return true ;
+      }
+      return false ;
+   } ;
+
+   // colapsos, de menor a mayor coste, hasta llegar a 'num_caras'
+   unsigned              vivas = nc ;
+   std::vector<unsigned> vecinos ;
+   while( vivas > num_caras && ! cola.empty() )
+   {
+      const Colapso col = cola.top();
+      cola.pop();
+      const unsigned a = col.a, b = col.b ;
+      if ( eliminado[a] || eliminado[b] || version[a] != col.ver_a || version[b] != col.ver_b )
+         continue ;
+      if ( da_la_vuelta( a, b, col.p ) || da_la_vuelta( b, a, col.p ) )
+         continue ;
+
+      // 'b' desaparece: sus caras pasan a 'a', salvo las que ya tenían 'a'
+      std::copy( col.p, col.p+3, &pos[3*a] );
+      cuad[a] += cuad[b] ;
+      for( unsigned f : caras_ver[b] )
+      {  if ( ! viva[f] )
+            continue ;
+         if ( caras[f](0) == int(a) || caras[f](1) == int(a) || caras[f](2) == int(a) )
+         {  viva[f] = false ;
+            vivas-- ;
+            continue ;
+         }
+         for( unsigned k = 0 ; k < 3 ; k++ )
+            if ( caras[f](k) == int(b) )
+               caras[f](k) = a ;
+         caras_ver[a].push_back( f );
+      }
+      eliminado[b] = true ;
+      std::vector<unsigned>().swap( caras_ver[b] );
+      caras_ver[a].erase( std::remove_if( caras_ver[a].begin(), caras_ver[a].end(),
+                          [&]( unsigned f ) { return ! viva[f] ; } ), caras_ver[a].end() );
+      version[a]++ ;
+
+      // nuevos colapsos de las aristas de 'a'
+      vecinos.clear();
+      for( unsigned f : caras_ver[a] )
+         for( unsigned k = 0 ; k < 3 ; k++ )
+            if ( caras[f](k) != int(a) )
+               vecinos.push_back( caras[f](k) );
+      std::sort( vecinos.begin(), vecinos.end() );
+      vecinos.erase( std::unique( vecinos.begin(), vecinos.end() ), vecinos.end() );
+      for( unsigned w : vecinos )
+         cola.push( calcular_colapso( a, w ) );
+   }
+
+   // tablas resultado, con los vértices que usan las caras vivas
+   const bool con_col  = origen.col_ver != nullptr && origen.col_ver->size() == nv,
+              con_cctt = origen.cctt != nullptr && origen.cctt->size() == nv ;
+   std::vector<unsigned> nuevo( nv, ~0U );
+   destino.vertices->clear();
+   destino.caras->clear();
+   destino.normales_vertices->clear();
+   destino.normales_caras->clear();
+   destino.col_ver->clear();
+   destino.cctt->clear();
+   destino.caras->reserve( vivas );
+   for( unsigned f = 0 ; f < nc ; f++ )
+   {  if ( ! viva[f] )
+         continue ;
+      Tupla3i cara ;
+      for( unsigned k = 0 ; k < 3 ; k++ )
+      {  const unsigned v = caras[f](k) ;
+         if ( nuevo[v] == ~0U )
+         {  nuevo[v] = destino.vertices->size() ;
+            destino.vertices->push_back( Tupla3f( pos[3*v], pos[3*v+1], pos[3*v+2] ) );
+            if ( con_col )
+               destino.col_ver->push_back( (*origen.col_ver)[v] );
+            if ( con_cctt )
+               destino.cctt->push_back( (*origen.cctt)[v] );
+         }
+         cara(k) = nuevo[v] ;
+      }
+      destino.caras->push_back( cara );
+   }
+
+   cout << nombre << ": simplificada de " << nc << " a " << vivas << " caras ("
+        << nv << " -> " << destino.vertices->size() << " vértices, "
+        << std::chrono::duration<double>( std::chrono::steady_clock::now()-t_inicio ).count()
+        << " seg.)" << endl ;
+}
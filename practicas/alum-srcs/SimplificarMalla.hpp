@@ -0,0 +1,31 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Simplificación de mallas con cuádricas de error (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_SIMPLIFICARMALLA_HPP
+#define IG_SIMPLIFICARMALLA_HPP
+
+#include <string>
+#include "CacheMallas.hpp"   // TablasMalla
+
+// ---------------------------------------------------------------------
+// Simplificación por colapso de aristas con la métrica de error cuadrática
+// de M. Garland y P. Heckbert ("Surface Simplification Using Quadric Error
+// Metrics", 1997): cada vértice acumula una cuádrica con los planos de sus
+// caras, y se colapsa siempre la arista que menos error añade, con el
+// vértice resultante en el punto que minimiza la suma de las cuádricas de
+// sus extremos. Los bordes abiertos se conservan con planos perpendiculares
+// a sus caras, y no se hacen colapsos que den la vuelta a alguna cara.
+
+// construye en 'destino' (vértices, caras y, si las hay, colores y coords.
+// de textura) la malla 'origen' simplificada hasta 'num_caras' caras (o
+// hasta donde se pueda). Las normales de 'destino' se dejan vacías.
+// Escribe en 'cout' el número de caras y el tiempo empleado
+void SimpMalla_Simplificar( const TablasMalla & origen, const unsigned num_caras,
+                            TablasMalla & destino, const std::string & nombre );
+
+#endif
@@ -0,0 +1,54 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Tablas de tuplas de 3 flotantes en disposición SoA (implementación)
+// **
+// *********************************************************************
+
+#include "TablaSoA.hpp"
+
+// -----------------------------------------------------------------------------
+
+void TablaSoA3f::resize( const unsigned n )
+{
+   x.resize( n );
+   y.resize( n );
+   z.resize( n );
+}
+// -----------------------------------------------------------------------------
+
+void TablaSoA3f::clear()
+{
+   // se libera la memoria, no basta con 'clear'
+   VectorAlineado().swap( x );
+   VectorAlineado().swap( y );
+   VectorAlineado().swap( z );
+}
+// -----------------------------------------------------------------------------
+
+void TablaSoA3f::poner( const unsigned i, const Tupla3f & t )
+{
+   x[i] = t(0) ;
+   y[i] = t(1) ;
+   z[i] = t(2) ;
+}
+// -----------------------------------------------------------------------------
+
+void TablaSoA3f::desdeAoS( const std::vector<Tupla3f> & src )
+{
+   resize( src.size() );
+   for( unsigned i = 0 ; i < src.size() ; i++ )
+   {  x[i] = src[i](0) ;
+      y[i] = src[i](1) ;
+      z[i] = src[i](2) ;
+   }
+}
+// -----------------------------------------------------------------------------
+
+void TablaSoA3f::aAoS( std::vector<Tupla3f> & dst ) const
+{
+   dst.resize( size() );
+   for( unsigned i = 0 ; i < size() ; i++ )
+      dst[i] = Tupla3f( x[i], y[i], z[i] );
+}
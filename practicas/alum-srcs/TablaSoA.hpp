@@ -0,0 +1,74 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Tablas de tuplas de 3 flotantes en disposición SoA (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_TABLASOA_HPP
+#define IG_TABLASOA_HPP
+
+#include <cstdlib>   // posix_memalign, free
+#include <new>       // std::bad_alloc
+#include <vector>
+#include <tuplasg.hpp>
+
+// alineamiento (en bytes) de las tablas SoA: una línea de caché, que también
+// vale para registros SSE (16) y AVX (32)
+const std::size_t alineamiento_soa = 64 ;
+
+// ---------------------------------------------------------------------
+// asignador de memoria para std::vector que devuelve bloques alineados
+// a 'A' bytes
+
+template< class T, std::size_t A >
+struct AsignadorAlineado
+{
+   typedef T value_type ;
+   template< class U > struct rebind { typedef AsignadorAlineado<U,A> other ; } ;
+
+   AsignadorAlineado() {}
+   template< class U > AsignadorAlineado( const AsignadorAlineado<U,A> & ) {}
+
+   T * allocate( std::size_t n )
+   {  void * p = nullptr ;
+      if ( posix_memalign( &p, A, n*sizeof(T) ) != 0 )
+         throw std::bad_alloc();
+      return (T *) p ;
+   }
+   void deallocate( T * p, std::size_t ) { free( p ); }
+} ;
+
+template< class T, class U, std::size_t A >
+bool operator == ( const AsignadorAlineado<T,A> &, const AsignadorAlineado<U,A> & ) { return true ; }
+template< class T, class U, std::size_t A >
+bool operator != ( const AsignadorAlineado<T,A> &, const AsignadorAlineado<U,A> & ) { return false ; }
+
+typedef std::vector< float, AsignadorAlineado<float,alineamiento_soa> > VectorAlineado ;
+
+// ---------------------------------------------------------------------
+// tabla de tuplas (x,y,z) guardada como tres arrays de flotantes alineados
+// (x0 x1 x2 ..., y0 y1 y2 ..., z0 z1 z2 ...), en lugar de un array de
+// Tupla3f (x0 y0 z0 x1 y1 z1 ...). Así los recorridos que hacen la misma
+// operación con todas las tuplas se pueden hacer con instrucciones SIMD
+
+class TablaSoA3f
+{
+   public:
+      VectorAlineado x, y, z ;
+
+      unsigned size() const { return x.size() ; }
+      void     resize( const unsigned n ) ;
+      void     clear() ;
+
+      // tupla i-ésima
+      Tupla3f  operator () ( const unsigned i ) const { return Tupla3f( x[i], y[i], z[i] ) ; }
+      void     poner( const unsigned i, const Tupla3f & t ) ;
+
+      // copia desde/hacia una tabla AoS (reemplaza el contenido del destino)
+      void     desdeAoS( const std::vector<Tupla3f> & src ) ;
+      void     aAoS( std::vector<Tupla3f> & dst ) const ;
+} ;
+
+#endif
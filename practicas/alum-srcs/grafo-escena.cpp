@@ -24,6 +24,7 @@
 #include "matrices-tr.hpp"
 #include "shaders.hpp"
 #include "grafo-escena.hpp"
+#include "CargaDiferida.hpp"
 
 using namespace std ;
 
@@ -42,11 +43,11 @@ EntradaNGE::EntradaNGE( Objeto3D * pObjeto )
 // ---------------------------------------------------------------------
 // Constructor para entrada de tipo "matriz de transformación"
 
-EntradaNGE::EntradaNGE( const Matriz4f & pMatriz )
+EntradaNGE::EntradaNGE( Matriz4f * pMatriz )
 {
-   tipo    = TipoEntNGE::transformacion ;
-   matriz  = new Matriz4f() ; // matriz en el heap, puntero propietario
-   *matriz = pMatriz ;
+   assert( pMatriz != NULL );
+   tipo   = TipoEntNGE::transformacion ;
+   matriz = pMatriz ; // al agregarla se copia en el almacén del nodo
 }
 
 // ---------------------------------------------------------------------
@@ -73,12 +74,42 @@ EntradaNGE::~EntradaNGE(){}
 
 void NodoGrafoEscena::visualizarGL( ContextoVis & cv )
 {
+   // como raíz, se visualiza la cola (no se recorre el grafo)
+   if ( cv.usarColaVis && ! cv.dibujandoCola )
+   {  cv.numNodosVisitados++ ;
+      compilarCola();
+      cv.dibujandoCola = true ;
+      cola->visualizarGL( cv );
+      cv.dibujandoCola = false ;
+      return ;
+   }
+
+   // matriz de modelado y planos de recorte al entrar (se restauran al salir)
+   const Matriz4f matriz_ant = cv.matrizModelado ;
+   const unsigned planos_ant = cv.planosRecorte ;
+   const bool     recortar   = cv.recortarVista && cv.piramideVision.valida ;
+
+   cv.numNodosVisitados++ ;
    glMatrixMode(GL_MODELVIEW); //operamos sobre la modelview
    glPushMatrix() ; //guarda el modelview actual
    cv.pilaMateriales.push();
    for (unsigned i=0; i<entradas.size(); i++){
      if(entradas[i].tipo == TipoEntNGE::objeto){//si la entrada es sub-objeto
-       entradas[i].objeto->visualizarGL(cv); //visualizarlo
+       // si ningún plano corta ya a este nodo, los hijos están dentro
+       if ( recortar && cv.planosRecorte != 0 )
+       {  unsigned planos = cv.planosRecorte ;
+          cv.matrizModelado = matriz_ant*matrizEntrada( i );
+          const CajaEngf caja = entradas[i].objeto->cajaEnglobante().transformada( cv.matrizModelado );
+          if ( cv.piramideVision.clasificar( caja, planos ) == PosicionCaja::fuera )
+          {  cv.numNodosDescartados++ ;
+             continue ;
+          }
+          cv.planosRecorte = planos ;
+          entradas[i].objeto->visualizarGL(cv); //visualizarlo
+          cv.planosRecorte = planos_ant ;
+       }
+       else
+          entradas[i].objeto->visualizarGL(cv); //visualizarlo
      }
      else if(entradas[i].tipo == TipoEntNGE::material){
        cv.pilaMateriales.activarMaterial(entradas[i].material);
@@ -91,12 +122,26 @@ void NodoGrafoEscena::visualizarGL( ContextoVis & cv )
    cv.pilaMateriales.pop();
    glMatrixMode(GL_MODELVIEW); //operamos sobre la modelview
    glPopMatrix(); //restaura modelview guardada
+   cv.matrizModelado = matriz_ant ;
+   cv.planosRecorte  = planos_ant ;
 }
 // -----------------------------------------------------------------------------
 
 NodoGrafoEscena::NodoGrafoEscena(){}
 // -----------------------------------------------------------------------------
 
+NodoGrafoEscena::~NodoGrafoEscena()
+{
+   delete cola ;
+   delete indice ;
+   if ( Arena_Vaciando() )
+      return ;
+   for( unsigned i = 0 ; i < entradas.size() ; i++ )
+      if ( entradas[i].tipo == TipoEntNGE::objeto )
+         entradas[i].objeto->quitarPadre( this );
+}
+// -----------------------------------------------------------------------------
+
 void NodoGrafoEscena::fijarColorNodo( const Tupla3f & nuevo_color )
 {
   for(int i=0; i<entradas.size();i++){
@@ -119,6 +164,18 @@ void NodoGrafoEscena::fijarColorHoja( const Tupla3f & nuevo_color ){
 unsigned NodoGrafoEscena::agregar( const EntradaNGE & entrada )
 {
    entradas.push_back(entrada);
+   // la matriz se copia al final del almacén (no mueve las anteriores)
+   if ( entrada.tipo == TipoEntNGE::transformacion )
+   {  matrices.push_back( *entrada.matriz );
+      entradas.back().matriz = &matrices.back() ;
+   }
+   // un hijo nuevo invalida la caja de este nodo, y sus cambios también.
+   // Los materiales no cambian la caja, pero sí las colas de visualización
+   if ( entrada.tipo == TipoEntNGE::objeto )
+      entrada.objeto->agregarPadre( this );
+   matrices_validas = false ;
+   cambioEstructura();
+   invalidarCaja();
    return (entradas.size()-1);
 }
 // -----------------------------------------------------------------------------
@@ -135,7 +192,8 @@ unsigned NodoGrafoEscena::agregar( Objeto3D * pObjeto )
 
 unsigned NodoGrafoEscena::agregar( const Matriz4f & pMatriz )
 {
-   return agregar( EntradaNGE( pMatriz ) );
+   Matriz4f copia = pMatriz ;
+   return agregar( EntradaNGE( &copia ) );
 }
 // ---------------------------------------------------------------------
 // material (copia solo puntero)
@@ -150,16 +208,148 @@ Matriz4f * NodoGrafoEscena::leerPtrMatriz( unsigned indice ){
   return resultado;
 }
 // -----------------------------------------------------------------------------
+
+Objeto3D * NodoGrafoEscena::leerObjeto( unsigned indice ){
+  return entradas.at(indice).objeto;
+}
+// -----------------------------------------------------------------------------
 // si 'centro_calculado' es 'false', recalcula el centro usando los centros
 // de los hijos (el punto medio de la caja englobante de los centros de hijos)
 
 void NodoGrafoEscena::calcularCentroOC()
 {
+   if ( centro_calculado )
+      return ;
+   ponerCentroOC( cajaEnglobante().centro() );
+   centro_calculado = true ;
+}
+// -----------------------------------------------------------------------------
+// la caja del nodo se calcula antes de construir la cola: así las de todo el
+// subárbol son válidas, y cualquier cambio posterior (en la geometría, en las
+// entradas o en una matriz) aumenta el número de invalidaciones del nodo. Si
+// no han cambiado las entradas, basta con actualizar las matrices de la cola
+
+void NodoGrafoEscena::compilarCola()
+{
+   if ( cola != nullptr && leerNumInvalidaciones() == invalidaciones_cola )
+      return ;
+
+   cajaEnglobante();
+   invalidaciones_cola = leerNumInvalidaciones();
+
+   if ( cola != nullptr && leerNumCambiosEstructura() == estructura_cola )
+   {  cola->actualizar();
+      return ;
+   }
+   if ( cola == nullptr )
+      cola = new ColaVisualizacion() ;
+   estructura_cola = leerNumCambiosEstructura();
+
+   EstadoAplanado estado ;
+   estado.instancia          = -1 ;
+   estado.entrada            = 0 ;
+   estado.material           = nullptr ;
+   estado.instancia_material = -1 ;
+   estado.entrada_material   = 0 ;
+   estado.identificador      = 0 ;
+
+   cola->vaciar();
+   aplanar( *cola, estado );
+   cola->ordenar();
+}
+// -----------------------------------------------------------------------------
+
+void NodoGrafoEscena::aplanar( ColaVisualizacion & cola, const EstadoAplanado & estado )
+{
+   EstadoAplanado hijos = estado ;
+   hijos.instancia      = cola.agregarInstancia( this, estado.instancia, estado.entrada );
+   if ( leerIdentificador() != -1 )
+      hijos.identificador = leerIdentificador() ;
+
+   for( unsigned i = 0 ; i < entradas.size() ; i++ )
+   {
+      if ( entradas[i].tipo == TipoEntNGE::objeto )
+      {  hijos.entrada = i ;
+         entradas[i].objeto->aplanar( cola, hijos );
+      }
+      else if ( entradas[i].tipo == TipoEntNGE::material )
+      {  hijos.material           = entradas[i].material ;
+         hijos.instancia_material = hijos.instancia ;
+         hijos.entrada_material   = i ;
+      }
+   }
+}
+// -----------------------------------------------------------------------------
+
+// el nodo va antes que los hijos, y los hijos en orden, como en 'buscarObjeto'
+
+void NodoGrafoEscena::indexar( IndiceIdentificadores & indice, const int paso )
+{
+   indice.agregar( leerIdentificador(), paso );
+   for( unsigned i = 0 ; i < entradas.size() ; i++ )
+      if ( entradas[i].tipo == TipoEntNGE::objeto )
+         entradas[i].objeto->indexar( indice, indice.agregarPaso( this, i, paso ) );
+}
+// -----------------------------------------------------------------------------
+
+void NodoGrafoEscena::indexarIdentificadores()
+{
+   if ( indice == nullptr )
+      indice = new IndiceIdentificadores() ;
+   estructura_indice = leerNumCambiosEstructura();
+   indice->vaciar();
+   indexar( *indice, -1 );
+}
+// -----------------------------------------------------------------------------
+
+const Matriz4f & NodoGrafoEscena::matrizEntrada( const unsigned i )
+{
+   if ( ! matrices_validas )
+   {
+      Matriz4f mat = MAT_Ident();
+      matrices_entradas.resize( entradas.size() );
+      for( unsigned j = 0 ; j < entradas.size() ; j++ )
+      {  matrices_entradas[j] = mat ;
+         if ( entradas[j].tipo == TipoEntNGE::transformacion )
+            mat = mat*(*entradas[j].matriz) ;
+      }
+      matrices_validas = true ;
+   }
+   return matrices_entradas[i] ;
+}
+// -----------------------------------------------------------------------------
 
-   //   calcular y guardar el centro del nodo
-   //    en coordenadas de objeto (hay que hacerlo recursivamente)
-   //   (si el centro ya ha sido calculado, no volver a hacerlo)
+void NodoGrafoEscena::invalidarMatrices()
+{
+   matrices_validas = false ;
+   num_cambios_matrices++ ;
+   invalidarCaja();
+}
+// -----------------------------------------------------------------------------
 
+unsigned long NodoGrafoEscena::leerNumCambiosMatrices() const
+{
+   return num_cambios_matrices ;
+}
+// -----------------------------------------------------------------------------
+// caja englobante del nodo, a partir de las de sus hijos (que tienen su
+// propia caché, así que solo se recorren los subárboles que han cambiado)
+
+CajaEngf NodoGrafoEscena::calcularCajaEnglobante()
+{
+   CajaEngf caja ;
+   bool     identidad = true ; // no ha habido matrices (no hace falta transformar)
+
+   for( unsigned i = 0 ; i < entradas.size() ; i++ )
+   {
+      if ( entradas[i].tipo == TipoEntNGE::objeto )
+      {  const CajaEngf caja_hijo = entradas[i].objeto->cajaEnglobante();
+         caja.unir( identidad ? caja_hijo : caja_hijo.transformada( matrizEntrada( i ) ) );
+      }
+      else if ( entradas[i].tipo == TipoEntNGE::transformacion )
+         identidad = false ;
+   }
+   return caja ;
 }
 // -----------------------------------------------------------------------------
 // método para buscar un objeto con un identificador y devolver un puntero al mismo
@@ -173,7 +363,6 @@ bool NodoGrafoEscena::buscarObjeto
 )
 {
   bool salida = false;
-  Matriz4f mTMP = mmodelado;
   if(!centro_calculado){
     calcularCentroOC();
   }
@@ -183,14 +372,18 @@ bool NodoGrafoEscena::buscarObjeto
      *objeto = this;
      salida = true;
    }
+   else if(indice != nullptr){ //ir directamente al objeto con el índice
+     if(estructura_indice != leerNumCambiosEstructura())
+       indexarIdentificadores();
+     int paso;
+     if(indice->buscar(ident_busc, paso) && paso >= 0)
+       salida = indice->objeto(paso)->buscarObjeto(ident_busc, mmodelado*indice->matriz(paso), objeto, centro_wc);
+   }
    else{ //buscar en los hijos
      bool encontrado = false;
      for(unsigned i=0; i<entradas.size()&&!encontrado; i++){
        if(entradas[i].tipo == TipoEntNGE::objeto){
-         encontrado = entradas[i].objeto->buscarObjeto(ident_busc,mTMP,objeto,centro_wc);
-       }
-       else if(entradas[i].tipo == TipoEntNGE::transformacion){
-         mTMP = mTMP*(*entradas[i].matriz);
+         encontrado = entradas[i].objeto->buscarObjeto(ident_busc,mmodelado*matrizEntrada(i),objeto,centro_wc);
        }
      }
      salida = encontrado;
@@ -199,6 +392,26 @@ bool NodoGrafoEscena::buscarObjeto
 
 }
 
+void NodoGrafoEscena::buscarObjetos
+(
+   const std::vector<int> &  idents,     // identificadores a buscar (ordenados)
+   const Matriz4f &          mmodelado,  // matriz de modelado
+   std::vector<Objeto3D *> & objetos,    // (salida) objetos encontrados
+   std::vector<Tupla3f> &    centros_wc, // (salida) sus centros en coordenadas del mundo
+   unsigned &                pendientes  // (entrada/salida) identificadores sin encontrar
+)
+{
+  if(!centro_calculado){
+    calcularCentroOC();
+  }
+  Objeto3D::buscarObjetos(idents, mmodelado, objetos, centros_wc, pendientes);
+  for(unsigned i=0; i<entradas.size() && pendientes>0; i++){
+    if(entradas[i].tipo == TipoEntNGE::objeto){
+      entradas[i].objeto->buscarObjetos(idents,mmodelado*matrizEntrada(i),objetos,centros_wc,pendientes);
+    }
+  }
+}
+
 int NodoGrafoEscena::setIdentificadores(int id){
   ponerIdentificador(id);
   id++;
@@ -208,6 +421,7 @@ int NodoGrafoEscena::setIdentificadores(int id){
       id++;
     }
   }
+  indexarIdentificadores();
   return id;
 }
 
@@ -242,13 +456,14 @@ Pelota::Pelota(vector <Parametro> *p){
   agregar(MAT_Traslacion(0.0,0.0,0.0));
   agregar(MAT_Traslacion(-2.5,1.0,0.0));
   agregar(MAT_Escalado(0.5,0.5,0.5));
-  Esfera * esf = new Esfera(1000,1000,false,false);
+  Objeto3D * esf = new MallaDiferida("esfera pelota",
+                      []{ return new Esfera(1000,1000,false,false); });
   agregar(new MaterialPelota());
   agregar(esf);
   string mensaje = "Movimiento de la pelota: Botar.";
   p->push_back(Parametro(mensaje, entradas[0].matriz,
               [=](float v){return MAT_Traslacion(0.0,v,0.0);},
-              true, 0.0, 0.5, 0.1));
+              true, 0.0, 0.5, 0.1, this));
   fijarColorNodo(Tupla3f(0.5,0.18,0.18));
 }
 
@@ -256,7 +471,9 @@ Base::Base(vector <Parametro> *p){
   ponerNombre("base lámpara");
 
   agregar(MAT_Escalado(1.5,0.5,1.5));
-  Cilindro * cil = new Cilindro(5,1000,true,true);
+  Objeto3D * cil = new MallaDiferida("cilindro base",
+                      []{ return new Cilindro(5,1000,true,true); },
+                      Tupla3f(-1.0,0.0,-1.0), Tupla3f(1.0,1.0,1.0));
   agregar(new MaterialFlexo());
   agregar(cil);
   fijarColorNodo(Tupla3f(0.5,0.5,0.5));
@@ -267,7 +484,9 @@ Barra::Barra(vector <Parametro> *p){
 
   agregar(MAT_Traslacion(0.0,0.4,0.0));
   agregar(MAT_Escalado(0.2,3.0,0.2));
-  Cilindro * cil = new Cilindro(5,1000,true,true);
+  Objeto3D * cil = new MallaDiferida("cilindro barra",
+                      []{ return new Cilindro(5,1000,true,true); },
+                      Tupla3f(-1.0,0.0,-1.0), Tupla3f(1.0,1.0,1.0));
   agregar(new MaterialFlexo());
   agregar(cil);
   fijarColorNodo(Tupla3f(0.5,0.5,0.5));
@@ -284,19 +503,24 @@ LamparaSuperior::LamparaSuperior(vector <Parametro> *p){
   agregar(MAT_Traslacion(-0.9,0.0,0.0));
   agregar(MAT_Rotacion(-90.0,0.0,0.0,1.0));
   agregar(MAT_Escalado(0.5,0.5,0.5));
-  Esfera * esf = new Esfera(1000,1000,true,true);
+  Objeto3D * esf = new MallaDiferida("esfera bombilla",
+                      []{ return new Esfera(1000,1000,true,true); });
   agregar(new MaterialBombilla());
   agregar(esf);
   fijarColorHoja(Tupla3f(1.0,0.8,0.0));
   agregar(MAT_Escalado(2.0,2.0,2.0));
   agregar(MAT_Traslacion(0.0,-0.5,0.0));
-  ConoTruncado * ct = new ConoTruncado(1.0,0.5,5,1000,false,true);
+  Objeto3D * ct = new MallaDiferida("cono truncado pantalla",
+                      []{ return new ConoTruncado(1.0,0.5,5,1000,false,true); },
+                      Tupla3f(-1.0,0.0,-1.0), Tupla3f(1.0,1.0,1.0));
   agregar(new MaterialFlexo());
   agregar(ct);
   fijarColorHoja(Tupla3f(0.5,0.5,0.5));
   agregar(MAT_Traslacion(0.0,1.0,0.0));
   agregar(MAT_Escalado(0.5,1.0,0.5));
-  Cilindro * cil = new Cilindro(5,1000,true,true);
+  Objeto3D * cil = new MallaDiferida("cilindro cabezal",
+                      []{ return new Cilindro(5,1000,true,true); },
+                      Tupla3f(-1.0,0.0,-1.0), Tupla3f(1.0,1.0,1.0));
   agregar(new MaterialFlexo());
   agregar(cil);
   fijarColorHoja(Tupla3f(0.5,0.5,0.5));
@@ -304,15 +528,15 @@ LamparaSuperior::LamparaSuperior(vector <Parametro> *p){
   string mensaje = "Rotación a los lados del cabezal del flexo.";
   p->push_back(Parametro(mensaje, entradas[1].matriz,
               [=](float v){return MAT_Rotacion(v,0.0,1.0,0.0);},
-              false, 0.0, 15.0, 0.5));
+              false, 0.0, 15.0, 0.5, this));
   string mensaje2 = "Rotación arriba-abajo del cabezal del flexo.";
   p->push_back(Parametro(mensaje2, entradas[3].matriz,
               [=](float v){return MAT_Rotacion(v,0.0,0.0,1.0);},
-              true, 0.0, 20.0, 0.2));
+              true, 0.0, 20.0, 0.2, this));
   string mensaje3 = "Desplazamiento lateral del cabezal del flexo.";
   p->push_back(Parametro(mensaje3, entradas[0].matriz,
                 [=](float v){return MAT_Traslacion(v,0.0,0.0);},
-                true, 0.0, 0.15, 0.03));
+                true, 0.0, 0.15, 0.03, this));
 }
 
 Lampara::Lampara(){
@@ -338,9 +562,20 @@ void Lampara::reiniciar(){
 
 Lata::Lata(){
   ponerNombre("Lata");
-  Objeto3D * lataInf = new MallaRevol("../plys/lata-pinf.ply",100,true,true,true);
-  Objeto3D * lataCue = new MallaRevol("../plys/lata-pcue.ply",100,false,true,true);
-  Objeto3D * lataSup = new MallaRevol("../plys/lata-psup.ply",100,true,true,true);
+  Objeto3D * lataInf = new MallaDiferida("../plys/lata-pinf.ply",
+      []{ return new MallaRevol("../plys/lata-pinf.ply",100,true,true,true); },
+      Tupla3f(-0.22,0.0,-0.22), Tupla3f(0.22,0.03,0.22));
+  Objeto3D * lataCue = new MallaDiferida("../plys/lata-pcue.ply",
+      []{ return new MallaRevol("../plys/lata-pcue.ply",100,false,true,true); },
+      Tupla3f(-0.28,0.03,-0.28), Tupla3f(0.28,1.06,0.28));
+  Objeto3D * lataSup = new MallaDiferida("../plys/lata-psup.ply",
+      []{ return new MallaRevol("../plys/lata-psup.ply",100,true,true,true); },
+      Tupla3f(-0.22,1.02,-0.22), Tupla3f(0.22,1.09,0.22));
+
+  // las mallas toman el identificador de la lata (con 0 no se podrían seleccionar)
+  lataInf->ponerIdentificador(-1);
+  lataCue->ponerIdentificador(-1);
+  lataSup->ponerIdentificador(-1);
 
   agregar(new MaterialTapasLata());
   agregar(lataSup);
@@ -355,7 +590,10 @@ Lata::Lata(){
 PeonBlanco::PeonBlanco(){
   ponerNombre("Peon blanco");
 
-  Objeto3D *peon = new MallaRevol("../plys/peon.ply",1000,true,true,false);
+  Objeto3D *peon = new MallaDiferida("../plys/peon.ply",
+      []{ return new MallaRevol("../plys/peon.ply",1000,true,true,false); },
+      Tupla3f(-1.0,-1.4,-1.0), Tupla3f(1.0,1.4,1.0));
+  peon->ponerIdentificador(-1); // (el del peón, ver Lata)
 
   agregar(MAT_Traslacion(-0.5,0.28,0.7));
   agregar(MAT_Escalado(0.2,0.2,0.2));
@@ -367,7 +605,10 @@ PeonBlanco::PeonBlanco(){
 PeonMadera::PeonMadera(){
   ponerNombre("Peon madera");
 
-  Objeto3D *peon = new MallaRevol("../plys/peon.ply",1000,true,true,false);
+  Objeto3D *peon = new MallaDiferida("../plys/peon.ply",
+      []{ return new MallaRevol("../plys/peon.ply",1000,true,true,false); },
+      Tupla3f(-1.0,-1.4,-1.0), Tupla3f(1.0,1.4,1.0));
+  peon->ponerIdentificador(-1); // (el del peón, ver Lata)
 
   agregar(MAT_Traslacion(0.0,0.28,0.7));
   agregar(MAT_Escalado(0.2,0.2,0.2));
@@ -378,7 +619,10 @@ PeonMadera::PeonMadera(){
 
 PeonNegro::PeonNegro(){
   ponerNombre("Peon negro");
-  Objeto3D *peon = new MallaRevol("../plys/peon.ply",1000,true,true,false);
+  Objeto3D *peon = new MallaDiferida("../plys/peon.ply",
+      []{ return new MallaRevol("../plys/peon.ply",1000,true,true,false); },
+      Tupla3f(-1.0,-1.4,-1.0), Tupla3f(1.0,1.4,1.0));
+  peon->ponerIdentificador(-1); // (el del peón, ver Lata)
 
   agregar(MAT_Traslacion(0.5,0.28,0.7));
   agregar(MAT_Escalado(0.2,0.2,0.2));
@@ -401,4 +645,5 @@ EscenaObjetosLuces::EscenaObjetosLuces(){
   agregar(pb);
   agregar(pn);
   agregar(pm);
+  indexarIdentificadores();
 }
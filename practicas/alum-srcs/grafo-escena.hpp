@@ -31,7 +31,11 @@
 #include "materiales.hpp"
 #include "Objeto3D.hpp"
 #include "Parametro.hpp"
+#include "ColaVisualizacion.hpp"
+#include "IndiceIdentificadores.hpp"
+#include "Arena.hpp"
 #include <vector>
+#include <deque>
 
 using namespace std ;
 
@@ -53,12 +57,13 @@ struct EntradaNGE
    TipoEntNGE tipo ;   // objeto, transformacion, material
    union
    {  Objeto3D * objeto ;  // ptr. a un objeto (no propietario)
-      Matriz4f * matriz ;  // ptr. a matriz 4x4 transf. (propietario)
+      Matriz4f * matriz ;  // ptr. a matriz 4x4 transf. (no propietario: una vez
+                           // agregada, apunta al almacén de matrices del nodo)
       Material * material ; // ptr. a material (no propietario)
    } ;
    // constructores (uno por tipo)
    EntradaNGE( Objeto3D * pObjeto ) ;      // (copia solo puntero)
-   EntradaNGE( const Matriz4f & pMatriz ); // (crea copia en el heap)
+   EntradaNGE( Matriz4f * pMatriz );       // (copia solo puntero, 'agregar' copia la matriz)
    EntradaNGE( Material * pMaterial ) ;    // (copia solo puntero)
    ~EntradaNGE() ;
 } ;
@@ -69,20 +74,86 @@ struct EntradaNGE
 class NodoGrafoEscena : public Objeto3D
 {
    protected:
-   std::vector < EntradaNGE > entradas;
+   // las entradas y las matrices van en la arena de la escena, si la hay
+   // (ver Arena.hpp), junto al nodo
+   std::vector < EntradaNGE, AsignadorArena<EntradaNGE> > entradas;
    //Tupla3f color;
 
+   // almacén de las matrices de las entradas de tipo transformación: se
+   // guardan seguidas en bloques, y las que hay no se mueven al añadir más,
+   // así que los punteros de 'leerPtrMatriz' (los de 'Parametro') siguen
+   // siendo válidos. Se liberan con el nodo
+   std::deque < Matriz4f, AsignadorArena<Matriz4f> > matrices ;
+
+   // caja englobante: unión de las cajas de los hijos, transformadas por
+   // las matrices que les preceden
+   virtual CajaEngf calcularCajaEnglobante() ;
+
+   // cola de visualización del nodo (solo la tienen los nodos que se
+   // visualizan como raíz) y número de invalidaciones de la caja del nodo
+   // cuando se construyó (si ha cambiado, hay que construirla otra vez)
+   ColaVisualizacion * cola = nullptr ;
+   unsigned long       invalidaciones_cola = 0 ,
+                       estructura_cola     = 0 ; // cambios de estructura del nodo cuando se construyó
+
+   // caché de las matrices de las entradas respecto del nodo (la composición
+   // de las matrices de las entradas anteriores), válida si 'matrices_validas'
+   std::vector<Matriz4f> matrices_entradas ;
+   bool                  matrices_validas     = false ;
+   unsigned long         num_cambios_matrices = 0 ;
+
+   // índice de los identificadores de los objetos del nodo y de los que hay
+   // por debajo (solo lo tienen los nodos indexados con
+   // 'indexarIdentificadores'), y cambios de estructura del nodo cuando se
+   // construyó (si han cambiado, hay que construirlo otra vez)
+   IndiceIdentificadores * indice = nullptr ;
+   unsigned long           estructura_indice = 0 ;
+
    public:
 
    NodoGrafoEscena() ;
-
-   // visualiza usando OpenGL
+   // no se copian (las entradas apuntan al almacén de matrices propio)
+   NodoGrafoEscena( const NodoGrafoEscena & ) = delete ;
+   NodoGrafoEscena & operator = ( const NodoGrafoEscena & ) = delete ;
+   // se quita de la lista de padres de sus hijos (salvo al vaciar una
+   // arena, cuando los hijos pueden estar ya destruidos)
+   virtual ~NodoGrafoEscena() ;
+
+   // visualiza usando OpenGL (con la cola de visualización del nodo si
+   // 'cv.usarColaVis' es true)
    virtual void visualizarGL( ContextoVis & cv ) ;
+
+   // construye la cola de visualización del nodo si no existe o si ha
+   // cambiado algo del grafo desde que se construyó
+   void compilarCola() ;
+
+   // añadir a 'cola' una instancia de este nodo y las hojas de los hijos
+   // (ver Objeto3D::aplanar)
+   virtual void aplanar( ColaVisualizacion & cola, const EstadoAplanado & estado ) ;
+
+   // añadir a 'indice' el identificador del nodo y, con un paso por cada
+   // entrada de tipo objeto, los de los hijos (ver Objeto3D::indexar)
+   virtual void indexar( IndiceIdentificadores & indice, const int paso ) ;
+
+   // construye el índice de identificadores del nodo: a partir de entonces
+   // 'buscarObjeto' va directamente al objeto por su camino, sin recorrer el
+   // grafo (el índice se vuelve a construir si cambia la estructura)
+   void indexarIdentificadores() ;
+
+   // matriz de modelado de la entrada 'i' respecto del nodo: la composición
+   // de las matrices de las entradas anteriores (se recalcula solo si ha
+   // cambiado alguna matriz del nodo). La usan la visualización, el cálculo
+   // de la caja englobante, la búsqueda de objetos y la cola
+   const Matriz4f & matrizEntrada( const unsigned i ) ;
+
+   // hay que llamarlo cuando cambia una matriz del nodo (lo hace Parametro):
+   // invalida la caché de matrices del nodo y su caja englobante
+   void invalidarMatrices() ;
+   unsigned long leerNumCambiosMatrices() const ;
    void fijarColorNodo( const Tupla3f & nuevo_color ) ;
    void fijarColorHoja( const Tupla3f & nuevo_color ) ;
 
-   // calcular y obtener la caja englobante
-   //virtual CajaEngf cajaEnglobante() ;
+   // la caja englobante se obtiene con 'cajaEnglobante' (ver Objeto3D)
 
    // añadir una entrada al final, hace copia de la entrada
    // devuelve indice de la entrada dentro del vector de entradas
@@ -90,25 +161,37 @@ class NodoGrafoEscena : public Objeto3D
 
    // construir una entrada y añadirla (al final)
    unsigned agregar( Objeto3D * pObjeto ); // objeto (copia solo puntero)
-   unsigned agregar( const Matriz4f & pMatriz ); // matriz (copia objeto)
+   unsigned agregar( const Matriz4f & pMatriz ); // matriz (copia objeto en el almacén)
    unsigned agregar( Material * pMaterial ); // material (copia solo puntero)
 
    // devuelve el puntero a la matriz en la i-ésima entrada
+   // (si se cambia la matriz hay que llamar a 'invalidarMatrices')
    Matriz4f * leerPtrMatriz( unsigned iEnt );
 
+   // devuelve el puntero al objeto en la i-ésima entrada
+   Objeto3D * leerObjeto( unsigned iEnt );
+
    //asigna los identificadores a todos los objetos del nodo.
    //IMPORTANTE: modifica id
    //Es importante el orden en el que se llama. El último que se tiene que
    //llamar es la escena completa
+   //Además indexa los identificadores del nodo (ver 'indexarIdentificadores')
    int setIdentificadores(int id);
 
    // método para buscar un objeto con un identificador. Al principio virtual
+   // (con índice, compone solo las matrices del camino hasta el objeto)
    bool buscarObjeto( const int ident_busc, const Matriz4f & mmodelado,
                     Objeto3D ** objeto, Tupla3f & centro_wc )  ;
 
-   // si 'centro_calculado' es 'false', recalcula el centro usando los centros
-   // de los hijos (el punto medio de la caja englobante de los centros de hijos)
-   //al principio virtual
+   // buscar varios objetos en un solo recorrido del grafo (ver
+   // Objeto3D::buscarObjetos): la matriz de cada entrada se compone una vez
+   // para todos los identificadores
+   void buscarObjetos( const std::vector<int> & idents, const Matriz4f & mmodelado,
+                       std::vector<Objeto3D *> & objetos, std::vector<Tupla3f> & centros_wc,
+                       unsigned & pendientes ) ;
+
+   // si 'centro_calculado' es 'false', recalcula el centro: el centro de la
+   // caja englobante del nodo
    void calcularCentroOC() ;
 
 } ;
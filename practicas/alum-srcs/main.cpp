@@ -14,6 +14,8 @@
 #include <string>   // std::string
 #include <iostream> // std::cout
 #include <fstream>  // ifstream
+#include <sstream>  // ostringstream
+#include <algorithm> // equal, copy
 #include <cmath>    // fabs
 #include <chrono>   // función 'now', tipos 'time_point' y 'duration'
 
@@ -30,6 +32,9 @@
 #include "practica3.hpp"
 #include "practica4.hpp"
 #include "practica5.hpp"
+#include "CacheMallas.hpp"
+#include "CargaDiferida.hpp"
+#include "Arena.hpp"
 
 // evita la necesidad de escribir std::
 using namespace std ;
@@ -67,12 +72,19 @@ bool
    modo_arrastrar_bder = false ; // modo arrastrar con boton derecho pulsado
 GLFWwindow *
    glfw_window       = nullptr ; // puntero a la ventana GLFW
+const char *
+   titulo_ventana    = "Practicas IG GIM (18-19)" ; // título (se le añaden los contadores del cuadro)
 ContextoVis
    contextoVis ;                 // contexto de visualización actual (incluye modo de visualización)
 //ShaderProg * shaders;
 // puntero a función que se ejecuta cuando no hay eventos pendientes
 // (si es null no se hace nada)
 void (*func_desocupado_actual)(void) = nullptr ;
+// arena en la que se crea la escena de la práctica actual (ver Arena.hpp):
+// solo existe la escena de la práctica actual, se crea al pasar a ella y
+// se destruye entera al pasar a otra
+Arena
+   arenaEscena ;
 
 
 // *********************************************************************
@@ -93,6 +105,59 @@ void ErrorGLFW( int codigo, const char * msg )
 }
 
 
+// ---------------------------------------------------------------------
+// crea los objetos de la práctica 'p' en 'arenaEscena'
+
+void InicializarPractica( const int p )
+{
+   using namespace std ;
+   // se mide el tiempo de creación de los objetos de la práctica, también
+   // al cambiar de práctica (con la caché de mallas, la segunda vez es mucho
+   // más rápida)
+   const auto t_inicio = std::chrono::steady_clock::now();
+   {
+      UsarArena usar( &arenaEscena );
+      switch( p )
+      {
+         case 1 : P1_Inicializar(  ) ; break ;
+         case 2 : P2_Inicializar(  ) ; break ;
+         case 3 : P3_Inicializar(  ) ; break ;
+         case 4 : P4_Inicializar(  ) ; break ;
+         case 5 : P5_Inicializar( ventana_tam_x, ventana_tam_y ) ; break ;
+      }
+   }
+   cout << "práctica " << p << ": escena creada en la arena: "
+        << arenaEscena.numObjetos() << " objetos, "
+        << arenaEscena.bytesUsados()/1024.0 << " KB en "
+        << arenaEscena.numBloques() << " bloques" << endl << flush ;
+
+   // las mallas grandes se siguen construyendo en segundo plano (ver CargaDiferida.hpp)
+   CacheMalla_Informe( "tiempo de inicialización de la práctica " + to_string( p ),
+      std::chrono::duration<double>( std::chrono::steady_clock::now() - t_inicio ).count() );
+}
+
+// ---------------------------------------------------------------------
+// destruye los objetos de la práctica 'p' (todos los de 'arenaEscena') e
+// informa del máximo de memoria que ha usado su escena en la arena
+
+void DestruirPractica( const int p )
+{
+   using namespace std ;
+   const unsigned num_objetos = arenaEscena.numObjetos() ;
+   const size_t   maximo      = arenaEscena.bytesUsados(), // en la arena no se reutiliza memoria
+                  en_bloques  = arenaEscena.bytesBloques() ;
+   const auto     t_inicio    = std::chrono::steady_clock::now();
+
+   arenaEscena.vaciar();
+   // el material activo podía ser de la escena destruida
+   contextoVis.pilaMateriales = PilaMateriales();
+
+   cout << "práctica " << p << ": escena destruida (" << num_objetos << " objetos) en "
+        << std::chrono::duration<double,std::milli>( std::chrono::steady_clock::now() - t_inicio ).count()
+        << " ms, máximo en la arena: " << maximo/1024.0 << " KB ("
+        << en_bloques/1024.0 << " KB en bloques)" << endl << flush ;
+}
+
 // ---------------------------------------------------------------------
 // asigna el color de fondo actual a todos los pixels de la ventana
 
@@ -158,6 +223,8 @@ void FijarMVPOpenGL()
    glMatrixMode( GL_MODELVIEW );
    glLoadIdentity();
    glMultMatrixf( matrizVista );
+
+   contextoVis.piramideVision = PiramideVision( matrizProye, matrizVista );
 }
 // -----------------------------------------------------------------------------
 // órdenes de OpenGL que fijan la camara y visualizan la escena
@@ -165,7 +232,7 @@ void FijarMVPOpenGL()
 void DibujarEscena()
 {
    if ( practicaActual == 5 )
-      P5_FijarMVPOpenGL( ventana_tam_x, ventana_tam_y );
+      P5_FijarMVPOpenGL( ventana_tam_x, ventana_tam_y, contextoVis );
    else
       FijarMVPOpenGL();
 
@@ -194,8 +261,29 @@ void VisualizarFrame()
    /*if (contextoVis.usarShader)
       shaders->activar();*/
 
+   // triángulos dibujados, nodos recorridos, descartados por la pirámide de
+   // visión y mallas dibujadas en este cuadro (se muestran en el título de
+   // la ventana cuando cambian)
+   static unsigned long contadores_ant[4] = { 0, 0, 0, 0 } ;
+   contextoVis.numTriangulos = 0 ;
+   contextoVis.numNodosVisitados = contextoVis.numNodosDescartados =
+   contextoVis.numNodosDibujados = 0 ;
+   contextoVis.matrizModelado    = MAT_Ident() ;
+   contextoVis.planosRecorte     = todos_los_planos ;
+
    DibujarEscena();  // ordenes OpenGL para dibujar la escena correspondiente a la práctica actual
 
+   const unsigned long contadores[4] = { contextoVis.numTriangulos, contextoVis.numNodosVisitados,
+                                         contextoVis.numNodosDescartados, contextoVis.numNodosDibujados };
+   if ( ! equal( contadores, contadores+4, contadores_ant ) )
+   {  copy( contadores, contadores+4, contadores_ant );
+      ostringstream titulo ;
+      titulo << titulo_ventana << " - triángulos: " << contadores[0]
+             << ", nodos visitados: " << contadores[1] << ", descartados: " << contadores[2]
+             << ", mallas dibujadas: " << contadores[3] ;
+      glfwSetWindowTitle( glfw_window, titulo.str().c_str() );
+   }
+
    // visualizar en pantalla el buffer trasero (donde se han dibujado las primitivas)
    glfwSwapBuffers( glfw_window );
 }
@@ -262,11 +350,16 @@ void FGE_PulsarTeclaCaracter( GLFWwindow* window, unsigned int codepoint )
    {
       case 'Q' :
       case 27  :
-         exit( 0 );
+         // se sale del bucle de eventos, que destruye la escena antes de
+         // cerrar OpenGL
+         terminar_programa = true ;
+         redibujar = false ;
          break ;
       case 'P' :
+         DestruirPractica( practicaActual );
          practicaActual = (practicaActual % numPracticas) +1 ;
          cout << "Práctica actual cambiada a: " << practicaActual << endl << flush ;
+         InicializarPractica( practicaActual );
          if ( practicaActual == 3 )
             FijarFuncDesocupado( FGE_Desocupado );
          break ;
@@ -290,6 +383,16 @@ void FGE_PulsarTeclaCaracter( GLFWwindow* window, unsigned int codepoint )
            cout << "modo de visualización cambiado a: modo inmediato" << endl << flush ;
          }
          break;
+      case 'L':
+         contextoVis.usarColaVis = ! contextoVis.usarColaVis ;
+         cout << "visualización de los grafos de escena: "
+              << (contextoVis.usarColaVis ? "con cola de visualización" : "recorriendo el grafo") << endl << flush ;
+         break;
+      case 'F':
+         contextoVis.recortarVista = ! contextoVis.recortarVista ;
+         cout << "recortado con la pirámide de visión: "
+              << (contextoVis.recortarVista ? "activado" : "desactivado") << endl << flush ;
+         break;
       default:
          redibujar = false;
          switch( practicaActual )
@@ -503,9 +606,14 @@ void FGE_ClickRaton( GLFWwindow* window, int button, int action, int mods )
 void FGE_RatonMovido( GLFWwindow* window, double xpos, double ypos )
 {
 
-   // ignorar evento si no está pulsado el botón derecho
+   // ignorar evento si no está pulsado el botón derecho (salvo en la
+   // práctica 5, que resalta el objeto bajo el cursor)
    if ( glfwGetMouseButton( window, GLFW_MOUSE_BUTTON_RIGHT ) != GLFW_PRESS )
+   {
+      if ( practicaActual == 5 && P5_FGE_RatonMovido( int(xpos), int(ypos) ) )
+         redibujar_ventana = true ;
       return ;
+   }
 
    // invocar la función de la práctica 5
    if ( practicaActual == 5 )
@@ -551,7 +659,7 @@ void Inicializa_GLFW( int argc, char * argv[] )
 
    // crear la ventana
    glfw_window = glfwCreateWindow( ventana_tam_x, ventana_tam_y,
-                    "Practicas IG GIM (18-19)", nullptr, nullptr );
+                    titulo_ventana, nullptr, nullptr );
 
    if ( glfw_window == nullptr )
    {
@@ -668,20 +776,8 @@ void Inicializar( int argc, char *argv[] )
    // opengl: define proyección y atributos iniciales
    Inicializa_OpenGL() ;
 
-   // inicializar práctica 1.
-   P1_Inicializar(  ) ;
-
-   // inicializar práctica 2.
-   P2_Inicializar(  ) ;
-
-   // inicializar la práctica 3
-   P3_Inicializar(  );
-
-   // inicializar la práctica 4
-   P4_Inicializar(  );
-
-   // inicializar la práctica 5
-   P5_Inicializar( ventana_tam_x, ventana_tam_y );
+   // inicializar la práctica actual (las demás se crean al pasar a ellas)
+   InicializarPractica( practicaActual );
 }
 
 // ---------------------------------------------------------------------
@@ -701,6 +797,10 @@ void BucleEventosGLFW()
 
    while ( ! terminar_programa  )
    {
+      if ( CargaDiferida_HayNuevas() )  // alguna malla se ha terminado de construir en segundo plano
+         redibujar_ventana = true ;
+      if ( practicaActual == 5 && P5_RedibujarResaltado() ) // la lectura del objeto bajo el cursor no había terminado
+         redibujar_ventana = true ;
       if ( redibujar_ventana )   // si ha cambiado algo:
       {
          VisualizarFrame();            // dibujar la escena
@@ -716,6 +816,10 @@ void BucleEventosGLFW()
       terminar_programa = terminar_programa || glfwWindowShouldClose( glfw_window ) ;
    }
 
+   // la escena tiene VBOs y texturas: se destruye mientras el contexto de
+   // OpenGL existe (no en el destructor de 'arenaEscena', tras 'glfwTerminate')
+   DestruirPractica( practicaActual );
+   CargaDiferida_Terminar();
    glfwTerminate();
 }
 
@@ -104,6 +104,9 @@ class Textura
    // activar una textura, por ahora en el cauce fijo
    void activar(  ) ;
 
+   // modo de generación de coordenadas de textura
+   ModoGenCT leerModoGenCT() const ;
+
    protected: //--------------------------------------------------------
 
    void enviar() ;    // envia la imagen a la GPU (gluBuild2DMipmaps)
@@ -155,7 +158,11 @@ class Material
    Material( const std::string & nombreArchivoJPG ) ;
 
    // libera la memoria dinámica ocupada por el material
-   ~Material() ;
+   virtual ~Material() ;
+
+   // los materiales se crean en la arena activa, si la hay (ver Arena.hpp)
+   static void * operator new( std::size_t tam ) ;
+   static void   operator delete( void * p ) ;
 
    // crea un material usando textura y coeficientes: ka,kd,ks
    // (la textura puede ser NULL, la ilum. queda activada)
@@ -325,7 +332,10 @@ class ColFuentesLuz
 {
    public:
    ColFuentesLuz() ; // crea la colección vacía
-   ~ColFuentesLuz() ;
+   virtual ~ColFuentesLuz() ;
+   // se crean en la arena activa, si la hay (las fuentes, en el montón)
+   static void * operator new( std::size_t tam ) ;
+   static void   operator delete( void * p ) ;
    void insertar( FuenteLuz * pf ) ; // inserta una nueva
    void activar( unsigned id_prog ); // activa las fuentes de luz
    void activarTodas();
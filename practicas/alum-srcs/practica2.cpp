@@ -13,13 +13,15 @@
 #include "Objeto3D.hpp"
 #include "MallaPLY.hpp"
 #include "MallaRevol.hpp"
+#include "CargaDiferida.hpp"
+#include "NodoLOD.hpp"
 
 using namespace std ;
 
-static unsigned objetoActivo2 = 0 ; // objeto activo: malla ply (0), malla revol (1)
-static constexpr int numObjetos2 = 2 ;
+static unsigned objetoActivo2 = 0 ; // objeto activo: malla ply (0), malla revol (1), coche (2)
+static constexpr int numObjetos2 = 3 ;
 
-static Objeto3D * objetos2[numObjetos2] = { nullptr, nullptr };
+static Objeto3D * objetos2[numObjetos2] = { nullptr, nullptr, nullptr };
 
 // ---------------------------------------------------------------------
 // Función para implementar en la práctica 1 para inicialización.
@@ -29,9 +31,18 @@ static Objeto3D * objetos2[numObjetos2] = { nullptr, nullptr };
 void P2_Inicializar(  )
 {
    cout << "Creando objetos de la práctica 2 .... " << endl << flush ;
-   objetos2[0] = new MallaPLY("../plys/beethoven.ply");
+   // los PLY se leen en segundo plano, mientras tanto se ve su caja.
+   // Se optimizan para la caché de vértices y se visualizan con niveles de
+   // detalle (NodoLOD.hpp), también construidos en segundo plano. Beethoven
+   // se guarda con disposición SoA (ver MallaInd::fijarDisposicion)
+   objetos2[0] = new MallaDiferida("../plys/beethoven.ply",
+                    []{ MallaPLY * malla = new MallaPLY("../plys/beethoven.ply",true);
+                        malla->fijarDisposicion(DisposicionMalla::soa);
+                        return new NodoLOD(malla); });
    //objetos2[1] = new MallaPLY("../plys/newplys/esfera.ply");
    objetos2[1] = new Esfera(3,3,false,true);
+   objetos2[2] = new MallaDiferida("../plys/big_dodge.ply",
+                    []{ return new NodoLOD(new MallaPLY("../plys/big_dodge.ply",true)); });
    cout << "hecho." << endl << flush ;
 }
 
@@ -13,6 +13,9 @@
 #include "CamaraInter.hpp"
 #include "grafo-escena.hpp"
 #include "materiales.hpp"
+#include "SeleccionRayo.hpp"
+#include "BufferSeleccion.hpp"
+#include <chrono>
 
 using namespace std ;
 
@@ -24,6 +27,21 @@ using namespace std ;
 static Objeto3D* objetoActivo5 = nullptr ;
 static ColFuentesLuz *luces = nullptr;
 
+//Selección: con un rayo en la CPU (true) o visualizando con colores (false)
+static SeleccionRayo * seleccion = nullptr ;
+static bool seleccionRayo = true ;
+//identificadores de la región alrededor del cursor (visualizando con colores)
+static BufferSeleccion * bufferSeleccion = nullptr ;
+//Selección con un rectángulo (arrastrando con el botón izquierdo)
+static bool seleccionRectangulo = false ;
+static int xini_rect = 0, yini_rect = 0 ; // esquina donde se pulsó el botón
+
+//Resaltado del objeto bajo el cursor
+static bool resaltar = true ;
+static int identResaltado = 0 ;
+static int xcursor = -1, ycursor = -1 ; // posición del cursor (-1 si no se conoce)
+static bool redibujarResaltado = false ; // la lectura del objeto bajo el cursor no había terminado
+
 //Camaras
 static int camActiva;
 static const int numCamaras = 3;
@@ -49,20 +67,31 @@ void P5_Inicializar(  int vp_ancho, int vp_alto )
    // inicializar las variables de la práctica 5 (incluyendo el viewport)
    viewport = Viewport(0.0,0.0, vp_ancho, vp_alto);
    float radio = (float) vp_alto/vp_ancho;
+   // las cámaras no están en la arena de la escena: se destruyen las de la
+   // vez anterior que se inicializó la práctica, si la hay
+   for( int i = 0 ; i < numCamaras ; i++ )
+      delete camaras[i] ;
    camaras[0] = new CamaraInteractiva(false, radio, 0, 0, {0.0,0.0,0.0},true, 80.0,2);
    camaras[1] = new CamaraInteractiva(false, radio, 90, 0, {0.0,0.0,0.0}, true,80.0,2);
    camaras[2] = new CamaraInteractiva(false, radio, 0, -90, {0.0,0.0,0.0}, false,80.0,2);
    camActiva = 0;
 
    luces = new ColeccionFuentesP4();
-   objetoActivo5 = new EscenaObjetosLuces();
+   NodoGrafoEscena * escena = new EscenaObjetosLuces();
+   objetoActivo5 = escena;
+   // (como las cámaras, no está en la arena)
+   delete seleccion ;
+   seleccion = new SeleccionRayo( escena );
+   delete bufferSeleccion ;
+   bufferSeleccion = new BufferSeleccion();
+   identResaltado = 0 ;
 
 
    cout << "hecho." << endl << flush ;
 }
 // ---------------------------------------------------------------------
 
-void P5_FijarMVPOpenGL( int vp_ancho, int vp_alto )
+void P5_FijarMVPOpenGL( int vp_ancho, int vp_alto, ContextoVis & cv )
 {
    // actualizar viewport, actualizar y activar la camara actual
    // (en base a las dimensiones del viewport)
@@ -73,23 +102,49 @@ void P5_FijarMVPOpenGL( int vp_ancho, int vp_alto )
    camaras[camActiva]->calcularViewfrustum();
    camaras[camActiva]->activar();
 
+   // pirámide de visión de la cámara, para no visitar lo que queda fuera
+   cv.piramideVision = PiramideVision( camaras[camActiva]->vf, camaras[camActiva]->mcv );
 
 }
 // ---------------------------------------------------------------------
 
 void P5_DibujarObjetos( ContextoVis & cv )
 {
+   // objeto bajo el cursor: la región se pidió al mover el ratón. Si la
+   // lectura no ha terminado no se espera: se resalta el objeto anterior y
+   // se despierta al bucle de eventos para volver a dibujar (y a leer)
+   if(resaltar && !seleccionRayo && xcursor >= 0){
+     int id;
+     if(bufferSeleccion->leer(xcursor, ycursor, false, id))
+       identResaltado = id;
+     else if(bufferSeleccion->lecturaPendiente()){
+       redibujarResaltado = true;
+       glfwPostEmptyEvent();
+     }
+   }
 
    // activar las fuentes de luz y visualizar la escena
    //      (se supone que la camara actual ya está activada)
    glEnable(GL_LIGHTING);
   luces->activarTodas();
    if(objetoActivo5!=nullptr){
+     cv.identResaltado = resaltar ? identResaltado : 0;
      objetoActivo5->visualizarGL(cv);
+     cv.identResaltado = 0;
    }
    glDisable(GL_LIGHTING);
 }
 
+// ---------------------------------------------------------------------
+// true (una vez) si hay que volver a dibujar para leer el objeto bajo el cursor
+
+bool P5_RedibujarResaltado()
+{
+   const bool result = redibujarResaltado ;
+   redibujarResaltado = false ;
+   return result ;
+}
+
 // ---------------------------------------------------------------------
 
 bool P5_FGE_PulsarTeclaCaracter(  unsigned char tecla ){
@@ -127,6 +182,21 @@ bool P5_FGE_PulsarTeclaCaracter(  unsigned char tecla ){
          cout << "Desplazamiento en Z de la cámara actual (negativo)" << endl;
          break;
 
+      case 'R':
+         seleccionRayo = !seleccionRayo;
+         cout << "Selección cambiada a: " << (seleccionRayo ? "rayo en la CPU" : "visualizar en modo selección") << endl;
+         break;
+
+      case 'H':
+         resaltar = !resaltar;
+         cout << "Resaltado del objeto bajo el cursor: " << (resaltar ? "activado" : "desactivado") << endl;
+         break;
+
+      case 'B':
+         seleccionRectangulo = !seleccionRectangulo;
+         cout << "Selección con rectángulo: " << (seleccionRectangulo ? "activada" : "desactivada") << endl;
+         break;
+
       default:
          result = false ;
          break ;
@@ -175,23 +245,30 @@ bool P5_FGE_PulsarTeclaEspecial(  int tecla  )
 
 void P5_ClickIzquierdo( int x, int y )
 {
-   //  visualizar escena en modo selección y leer el color del pixel en (x,y)
-   // 1. crear un 'contextovis' apropiado
-   ContextoVis cv;
-   cv.modoSeleccionFBO = true;
-   cv.modoVis = modoSolido;
-
-   // 2. visualizar en modo selección (sobre el backbuffer)
-   glClearColor(0,0,0,1); //color de fondo
-   glDisable(GL_LIGHTING);
-   glDisable(GL_TEXTURE_2D);
-
-   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //limpiar pantalla
-
-   objetoActivo5->visualizarGL(cv);
-   // 3. leer el color del pixel, si es 0 no se hace nada
+   unsigned id ;
    cout << "x: " << x << "y: "<< y << endl;
-   unsigned id = LeerIdentEnPixel(x,y);
+   if(seleccionRayo){
+     // cortar el rayo de la cámara activa que pasa por el pixel (x,y) con
+     // la escena, sin visualizarla (ver SeleccionRayo.hpp)
+     const auto t_inicio = std::chrono::steady_clock::now();
+     const Rayo rayo = camaras[camActiva]->rayoPixel(viewport, x, y);
+     id = seleccion->identificadorEnRayo(rayo);
+     cout << "selección con rayo en "
+          << std::chrono::duration<double,std::milli>( std::chrono::steady_clock::now() - t_inicio ).count()
+          << " ms" << endl;
+   }
+   else{
+     // visualizar en modo selección la región alrededor de (x,y) (si no se
+     // ha hecho ya con la misma cámara y escena) y leer el color del pixel
+     const auto t_inicio = std::chrono::steady_clock::now();
+     const bool visualizada = bufferSeleccion->solicitar(objetoActivo5, *camaras[camActiva], viewport, x, y);
+     int ident = 0;
+     bufferSeleccion->leer(x, y, true, ident);
+     id = ident;
+     cout << "selección en la región " << (visualizada ? "visualizada" : "guardada") << " en "
+          << std::chrono::duration<double,std::milli>( std::chrono::steady_clock::now() - t_inicio ).count()
+          << " ms" << endl;
+   }
    cout << "id :" << id << endl;
 
    if(id==0){
@@ -212,6 +289,42 @@ void P5_ClickIzquierdo( int x, int y )
    }
 
 
+}
+// ---------------------------------------------------------------------
+// se llama al levantar el botón izquierdo en modo rectángulo: visualiza en
+// modo selección el rectángulo entre (xini_rect,yini_rect) y (x,y), lo lee
+// de una vez, cuenta los pixels de cada identificador y busca todos los
+// objetos en un solo recorrido del grafo
+
+void P5_SeleccionRectangulo( int x, int y )
+{
+   const auto t_inicio = std::chrono::steady_clock::now();
+   bufferSeleccion->solicitarRectangulo(objetoActivo5, *camaras[camActiva], viewport, xini_rect, yini_rect, x, y);
+   std::vector< std::pair<int,unsigned> > cuenta;
+   bufferSeleccion->histograma(xini_rect, yini_rect, x, y, true, cuenta);
+
+   std::vector<int> idents(cuenta.size());
+   for(unsigned i=0; i<cuenta.size(); i++)
+     idents[i] = cuenta[i].first;
+   std::vector<Objeto3D *> objetos(idents.size(), nullptr);
+   std::vector<Tupla3f> centros(idents.size());
+   unsigned pendientes = idents.size();
+   objetoActivo5->buscarObjetos(idents, MAT_Ident(), objetos, centros, pendientes);
+
+   unsigned pixels = 0;
+   for(unsigned i=0; i<cuenta.size(); i++)
+     pixels += cuenta[i].second;
+   cout << "Seleccionados " << idents.size()-pendientes << " objetos ("
+        << idents.size() << " identificadores, " << pixels << " pixels) en "
+        << std::chrono::duration<double,std::milli>( std::chrono::steady_clock::now() - t_inicio ).count()
+        << " ms" << endl;
+
+   const unsigned max_lineas = 10;
+   for(unsigned i=0; i<objetos.size() && i<max_lineas; i++)
+     if(objetos[i] != nullptr)
+       cout << "   " << idents[i] << ": " << objetos[i]->leerNombre() << " (" << cuenta[i].second << " pixels)" << endl;
+   if(objetos.size() > max_lineas)
+     cout << "   ..." << endl;
 }
 // ---------------------------------------------------------------------
 // se llama al mover el botón en modo arrastrar
@@ -251,7 +364,13 @@ void P5_RatonArrastradoHasta( int x, int y )
 bool P5_FGE_ClickRaton( int boton, int estado, int x, int y )
 {
    //cout << "P5_FGE_ClickRaton" << endl ;
-   if ( estado == GLFW_PRESS && boton == GLFW_MOUSE_BUTTON_LEFT  )
+   if ( estado == GLFW_PRESS && boton == GLFW_MOUSE_BUTTON_LEFT && seleccionRectangulo )
+   {  xini_rect = x ;
+      yini_rect = viewport.alto-y ;
+   }
+   else if ( estado == GLFW_RELEASE && boton == GLFW_MOUSE_BUTTON_LEFT && seleccionRectangulo )
+      P5_SeleccionRectangulo( x, viewport.alto-y );
+   else if ( estado == GLFW_PRESS && boton == GLFW_MOUSE_BUTTON_LEFT  )
       P5_ClickIzquierdo( x, viewport.alto-y );
    else if ( estado == GLFW_PRESS && boton == GLFW_MOUSE_BUTTON_RIGHT )
       P5_InicioModoArrastrar( x, viewport.alto-y );
@@ -275,6 +394,37 @@ bool P5_FGE_RatonMovidoPulsado( int x, int y )
 }
 // ---------------------------------------------------------------------
 
+// se llama al mover el ratón sin el botón derecho pulsado: busca el objeto
+// bajo el cursor, para resaltarlo
+
+bool P5_FGE_RatonMovido( int x, int y )
+{
+   if ( ! resaltar )
+      return false ;
+   xcursor = x ;
+   ycursor = viewport.alto-y ;
+
+   if ( seleccionRayo )
+   {
+      const int id = seleccion->identificadorEnRayo( camaras[camActiva]->rayoPixel( viewport, xcursor, ycursor ) );
+      const bool cambia = id != identResaltado ;
+      identResaltado = id ;
+      return cambia ;
+   }
+   // si la región guardada vale se lee ya; si no, se pide y se lee al
+   // dibujar el siguiente cuadro
+   if ( ! bufferSeleccion->solicitar( objetoActivo5, *camaras[camActiva], viewport, xcursor, ycursor ) )
+   {
+      int id = 0 ;
+      bufferSeleccion->leer( xcursor, ycursor, false, id );
+      const bool cambia = id != identResaltado ;
+      identResaltado = id ;
+      return cambia ;
+   }
+   return true ;
+}
+// ---------------------------------------------------------------------
+
 bool P5_FGE_Scroll( int direction )
 {
    // COMPLETAR: práctica 5: acercar/alejar la camara (desplaZ)
@@ -13,6 +13,8 @@
 #include "materiales.hpp"
 #include "cauce.hpp"
 #include "Parametro.hpp"
+#include "matrices-tr.hpp"
+#include "PiramideVision.hpp"
 
 // --------------------------------------------------------------------
 // declaraciones adelantadas de clases (útiles para punteros)
@@ -60,8 +62,23 @@ class ContextoVis
    bool           modoSeleccionRB ;  // true -> dibujando en modo selección usando render buffer de opengl
    bool           modoVBO;           // true -> dibujando en modo diferido
    int            identAct ;         // identificador actual en modo seleccion (nunca -1, >=0), inicialmente 0 antes de raiz
+   int            identResaltado ;   // identificador de los objetos a resaltar (0 si no hay)
    PilaMateriales pilaMateriales ;   // pila de materiales
    ColFuentesLuz * colFuentes ;      // colección de fuentes de luz activa
+   unsigned long  numTriangulos ;    // triángulos dibujados en el cuadro actual (lo pone a 0 el main)
+
+   // recortado con la pirámide de visión (ver PiramideVision.hpp)
+   bool           recortarVista ;    // true -> no visitar los sub-objetos fuera de la pirámide de visión
+   PiramideVision piramideVision ;   // pirámide de la cámara actual (en coords. de mundo)
+   Matriz4f       matrizModelado ;   // coords. del objeto actual --> coords. de mundo (la actualizan los nodos)
+   unsigned       planosRecorte ;    // planos de la pirámide que todavía cortan al objeto actual
+   unsigned long  numNodosVisitados, // nodos del grafo de escena recorridos en el cuadro actual
+                  numNodosDescartados, // sub-objetos no visitados por estar fuera de la pirámide
+                  numNodosDibujados ;  // mallas dibujadas en el cuadro actual
+
+   // cola de visualización (ver ColaVisualizacion.hpp)
+   bool           usarColaVis ;      // true -> los nodos raíz se visualizan con su cola de visualización
+   bool           dibujandoCola ;    // true -> se está visualizando una cola (los nodos no usan la suya)
 
    ContextoVis()
    {
@@ -71,8 +88,16 @@ class ContextoVis
       usarShader       = false ;
       modoSeleccionRB  = false ;
       modoSeleccionFBO = false ;
+      identResaltado   = 0 ;
       colFuentes       = nullptr ;
       modoVBO          = false;
+      numTriangulos    = 0 ;
+      recortarVista    = true ;
+      matrizModelado   = MAT_Ident() ;
+      planosRecorte    = todos_los_planos ;
+      numNodosVisitados = numNodosDescartados = numNodosDibujados = 0 ;
+      usarColaVis      = true ;
+      dibujandoCola    = false ;
    }
 
 };
@@ -0,0 +1,117 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: ACMR de los plys antes y después de reordenar las caras
+// **
+// *********************************************************************
+
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include "comun.hpp"
+#include "OptimizarMalla.hpp"
+#include "file_ply_stl.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// nombres de los archivos '.ply' de una carpeta, ordenados
+
+static vector<string> ArchivosPLY( const string & carpeta )
+{
+   vector<string> nombres ;
+   DIR * dir = opendir( carpeta.c_str() );
+   if ( dir == nullptr )
+      return nombres ;
+   while( const dirent * e = readdir( dir ) )
+   {  const string n = e->d_name ;
+      if ( n.size() > 4 && n.compare( n.size()-4, 4, ".ply" ) == 0 )
+         nombres.push_back( carpeta + "/" + n );
+   }
+   closedir( dir );
+   sort( nombres.begin(), nombres.end() );
+   return nombres ;
+}
+// -----------------------------------------------------------------------------
+// true si la cabecera del ply declara caras (los perfiles de las mallas de
+// revolución solo tienen vértices, y 'ply::read' termina el programa)
+
+static bool TieneCaras( const string & nombre )
+{
+   ifstream f( nombre );
+   string linea ;
+   while( getline( f, linea ) && linea.compare( 0, 10, "end_header" ) != 0 )
+      if ( linea.compare( 0, 13, "element face " ) == 0 )
+         return atoi( linea.c_str()+13 ) > 0 ;
+   return false ;
+}
+// -----------------------------------------------------------------------------
+// true si las dos tablas tienen las mismas caras, salvo el orden de las
+// caras y la rotación de sus índices (la reordenación no cambia nada más)
+
+static bool MismasCaras( const vector<Tupla3i> & a, const vector<Tupla3i> & b )
+{
+   // cada cara como tres enteros, rotada para que empiece por el menor índice
+   auto normalizar = []( const vector<Tupla3i> & caras )
+   {  vector<int> r ;
+      for( Tupla3i c : caras )
+      {  while( c(0) > c(1) || c(0) > c(2) )
+            c = Tupla3i( c(1), c(2), c(0) );
+         r.insert( r.end(), { c(0), c(1), c(2) } );
+      }
+      vector<unsigned> orden( caras.size() );
+      for( unsigned i = 0 ; i < orden.size() ; i++ )
+         orden[i] = i ;
+      sort( orden.begin(), orden.end(), [&]( unsigned i, unsigned j )
+      {  return lexicographical_compare( &r[3*i], &r[3*i+3], &r[3*j], &r[3*j+3] );
+      });
+      vector<int> ordenadas ;
+      for( const unsigned i : orden )
+         ordenadas.insert( ordenadas.end(), &r[3*i], &r[3*i+3] );
+      return ordenadas ;
+   };
+   return normalizar( a ) == normalizar( b );
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "ACMR de los plys de '../plys' con cachés FIFO de 16 y 32 vértices, antes y después de OptMalla_ReordenarCaras" );
+
+   vector<string> plys = ArchivosPLY( "../plys" ), nuevos = ArchivosPLY( "../plys/newplys" );
+   plys.insert( plys.end(), nuevos.begin(), nuevos.end() );
+   bool mismas_caras = ! plys.empty() ;
+
+   cout << left << setw( 28 ) << "ply" << right << setw( 7 ) << "caras"
+        << setw( 16 ) << "ACMR 16" << setw( 16 ) << "ACMR 32" << setw( 12 ) << "tiempo" << endl
+        << fixed << setprecision( 3 );
+
+   for( const string & ply_nombre : plys )
+   {
+      if ( ! TieneCaras( ply_nombre ) )
+      {  cout << left << setw( 28 ) << ply_nombre.substr( 8 ) << " (perfil, sin caras)" << endl ;
+         continue ;
+      }
+      vector<float> ver ;
+      vector<int>   ind ;
+      ply::read( ply_nombre.c_str(), ver, ind );
+      const unsigned nv = ver.size()/3 ;
+      vector<Tupla3i> caras ;
+      for( unsigned i = 0 ; i+2 < ind.size() ; i += 3 )
+         caras.push_back( Tupla3i( ind[i], ind[i+1], ind[i+2] ) );
+
+      vector<Tupla3i> opt ;
+      const double ms = MedirMs( [&](){ opt = caras ; OptMalla_ReordenarCaras( opt, nv ); } );
+      mismas_caras = mismas_caras && MismasCaras( opt, caras );
+
+      cout << left << setw( 28 ) << ply_nombre.substr( 8 ) << right << setw( 7 ) << caras.size()
+           << setw( 7 ) << OptMalla_ACMR( caras, nv, 16 ) << " -> " << setw( 5 ) << OptMalla_ACMR( opt, nv, 16 )
+           << setw( 7 ) << OptMalla_ACMR( caras, nv, 32 ) << " -> " << setw( 5 ) << OptMalla_ACMR( opt, nv, 32 )
+           << setw( 9 ) << ms << " ms" << endl ;
+   }
+   cout << "caras reordenadas " << (mismas_caras ? "iguales" : "DISTINTAS") << " a las originales (salvo el orden)" << endl ;
+   return mismas_caras ? 0 : 1 ;
+}
@@ -0,0 +1,169 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: coste por llamada de dibujo de una malla pequeña (MallaInd)
+// **
+// *********************************************************************
+
+#include <iostream>
+#include "comun.hpp"
+#include "practicas.hpp"
+
+using namespace std ;
+
+// llamadas de dibujo en cada medida
+static const unsigned num_llamadas = 20000 ;
+
+// -----------------------------------------------------------------------------
+// rejilla pequeña con normales, colores y coordenadas de textura (todos los
+// atributos que puede tener el VBO entrelazado)
+
+class MallaDibujo : public MallaRejilla
+{
+   public:
+      MallaDibujo( const unsigned n )
+      :  MallaRejilla( n )
+      {
+         normales();
+         fijarColorNodo( Tupla3f( 0.8, 0.5, 0.2 ) );
+         for( const Tupla3f & v : vertices )
+            cctt.push_back( Tupla2f( v(0)/n, v(1)/n ) );
+      }
+
+      // quita el VAO (una vez creados los VBOs), así se visualiza como sin
+      // soporte de VAOs: activando los punteros en cada llamada
+      void quitarVAO()
+      {  if ( id_vao != 0 )
+         {  glDeleteVertexArrays( 1, &id_vao );
+            id_vao = 0 ;
+         }
+      }
+} ;
+
+// -----------------------------------------------------------------------------
+// la forma de visualizar con VBOs anterior al VBO entrelazado: un VBO por
+// atributo, y en cada llamada se enlazan y se fijan los cuatro punteros
+
+class VBOsSeparados
+{
+   public:
+      VBOsSeparados( const MallaDibujo & m )
+      {
+         const vector<Tupla3f> & ver = m.leerVertices();
+         vector<Tupla3f> nor, col ;
+         vector<Tupla2f> cct ;
+         for( unsigned i = 0 ; i < ver.size() ; i++ )
+         {  nor.push_back( m.leerNormal( i ) );
+            col.push_back( m.leerColor( i ) );
+            cct.push_back( Tupla2f( ver[i](0), ver[i](1) ) );
+         }
+         num_ind = 3*m.leerCaras().size();
+         id_ver  = Crear( GL_ARRAY_BUFFER, ver.size()*sizeof(Tupla3f), ver.data() );
+         id_nor  = Crear( GL_ARRAY_BUFFER, nor.size()*sizeof(Tupla3f), nor.data() );
+         id_col  = Crear( GL_ARRAY_BUFFER, col.size()*sizeof(Tupla3f), col.data() );
+         id_cct  = Crear( GL_ARRAY_BUFFER, cct.size()*sizeof(Tupla2f), cct.data() );
+         id_tri  = Crear( GL_ELEMENT_ARRAY_BUFFER, num_ind*sizeof(int), m.leerCaras().data() );
+      }
+      ~VBOsSeparados()
+      {  const GLuint ids[5] = { id_ver, id_nor, id_col, id_cct, id_tri };
+         glDeleteBuffers( 5, ids );
+      }
+      void visualizar()
+      {
+         glBindBuffer( GL_ARRAY_BUFFER, id_ver );
+         glVertexPointer( 3, GL_FLOAT, 0, nullptr );
+         glEnableClientState( GL_VERTEX_ARRAY );
+         glBindBuffer( GL_ARRAY_BUFFER, id_nor );
+         glNormalPointer( GL_FLOAT, 0, nullptr );
+         glEnableClientState( GL_NORMAL_ARRAY );
+         glBindBuffer( GL_ARRAY_BUFFER, id_col );
+         glColorPointer( 3, GL_FLOAT, 0, nullptr );
+         glEnableClientState( GL_COLOR_ARRAY );
+         glBindBuffer( GL_ARRAY_BUFFER, id_cct );
+         glTexCoordPointer( 2, GL_FLOAT, 0, nullptr );
+         glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, id_tri );
+         glDrawElements( GL_TRIANGLES, num_ind, GL_UNSIGNED_INT, nullptr );
+         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+         glBindBuffer( GL_ARRAY_BUFFER, 0 );
+         glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+         glDisableClientState( GL_COLOR_ARRAY );
+         glDisableClientState( GL_NORMAL_ARRAY );
+         glDisableClientState( GL_VERTEX_ARRAY );
+      }
+   private:
+      static GLuint Crear( const GLenum tipo, const GLsizeiptr tam, const GLvoid * datos )
+      {  GLuint id ;
+         glGenBuffers( 1, &id );
+         glBindBuffer( tipo, id );
+         glBufferData( tipo, tam, datos, GL_STATIC_DRAW );
+         glBindBuffer( tipo, 0 );
+         return id ;
+      }
+      GLuint  id_ver, id_nor, id_col, id_cct, id_tri ;
+      GLsizei num_ind ;
+} ;
+
+// -----------------------------------------------------------------------------
+// microsegundos por llamada: se cuenta hasta que GL termina (glFinish), pero
+// la malla es pequeña y queda fuera de la vista (no se rasteriza nada), así
+// casi todo el tiempo es el de la CPU en cada llamada (validación del estado,
+// punteros, enlaces, transformación de los vértices)
+
+static double MicrosPorLlamada( const std::function<void()> & dibujar )
+{
+   dibujar(); // la primera vez se crean los VBOs
+   glFinish();
+   const double ms = MedirMs( [&]()
+   {  for( unsigned i = 0 ; i < num_llamadas ; i++ )
+         dibujar();
+      glFinish();
+   });
+   return 1000.0*ms/num_llamadas ;
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   CrearVentanaOculta( 64, 64 );
+   Titulo( "coste por llamada de dibujo de una malla de 128 triángulos (mejor de 5)" );
+   cout << "OpenGL: " << glGetString( GL_RENDERER ) << ", " << glGetString( GL_VERSION ) << endl ;
+
+   glMatrixMode( GL_PROJECTION );
+   glLoadIdentity();
+   glOrtho( 100.0, 109.0, 0.0, 9.0, -1.0, 1.0 ); // la rejilla va de 0 a 9 en X
+   glMatrixMode( GL_MODELVIEW );
+   glLoadIdentity();
+
+   ContextoVis cv ;
+   cv.modoVis = modoSolido ;
+
+   double t_separados ;
+   {  MallaDibujo    m( 9 );
+      VBOsSeparados vs( m );
+      t_separados = MicrosPorLlamada( [&](){ vs.visualizar(); } );
+   }
+   MallaDibujo m_mi( 9 ), m_vao( 9 ), m_sin_vao( 9 );
+   const double
+      t_mi      = MicrosPorLlamada( [&](){ cv.modoVBO = false ; m_mi.visualizarGL( cv ); } ),
+      t_vao     = MicrosPorLlamada( [&](){ cv.modoVBO = true ;  m_vao.visualizarGL( cv ); } );
+   cv.modoVBO = true ;
+   m_sin_vao.visualizarGL( cv );
+   m_sin_vao.quitarVAO();
+   const double
+      t_sin_vao = MicrosPorLlamada( [&](){ m_sin_vao.visualizarGL( cv ); } );
+
+   cout << "   modo inmediato (glDrawElements con arrays en memoria): " << t_mi << " us" << endl
+        << "   cuatro VBOs separados, punteros en cada llamada:        " << t_separados << " us" << endl
+        << "   VBO entrelazado, punteros en cada llamada (sin VAO):    " << t_sin_vao << " us" << endl
+        << "   VBO entrelazado con VAO (MallaInd):                     " << t_vao << " us (x"
+        << t_separados/t_vao << " frente a VBOs separados)" << endl ;
+
+   const GLenum error = glGetError();
+   if ( error != GL_NO_ERROR )
+      cout << "error de OpenGL: " << gluErrorString( error ) << endl ;
+
+   glfwTerminate(); // destruye también la ventana
+   return error == GL_NO_ERROR ? 0 : 1 ;
+}
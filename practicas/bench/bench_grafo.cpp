@@ -0,0 +1,126 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: recorridos de un grafo de escena profundo generado
+// **
+// *********************************************************************
+
+#include <memory>
+#include <sstream>
+#include <iostream>
+#include "comun.hpp"
+#include "practicas.hpp"
+#include "grafo-escena.hpp"
+#include "matrices-tr.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// genera un árbol binario de nodos de 'profundidad' niveles: cada nodo tiene
+// una traslación, una rotación, el primer hijo, un escalado y el segundo
+// hijo (tres matrices por nodo). Las hojas son todas la misma malla. Cada
+// nodo tiene un identificador distinto (1, 2, ... en preorden). Entre nodo y
+// nodo se reservan bloques de tamaño variable que no se liberan, para que
+// los nodos no queden seguidos en memoria, como en una escena real
+
+static NodoGrafoEscena * Generar( const unsigned profundidad, MallaInd * hoja,
+                                  vector<NodoGrafoEscena *> & nodos,
+                                  vector<unique_ptr<char[]>> & ruido )
+{
+   NodoGrafoEscena * nodo = new NodoGrafoEscena();
+   nodo->ponerIdentificador( nodos.size()+1 );
+   nodos.push_back( nodo );
+   ruido.push_back( unique_ptr<char[]>( new char[ 64 + 48*(nodos.size()%7) ] ) );
+
+   const float a = 0.5f*float( nodos.size()%11 );
+   nodo->agregar( MAT_Traslacion( 0.1, 0.2, 0.0 ) );
+   nodo->agregar( MAT_Rotacion( a, 0.0, 1.0, 0.0 ) );
+   nodo->agregar( profundidad > 1 ? Generar( profundidad-1, hoja, nodos, ruido ) : (Objeto3D *) hoja );
+   nodo->agregar( MAT_Escalado( 0.9, 0.9, 0.9 ) );
+   nodo->agregar( profundidad > 1 ? Generar( profundidad-1, hoja, nodos, ruido ) : (Objeto3D *) hoja );
+   return nodo ;
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   CrearVentanaOculta( 64, 64 );
+   Titulo( "recorridos de un árbol binario de nodos generado (mejor de 5)" );
+
+   // la escena queda fuera de la vista: se mide el recorrido, no el rasterizado
+   glMatrixMode( GL_PROJECTION );
+   glLoadIdentity();
+   glOrtho( 1000.0, 1001.0, 0.0, 1.0, -1.0, 1.0 );
+   glMatrixMode( GL_MODELVIEW );
+   glLoadIdentity();
+
+   const unsigned profundidades[] = { 10, 13, 15 };
+   bool encontrados = true ;
+
+   for( const unsigned prof : profundidades )
+   {
+      vector<NodoGrafoEscena *>  nodos ;
+      vector<unique_ptr<char[]>> ruido ;
+      MallaInd *        hoja ;
+      NodoGrafoEscena * raiz ;
+      {  // sin los mensajes de 'ponerIdentificador' (uno por nodo)
+         ostringstream descarte ;
+         streambuf * anterior = cout.rdbuf( descarte.rdbuf() );
+         hoja = new Cubo();
+         raiz = Generar( prof, hoja, nodos, ruido );
+         cout.rdbuf( anterior );
+      }
+      unsigned num_matrices = 3*nodos.size();
+
+      ContextoVis cv ;
+      cv.modoVis       = modoSolido ;
+      cv.modoVBO       = true ;
+      cv.recortarVista = false ;
+
+      // visualización recorriendo el grafo, y con la cola de visualización
+      // (la primera vez se construye la cola)
+      cv.usarColaVis = false ;
+      const double t_grafo = MedirMs( [&](){ raiz->visualizarGL( cv ); glFinish(); } );
+      cv.usarColaVis = true ;
+      raiz->visualizarGL( cv );
+      const double t_cola  = MedirMs( [&](){ raiz->visualizarGL( cv ); glFinish(); } );
+
+      // caja englobante de todo el grafo, con todas las matrices cambiadas
+      const double t_caja = MedirMs( [&]()
+      {  for( NodoGrafoEscena * n : nodos )
+            n->invalidarMatrices();
+         raiz->cajaEnglobante();
+      });
+      const double t_invalidar = MedirMs( [&]()
+      {  for( NodoGrafoEscena * n : nodos )
+            n->invalidarMatrices();
+      });
+
+      // búsqueda del último nodo (el más a la derecha): recorriendo el grafo
+      // y con el índice de identificadores
+      Objeto3D * obj = nullptr ;
+      Tupla3f    centro ;
+      const int  ultimo = nodos.size();
+      const double t_buscar = MedirMs( [&]()
+      {  encontrados = raiz->buscarObjeto( ultimo, MAT_Ident(), &obj, centro ) && encontrados ;
+      });
+      encontrados = encontrados && obj == nodos.back() ;
+      raiz->indexarIdentificadores();
+      obj = nullptr ;
+      const double t_buscar_ind = 1000.0*MedirMs( [&]()
+      {  encontrados = raiz->buscarObjeto( ultimo, MAT_Ident(), &obj, centro ) && encontrados ;
+      });
+      encontrados = encontrados && obj == nodos.back() ;
+
+      cout << endl << "profundidad " << prof << ": " << nodos.size() << " nodos, "
+           << num_matrices << " matrices, " << (1UL << prof) << " hojas" << endl
+           << "   visualizar recorriendo el grafo:        " << t_grafo << " ms" << endl
+           << "   visualizar con la cola:                 " << t_cola << " ms" << endl
+           << "   caja englobante (todo invalidado):      " << t_caja - t_invalidar << " ms" << endl
+           << "   buscarObjeto del último nodo, recorrido: " << t_buscar << " ms" << endl
+           << "   buscarObjeto del último nodo, índice:    " << t_buscar_ind << " us" << endl ;
+   }
+   cout << endl << "nodos buscados " << (encontrados ? "encontrados" : "NO ENCONTRADOS") << endl ;
+   return encontrados ? 0 : 1 ;
+}
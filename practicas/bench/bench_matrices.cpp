@@ -0,0 +1,133 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: productos de Matriz4f genéricos y con SSE
+// **
+// *********************************************************************
+
+#include <cstring>
+#include <random>
+#include <iostream>
+#include "comun.hpp"
+#include "matrizg.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// las versiones genéricas de 'matrizg_impl.hpp' (las de MatrizCG<T,n>, que
+// para float y n=4 se sustituyen por las de SSE), copiadas aquí para medirlas
+
+static Matriz4f ProductoGenerico( const Matriz4f & a, const Matriz4f & b )
+{
+   Matriz4f res ;
+   for( unsigned fil = 0 ; fil < 4 ; fil++ )
+   for( unsigned col = 0 ; col < 4 ; col++ )
+   {  res(fil,col) = 0.0f ;
+      for( unsigned k = 0 ; k < 4 ; k++ )
+         res(fil,col) += a(fil,k)*b(k,col) ;
+   }
+   return res ;
+}
+
+static Tupla4f ProductoGenerico( const Matriz4f & a, const Tupla4f & t )
+{
+   Tupla4f res ;
+   for( unsigned fil = 0 ; fil < 4 ; fil++ )
+   {  res[fil] = 0.0 ;
+      for( unsigned col = 0 ; col < 4 ; col++ )
+         res(fil) += a(fil,col) * t(col) ;
+   }
+   return res ;
+}
+
+static Tupla3f ProductoGenerico( const Matriz4f & a, const Tupla3f & t )
+{
+   const Tupla4f res1 = ProductoGenerico( a, Tupla4f( t(0), t(1), t(2), 1.0f ) );
+   return Tupla3f( res1(0), res1(1), res1(2) );
+}
+
+// -----------------------------------------------------------------------------
+// compara bit a bit (así +0 y -0 son distintos)
+
+template< class T > static bool MismosBits( const vector<T> & a, const vector<T> & b )
+{
+   return a.size() == b.size() && memcmp( a.data(), b.data(), a.size()*sizeof(T) ) == 0 ;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "productos de Matriz4f: genéricos frente a SSE (mejor de 5)" );
+#ifndef __SSE__
+   cout << "(compilado sin SSE: las dos versiones son la genérica)" << endl ;
+#endif
+
+   // valores al azar, con ceros de los dos signos (así hay productos y
+   // sumas que dan -0)
+   const unsigned n = 1 << 16, veces = 32 ;
+   mt19937 gen( 1 );
+   uniform_real_distribution<float> valor( -2.0f, 2.0f );
+   uniform_int_distribution<int>    tipo( 0, 5 );
+   auto dato = [&]()
+   {  const int t = tipo( gen );
+      return t == 0 ? 0.0f : ( t == 1 ? -0.0f : valor( gen ) );
+   };
+
+   vector<Matriz4f> ma( n ), mb( n );
+   vector<Tupla4f>  t4( n );
+   vector<Tupla3f>  t3( n );
+   for( unsigned i = 0 ; i < n ; i++ )
+   {  float * pa = ma[i], * pb = mb[i] ;
+      for( unsigned j = 0 ; j < 16 ; j++ )
+      {  pa[j] = dato();
+         pb[j] = dato();
+      }
+      t4[i] = Tupla4f( dato(), dato(), dato(), dato() );
+      t3[i] = Tupla3f( dato(), dato(), dato() );
+   }
+   // una matriz de ceros negativos por ceros positivos: todos los productos
+   // son -0, y la suma desde +0 (la genérica) da +0
+   {  float * pa = ma[0], * pb = mb[0] ;
+      for( unsigned j = 0 ; j < 16 ; j++ )
+      {  pa[j] = -0.0f ;
+         pb[j] = 0.0f ;
+      }
+      t4[0] = Tupla4f( 0.0f, 0.0f, 0.0f, 0.0f );
+      t3[0] = Tupla3f( 0.0f, 0.0f, 0.0f );
+   }
+
+   vector<Matriz4f> rm_gen( n ), rm_sse( n );
+   vector<Tupla4f>  r4_gen( n ), r4_sse( n );
+   vector<Tupla3f>  r3_gen( n ), r3_sse( n );
+
+   // cada medida hace 'veces' pasadas por las 'n' operaciones
+   auto medir = [&]( const function<void()> & pasada )
+   {  return MedirMs( [&](){ for( unsigned v = 0 ; v < veces ; v++ ) pasada(); } );
+   };
+   const double ops = double( n )*veces ;
+
+   const double tm_gen = medir( [&](){ for( unsigned i = 0 ; i < n ; i++ ) rm_gen[i] = ProductoGenerico( ma[i], mb[i] ); } ),
+                tm_sse = medir( [&](){ for( unsigned i = 0 ; i < n ; i++ ) rm_sse[i] = ma[i]*mb[i] ; } ),
+                t4_gen = medir( [&](){ for( unsigned i = 0 ; i < n ; i++ ) r4_gen[i] = ProductoGenerico( ma[i], t4[i] ); } ),
+                t4_sse = medir( [&](){ for( unsigned i = 0 ; i < n ; i++ ) r4_sse[i] = ma[i]*t4[i] ; } ),
+                t3_gen = medir( [&](){ for( unsigned i = 0 ; i < n ; i++ ) r3_gen[i] = ProductoGenerico( ma[i], t3[i] ); } ),
+                t3_sse = medir( [&](){ for( unsigned i = 0 ; i < n ; i++ ) r3_sse[i] = ma[i]*t3[i] ; } );
+
+   auto escribir = [&]( const char * nombre, const double t_gen, const double t_sse )
+   {  cout << nombre << endl
+           << "   genérico: " << 1e6*t_gen/ops << " ns por producto" << endl
+           << "   SSE:      " << 1e6*t_sse/ops << " ns por producto (x" << t_gen/t_sse << ")" << endl ;
+   };
+   cout << n << " productos, " << veces << " veces:" << endl ;
+   escribir( "Matriz4f * Matriz4f", tm_gen, tm_sse );
+   escribir( "Matriz4f * Tupla4f", t4_gen, t4_sse );
+   escribir( "Matriz4f * Tupla3f", t3_gen, t3_sse );
+
+   const bool iguales = MismosBits( rm_gen, rm_sse ) && MismosBits( r4_gen, r4_sse ) &&
+                        MismosBits( r3_gen, r3_sse ) ;
+   cout << "resultados con SSE " << ( iguales ? "idénticos (bit a bit)" : "DISTINTOS" )
+        << " a los genéricos" << endl ;
+   return iguales ? 0 : 1 ;
+}
@@ -0,0 +1,89 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: cálculo de las normales en paralelo (MallaInd::calcular_normales)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <thread>
+#include <iostream>
+#include "comun.hpp"
+#include "Paralelo.hpp"
+
+using namespace std ;
+
+// diferencia máxima admitida con el cálculo en serie (la normalización con
+// SSE no redondea exactamente igual que Tupla3f::normalized)
+static const float tolerancia = 1e-6f ;
+
+// -----------------------------------------------------------------------------
+// el cálculo en serie que había antes en MallaInd: normales de las caras y
+// suma de cada cara en sus tres vértices, recorriendo las caras una a una
+
+static void NormalesEnSerie( const MallaRejilla & m, vector<Tupla3f> & nor_caras,
+                             vector<Tupla3f> & nor_ver )
+{
+   const vector<Tupla3f> & vertices = m.leerVertices();
+   const vector<Tupla3i> & caras    = m.leerCaras();
+
+   nor_caras.clear();
+   for( unsigned i = 0 ; i < caras.size() ; i++ )
+   {  const Tupla3f a1 = vertices[caras.at(i)[1]] - vertices[caras.at(i)[0]],
+                    a2 = vertices[caras.at(i)[2]] - vertices[caras.at(i)[0]];
+      nor_caras.push_back( MallaInd::normalizar( a1.cross( a2 ) ) );
+   }
+   nor_ver.assign( vertices.size(), Tupla3f( 0.0, 0.0, 0.0 ) );
+   for( unsigned i = 0 ; i < caras.size() ; i++ )
+   for( unsigned j = 0 ; j < 3 ; j++ )
+      nor_ver[caras.at(i)[j]] = nor_ver[caras.at(i)[j]] + nor_caras.at(i) ;
+   for( unsigned i = 0 ; i < nor_ver.size() ; i++ )
+      nor_ver.at(i) = MallaInd::normalizar( nor_ver.at(i) );
+}
+// -----------------------------------------------------------------------------
+
+static float DiferenciaMaxima( const vector<Tupla3f> & a, const vector<Tupla3f> & b )
+{
+   float dif = a.size() == b.size() ? 0.0f : INFINITY ;
+   for( unsigned i = 0 ; i < a.size() && i < b.size() ; i++ )
+   for( unsigned j = 0 ; j < 3 ; j++ )
+      dif = std::max( dif, std::fabs( a[i](j) - b[i](j) ) );
+   return dif ;
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "normales de rejillas de más de 1M de triángulos: en serie y en paralelo (mejor de 5)" );
+   cout << "núcleos del hardware: " << std::thread::hardware_concurrency() << endl ;
+
+   const unsigned lados[] = { 760, 1100 },
+                  hebras[] = { 1, 2, 4, 8 };
+   bool correcto = true ;
+
+   for( const unsigned n : lados )
+   {
+      MallaRejilla m( n );
+      vector<Tupla3f> ref_caras, ref_ver ;
+      const double t_serie = MedirMs( [&](){ NormalesEnSerie( m, ref_caras, ref_ver ); } );
+      cout << endl << m.numCaras() << " caras, " << m.numVertices() << " vértices:" << endl
+           << "   en serie (código anterior):  " << t_serie << " ms" << endl ;
+
+      for( const unsigned h : hebras )
+      {
+         FijarHebrasParalelo( h );
+         const double t = MedirMs( [&](){ m.normales(); } );
+         const float  dif_caras = DiferenciaMaxima( m.leerNormalesCaras(), ref_caras ),
+                      dif_ver   = DiferenciaMaxima( m.leerNormalesVertices(), ref_ver );
+         const bool   ok        = dif_caras <= tolerancia && dif_ver <= tolerancia ;
+         correcto = correcto && ok ;
+         cout << "   calcular_normales, " << h << " hebra(s): " << t << " ms (x" << t_serie/t
+              << "), dif. máx. caras " << dif_caras << ", vértices " << dif_ver
+              << (ok ? "" : "  FUERA DE TOLERANCIA") << endl ;
+      }
+      FijarHebrasParalelo( 0 );
+   }
+   cout << endl << "tolerancia " << tolerancia << ": " << (correcto ? "se cumple" : "NO SE CUMPLE") << endl ;
+   return correcto ? 0 : 1 ;
+}
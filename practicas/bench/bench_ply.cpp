@@ -0,0 +1,86 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: lectura de plys en ascii y en binario (ply::read)
+// **
+// *********************************************************************
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "comun.hpp"
+#include "file_ply_stl.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// escribe un ply binario con los vértices (x,y,z en float) y caras (lista de
+// 3 enteros) leídos, con el orden de bytes 'big_endian' o el contrario
+
+static void EscribirBinario( const string & nombre, const bool big_endian,
+                             const vector<float> & vertices, const vector<int> & caras )
+{
+   const unsigned n = 1 ;
+   const bool anfitrion_be = *((const char *)&n) == 0 ;
+
+   ofstream f( nombre, ios::binary );
+   f << "ply\nformat " << (big_endian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n"
+     << "element vertex " << vertices.size()/3 << "\n"
+     << "property float x\nproperty float y\nproperty float z\n"
+     << "element face " << caras.size()/3 << "\n"
+     << "property list uchar int vertex_indices\nend_header\n" ;
+
+   // cualquier valor de 4 bytes, en el orden del archivo
+   auto escribir4 = [&]( const void * p )
+   {  char b[4] ;
+      copy( (const char *)p, (const char *)p+4, b );
+      if ( big_endian != anfitrion_be )
+         reverse( b, b+4 );
+      f.write( b, 4 );
+   };
+   for( const float & v : vertices )
+      escribir4( &v );
+   for( unsigned i = 0 ; i < caras.size() ; i += 3 )
+   {  const char nv = 3 ;
+      f.write( &nv, 1 );
+      for( unsigned j = 0 ; j < 3 ; j++ )
+         escribir4( &caras[i+j] );
+   }
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "lectura de plys: ascii frente a binario (ply::read, mejor de 5)" );
+
+   const char * plys[] = { "../plys/beethoven.ply", "../plys/big_dodge.ply" };
+   const string bin_le = "bench_ply_le.ply", bin_be = "bench_ply_be.ply" ;
+   bool iguales = true ;
+
+   for( const char * ply_ascii : plys )
+   {
+      vector<float> v_ascii, v ;
+      vector<int>   c_ascii, c ;
+      ply::read( ply_ascii, v_ascii, c_ascii );
+      EscribirBinario( bin_le, false, v_ascii, c_ascii );
+      EscribirBinario( bin_be, true,  v_ascii, c_ascii );
+
+      const double t_ascii = MedirMs( [&](){ ply::read( ply_ascii, v, c ); } ),
+                   t_le    = MedirMs( [&](){ ply::read( bin_le.c_str(), v, c ); } );
+      iguales = iguales && v == v_ascii && c == c_ascii ;
+      const double t_be    = MedirMs( [&](){ ply::read( bin_be.c_str(), v, c ); } );
+      iguales = iguales && v == v_ascii && c == c_ascii ;
+
+      cout << ply_ascii << " (" << v_ascii.size()/3 << " vértices, " << c_ascii.size()/3 << " caras):" << endl
+           << "   ascii:                 " << t_ascii << " ms" << endl
+           << "   binario little endian: " << t_le << " ms (x" << t_ascii/t_le << ")" << endl
+           << "   binario big endian:    " << t_be << " ms (x" << t_ascii/t_be << ")" << endl ;
+   }
+   remove( bin_le.c_str() );
+   remove( bin_be.c_str() );
+
+   cout << "tablas leídas en binario " << (iguales ? "iguales" : "DISTINTAS") << " a las leídas en ascii" << endl ;
+   return iguales ? 0 : 1 ;
+}
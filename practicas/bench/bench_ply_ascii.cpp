@@ -0,0 +1,251 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: lectura de plys ascii (MB/s con 1 a 8 hebras) y comprobación
+// ** de que da lo mismo que la lectura anterior con 'istream'
+// **
+// *********************************************************************
+
+#include <dirent.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "comun.hpp"
+#include "file_ply_stl.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// la lectura anterior de los cuerpos ascii ('leer_vertices' y 'leer_caras' de
+// 'file_ply_stl.cpp', con 'istream >> long double'), copiada aquí como
+// referencia. La cabecera solo se recorre hasta 'end_header' para saber el
+// número de vértices y de caras
+
+static void LeerAnterior( const string & nombre, vector<float> & vertices, vector<int> & caras )
+{
+   ifstream src( nombre, ios::in | ios::binary );
+   string linea ;
+   unsigned num_vertices = 0, num_caras = 0 ;
+   while( getline( src, linea ) && linea.compare( 0, 10, "end_header" ) != 0 )
+   {  if ( linea.compare( 0, 15, "element vertex " ) == 0 )
+         num_vertices = atoi( linea.c_str()+15 );
+      else if ( linea.compare( 0, 13, "element face " ) == 0 )
+         num_caras = atoi( linea.c_str()+13 );
+   }
+
+   const streamsize tam_buffer = 10*1024 ;
+   char buffer[tam_buffer] ;
+
+   vertices.resize( num_vertices*3 );
+   for( long long iv = 0 ; iv < num_vertices ; iv++ )
+   {
+      long double x,y,z ;
+      src >> x >> y >> z ;
+      src.getline(buffer,tam_buffer); // ignore more properties, so far ...
+      long long base = iv*3 ;
+      vertices[base+0] = x ;
+      vertices[base+1] = y ;
+      vertices[base+2] = z ;
+   }
+
+   const unsigned nvc = 3 ;
+   caras.resize( num_caras*nvc );
+   for( long long ifa = 0 ; ifa < num_caras ; ifa++ )
+   {
+      unsigned nv ;
+      src >> nv ;
+      long long iv[nvc] ;
+      const long long base = ifa*nvc ;
+      for ( unsigned ivc = 0 ; ivc < nvc ; ivc++ )
+      {  src >> iv[ivc] ;
+         caras[ base+ivc ] = iv[ivc] ;
+      }
+      src.getline(buffer,tam_buffer); // ignore more properties, so far ...
+   }
+}
+// -----------------------------------------------------------------------------
+// lectura con 'ply::read_mmap' (la que usa MallaPLY), sobre vectores
+
+static void LeerProyectado( const string & nombre, vector<float> & vertices, vector<int> & caras )
+{
+   ply::read_mmap( nombre.c_str(),
+      [&]( unsigned n ) { vertices.resize( 3*n ); return vertices.data(); },
+      [&]( unsigned n ) { caras.resize( 3*n ); return caras.data(); } );
+}
+// -----------------------------------------------------------------------------
+
+static bool MismosBits( const vector<float> & a, const vector<float> & b )
+{
+   return a.size() == b.size() && memcmp( a.data(), b.data(), a.size()*sizeof(float) ) == 0 ;
+}
+// -----------------------------------------------------------------------------
+// nombres de los archivos '.ply' ascii de una carpeta, ordenados, y si
+// declaran caras (los perfiles solo tienen vértices)
+
+static vector< pair<string,bool> > ArchivosAscii( const string & carpeta )
+{
+   vector< pair<string,bool> > archivos ;
+   DIR * dir = opendir( carpeta.c_str() );
+   if ( dir == nullptr )
+      return archivos ;
+   while( const dirent * e = readdir( dir ) )
+   {  const string n = e->d_name ;
+      if ( n.size() <= 4 || n.compare( n.size()-4, 4, ".ply" ) != 0 )
+         continue ;
+      ifstream f( carpeta + "/" + n );
+      string linea ;
+      bool ascii = false, caras = false ;
+      while( getline( f, linea ) && linea.compare( 0, 10, "end_header" ) != 0 )
+      {  ascii = ascii || linea.compare( 0, 12, "format ascii" ) == 0 ;
+         caras = caras || ( linea.compare( 0, 13, "element face " ) == 0 && atoi( linea.c_str()+13 ) > 0 );
+      }
+      if ( ascii )
+         archivos.push_back( { carpeta + "/" + n, caras } );
+   }
+   closedir( dir );
+   sort( archivos.begin(), archivos.end() );
+   return archivos ;
+}
+// -----------------------------------------------------------------------------
+// escribe un ply ascii con 'nv' vértices (con una propiedad más, que se
+// ignora) y 'nc' caras, con números en formatos variados (mantisas largas,
+// exponentes, signos, sin parte entera o decimal), separadores variados,
+// finales de línea CR LF y líneas en blanco
+
+static void EscribirSintetico( const string & nombre, const unsigned nv, const unsigned nc )
+{
+   mt19937 gen( 1 );
+   uniform_int_distribution<int>    formato( 0, 7 ), digito( 0, 9 ), exponente( -45, 38 ),
+                                    num_digitos( 20, 40 ), sep( 0, 3 ), fin_linea( 0, 9 );
+   uniform_real_distribution<double> valor( -100.0, 100.0 );
+   uniform_int_distribution<unsigned> indice( 0, nv-1 );
+
+   auto numero = [&]()
+   {  char s[128] ;
+      const double v = valor( gen );
+      switch( formato( gen ) )
+      {  case 0 : snprintf( s, sizeof(s), "%.9g", v ); break ;
+         case 1 : snprintf( s, sizeof(s), "%.6e", v*1e-3 ); break ;
+         case 2 : snprintf( s, sizeof(s), "%.3E", v ); break ;
+         case 3 : snprintf( s, sizeof(s), "%.4fe%+d", v/100.0, exponente( gen ) ); break ;
+         case 4 : snprintf( s, sizeof(s), "+%.5f", v < 0 ? -v : v ); break ;
+         case 5 : snprintf( s, sizeof(s), v < 0 ? "-.%06d" : "%d.", abs( int(v*1000) ) ); break ;
+         case 6 : snprintf( s, sizeof(s), "%d", int(v) ); break ;
+         default :
+         {  // mantisa con más dígitos de los que caben en 64 bits
+            string m = v < 0 ? "-" : "" ;
+            m += to_string( abs( int(v) ) ) + "." ;
+            for( int i = num_digitos( gen ) ; i > 0 ; i-- )
+               m += char( '0'+digito( gen ) );
+            snprintf( s, sizeof(s), "%s", m.c_str() );
+         }
+      }
+      return string( s );
+   };
+   const char * separadores[] = { " ", "  ", "\t", " \t " };
+   auto linea = [&]( ofstream & f, const string & texto )
+   {  const int t = fin_linea( gen );
+      if ( t == 0 )
+         f << "\r\n" ;                    // línea en blanco
+      else if ( t == 1 )
+         f << " \t\n" ;                   // línea solo con espacios
+      f << texto << ( t < 5 ? "\r\n" : "\n" );
+   };
+
+   ofstream f( nombre, ios::binary );
+   f << "ply\nformat ascii 1.0\n"
+     << "element vertex " << nv << "\n"
+     << "property float x\nproperty float y\nproperty float z\nproperty float intensidad\n"
+     << "element face " << nc << "\n"
+     << "property list uchar int vertex_indices\nend_header\n" ;
+   for( unsigned i = 0 ; i < nv ; i++ )
+   {  string l = numero() ;
+      for( unsigned j = 1 ; j < 4 ; j++ )
+         l += separadores[sep( gen )] + numero();
+      linea( f, l );
+   }
+   for( unsigned i = 0 ; i < nc ; i++ )
+      linea( f, "3 " + to_string( indice( gen ) ) + separadores[sep( gen )] +
+                to_string( indice( gen ) ) + " " + to_string( indice( gen ) ) + " " );
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "lectura de plys ascii: lectura anterior (istream) frente a la actual en paralelo" );
+
+   bool iguales = true ;
+
+   // 1. los plys ascii del repositorio: lectura actual (con 'read' o
+   // 'read_vertices', y con 'read_mmap') igual bit a bit que la anterior
+   vector< pair<string,bool> > archivos = ArchivosAscii( "../plys" ),
+                               nuevos   = ArchivosAscii( "../plys/newplys" );
+   archivos.insert( archivos.end(), nuevos.begin(), nuevos.end() );
+   unsigned num_distintos = 0 ;
+   for( const auto & a : archivos )
+   {
+      vector<float> v_ant, v, v_proy ;
+      vector<int>   c_ant, c, c_proy ;
+      LeerAnterior( a.first, v_ant, c_ant );
+      bool igual ;
+      if ( a.second )
+      {  ply::read( a.first.c_str(), v, c );
+         LeerProyectado( a.first, v_proy, c_proy );
+         igual = MismosBits( v, v_ant ) && c == c_ant && MismosBits( v_proy, v_ant ) && c_proy == c_ant ;
+      }
+      else
+      {  ply::read_vertices( a.first.c_str(), v );
+         igual = MismosBits( v, v_ant );
+      }
+      if ( ! igual )
+      {  cout << "   DISTINTO: " << a.first << endl ;
+         num_distintos++ ;
+      }
+   }
+   cout << archivos.size() << " plys ascii del repositorio, " << num_distintos
+        << " leídos de forma distinta a la lectura anterior" << endl ;
+   iguales = iguales && num_distintos == 0 ;
+
+   // 2. un archivo sintético grande, con 1, 2, 4 y 8 hebras
+   const string sintetico = "bench_ply_ascii.ply" ;
+   EscribirSintetico( sintetico, 400000, 400000 );
+   double mb ;
+   {  ifstream f( sintetico, ios::binary | ios::ate );
+      mb = double( f.tellg() )/(1024.0*1024.0) ;
+   }
+
+   vector<float> v_ant, v ;
+   vector<int>   c_ant, c ;
+   const double t_ant = MedirMs( [&](){ LeerAnterior( sintetico, v_ant, c_ant ); }, 1 );
+   cout << sintetico << " (" << mb << " MB, " << v_ant.size()/3 << " vértices, "
+        << c_ant.size()/3 << " caras):" << endl
+        << "   lectura anterior:     " << mb/(t_ant/1000.0) << " MB/s" << endl ;
+
+   const unsigned hebras[] = { 1, 2, 4, 8 };
+   for( const unsigned h : hebras )
+   {  ply::fijar_num_hebras( h );
+      const double t = MedirMs( [&](){ ply::read( sintetico.c_str(), v, c ); }, 3 );
+      const bool igual = MismosBits( v, v_ant ) && c == c_ant ;
+      iguales = iguales && igual ;
+      cout << "   read, " << h << " hebra(s):    " << mb/(t/1000.0) << " MB/s (x"
+           << t_ant/t << ")" << ( igual ? "" : " DISTINTO" ) << endl ;
+   }
+   ply::fijar_num_hebras( 0 );
+   {  vector<float> v_proy ;
+      vector<int>   c_proy ;
+      const double t = MedirMs( [&](){ LeerProyectado( sintetico, v_proy, c_proy ); }, 3 );
+      const bool igual = MismosBits( v_proy, v_ant ) && c_proy == c_ant ;
+      iguales = iguales && igual ;
+      cout << "   read_mmap, todas:     " << mb/(t/1000.0) << " MB/s (x"
+           << t_ant/t << ")" << ( igual ? "" : " DISTINTO" ) << endl ;
+   }
+   remove( sintetico.c_str() );
+
+   cout << "lectura actual " << ( iguales ? "idéntica (bit a bit)" : "DISTINTA" )
+        << " a la anterior" << endl ;
+   return iguales ? 0 : 1 ;
+}
@@ -0,0 +1,92 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: simplificación de mallas por colapso de aristas (SimpMalla)
+// **
+// *********************************************************************
+
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include "comun.hpp"
+#include "SimplificarMalla.hpp"
+#include "file_ply_stl.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+// simplifica 'origen' a 'num_caras' caras sin el informe que escribe
+// SimpMalla_Simplificar en 'cout' (se repite en cada medida)
+
+static void Simplificar( const TablasMalla & origen, const unsigned num_caras, TablasMalla & destino )
+{
+   ostringstream descarte ;
+   streambuf * anterior = cout.rdbuf( descarte.rdbuf() );
+   SimpMalla_Simplificar( origen, num_caras, destino, "" );
+   cout.rdbuf( anterior );
+}
+// -----------------------------------------------------------------------------
+// true si todas las caras de 'tablas' usan vértices que existen y ninguna
+// es degenerada
+
+static bool CarasValidas( const TablasMalla & tablas )
+{
+   const int nv = tablas.vertices->size();
+   for( const Tupla3i & c : *tablas.caras )
+      for( unsigned k = 0 ; k < 3 ; k++ )
+         if ( c(k) < 0 || c(k) >= nv || c(k) == c((k+1)%3) )
+            return false ;
+   return true ;
+}
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "simplificación con la métrica cuadrática hasta el 50%, 25%, 10% y 2% de las caras (mejor de 3)" );
+
+   const float proporciones[] = { 0.5f, 0.25f, 0.1f, 0.02f };
+   bool validas = true ;
+
+   // los dos plys más grandes y una rejilla (más caras que cualquier ply)
+   vector<string>          nombres = { "beethoven.ply", "big_dodge.ply", "rejilla 300x300" };
+   vector<vector<Tupla3f>> vertices( 3 );
+   vector<vector<Tupla3i>> caras( 3 );
+   for( unsigned m = 0 ; m < 2 ; m++ )
+   {  vector<float> v ;
+      vector<int>   c ;
+      ply::read( ("../plys/"+nombres[m]).c_str(), v, c );
+      for( unsigned i = 0 ; i+2 < v.size() ; i += 3 )
+         vertices[m].push_back( Tupla3f( v[i], v[i+1], v[i+2] ) );
+      for( unsigned i = 0 ; i+2 < c.size() ; i += 3 )
+         caras[m].push_back( Tupla3i( c[i], c[i+1], c[i+2] ) );
+   }
+   {  const MallaRejilla rejilla( 300 );
+      vertices[2] = rejilla.leerVertices();
+      caras[2]    = rejilla.leerCaras();
+   }
+
+   cout << fixed << setprecision( 1 );
+   for( unsigned m = 0 ; m < nombres.size() ; m++ )
+   {
+      vector<Tupla3f> nor_ver, nor_caras, col, sal_ver, sal_nor_ver, sal_nor_caras, sal_col ;
+      vector<Tupla2f> cctt, sal_cctt ;
+      vector<Tupla3i> sal_caras ;
+      const TablasMalla origen  = { &vertices[m], &caras[m], &nor_ver, &nor_caras, &col, &cctt };
+      TablasMalla       destino = { &sal_ver, &sal_caras, &sal_nor_ver, &sal_nor_caras, &sal_col, &sal_cctt };
+
+      cout << endl << nombres[m] << " (" << caras[m].size() << " caras):" << endl ;
+      for( const float p : proporciones )
+      {
+         const unsigned objetivo = unsigned( p*caras[m].size() );
+         const double   ms = MedirMs( [&](){ Simplificar( origen, objetivo, destino ); }, 3 );
+         validas = validas && CarasValidas( destino );
+         cout << "   " << setw( 4 ) << 100.0f*p << "%: " << setw( 7 ) << sal_caras.size() << " caras, "
+              << setw( 7 ) << sal_ver.size() << " vértices en " << setw( 7 ) << ms << " ms ("
+              << setprecision( 2 ) << 1e-3*(caras[m].size()-sal_caras.size())/ms << setprecision( 1 )
+              << " M caras quitadas/s)" << endl ;
+      }
+   }
+   cout << endl << "caras de las mallas simplificadas " << (validas ? "válidas" : "NO VÁLIDAS") << endl ;
+   return validas ? 0 : 1 ;
+}
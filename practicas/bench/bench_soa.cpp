@@ -0,0 +1,60 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medida: disposición AoS frente a SoA (normales y caja englobante)
+// **
+// *********************************************************************
+
+#include <cmath>
+#include <iostream>
+#include "comun.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+   Titulo( "disposición de las tablas de vértices: AoS frente a SoA (mejor de 5)" );
+
+   const unsigned lados[] = { 200, 760, 1100 };
+   bool iguales = true ;
+
+   for( const unsigned n : lados )
+   {
+      MallaRejilla m( n );
+      const unsigned nv = m.numVertices();
+
+      // AoS: la disposición inicial de las mallas
+      Tupla3f cmin_aos, cmax_aos ;
+      const double t_nor_aos  = MedirMs( [&](){ m.normales(); } ),
+                   t_caja_aos = MedirMs( [&](){ m.calcularCajaVertices( cmin_aos, cmax_aos ); } );
+      vector<Tupla3f> nor_aos( nv );
+      for( unsigned i = 0 ; i < nv ; i++ )
+         nor_aos[i] = m.leerNormal( i );
+
+      // SoA: las mismas tablas como tres arrays alineados
+      m.fijarDisposicion( DisposicionMalla::soa );
+      Tupla3f cmin_soa, cmax_soa ;
+      const double t_nor_soa  = MedirMs( [&](){ m.normales(); } ),
+                   t_caja_soa = MedirMs( [&](){ m.calcularCajaVertices( cmin_soa, cmax_soa ); } );
+
+      // las dos disposiciones hacen las mismas operaciones en el mismo orden
+      float dif = 0.0f ;
+      for( unsigned i = 0 ; i < nv ; i++ )
+      for( unsigned j = 0 ; j < 3 ; j++ )
+         dif = std::max( dif, std::fabs( m.leerNormal( i )(j) - nor_aos[i](j) ) );
+      for( unsigned j = 0 ; j < 3 ; j++ )
+         iguales = iguales && cmin_aos(j) == cmin_soa(j) && cmax_aos(j) == cmax_soa(j) ;
+      iguales = iguales && dif == 0.0f ;
+
+      cout << endl << m.numCaras() << " caras, " << nv << " vértices:" << endl
+           << "   calcular_normales:    AoS " << t_nor_aos << " ms, SoA " << t_nor_soa
+           << " ms (x" << t_nor_aos/t_nor_soa << ")" << endl
+           << "   calcularCajaVertices: AoS " << t_caja_aos << " ms, SoA " << t_caja_soa
+           << " ms (x" << t_caja_aos/t_caja_soa << ")" << endl ;
+   }
+   cout << endl << "resultados en SoA " << (iguales ? "iguales" : "DISTINTOS") << " a los de AoS" << endl ;
+   return iguales ? 0 : 1 ;
+}
@@ -0,0 +1,86 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medidas de tiempos: funciones comunes (implementación)
+// **
+// *********************************************************************
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "comun.hpp"
+#include "practicas.hpp"
+
+using namespace std ;
+
+// -----------------------------------------------------------------------------
+
+double MedirMs( const std::function<void()> & tarea, const unsigned veces )
+{
+   double mejor = 0.0 ;
+   for( unsigned i = 0 ; i < veces ; i++ )
+   {
+      const auto t_inicio = chrono::steady_clock::now();
+      tarea();
+      const double ms = chrono::duration<double,milli>( chrono::steady_clock::now() - t_inicio ).count();
+      if ( i == 0 || ms < mejor )
+         mejor = ms ;
+   }
+   return mejor ;
+}
+// -----------------------------------------------------------------------------
+
+void Titulo( const std::string & titulo )
+{
+   cout << endl << "---------------------------------------------------------------" << endl
+        << titulo << endl
+        << "---------------------------------------------------------------" << endl ;
+}
+// -----------------------------------------------------------------------------
+
+GLFWwindow * CrearVentanaOculta( const int ancho, const int alto )
+{
+   if ( ! glfwInit() )
+   {  cout << "Error: imposible inicializar GLFW." << endl ;
+      exit(1);
+   }
+   glfwWindowHint( GLFW_VISIBLE, GL_FALSE );
+   GLFWwindow * ventana = glfwCreateWindow( ancho, alto, "medidas", nullptr, nullptr );
+   if ( ventana == nullptr )
+   {  cout << "Error: imposible crear ventana." << endl ;
+      glfwTerminate();
+      exit(1);
+   }
+   glfwMakeContextCurrent( ventana );
+   Inicializa_GLEW();
+   return ventana ;
+}
+// -----------------------------------------------------------------------------
+
+MallaRejilla::MallaRejilla( const unsigned n )
+:  MallaInd( "rejilla" )
+{
+   std::mt19937 gen( 1 );
+   std::uniform_real_distribution<float> despl( -0.3f, 0.3f );
+
+   vertices.reserve( n*n );
+   for( unsigned i = 0 ; i < n ; i++ )
+   for( unsigned j = 0 ; j < n ; j++ )
+      vertices.push_back( Tupla3f( i+despl(gen), j+despl(gen), despl(gen) ) );
+
+   caras.reserve( 2*(n-1)*(n-1) );
+   for( unsigned i = 0 ; i+1 < n ; i++ )
+   for( unsigned j = 0 ; j+1 < n ; j++ )
+   {  const int v = i*n+j ;
+      caras.push_back( Tupla3i( v,   v+1,   v+n ) );
+      caras.push_back( Tupla3i( v+1, v+n+1, v+n ) );
+   }
+}
+// -----------------------------------------------------------------------------
+// (definida en practica5.cpp, que no se enlaza: la usa ColaVisualizacion)
+
+void FijarColorIdent( const int ident )  // 0 ≤ ident < 2^24
+{
+   glColor3ub( ident%0x100U, (ident/0x100U)%0x100U, (ident/0x10000U)%0x100U );
+}
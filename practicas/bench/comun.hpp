@@ -0,0 +1,48 @@
+// *********************************************************************
+// **
+// ** Informática Gráfica, curso 2018-19
+// ** Montserrat Rodríguez Zamorano
+// ** Medidas de tiempos: funciones comunes (declaraciones)
+// **
+// *********************************************************************
+
+#ifndef IG_BENCH_COMUN_HPP
+#define IG_BENCH_COMUN_HPP
+
+#include <string>
+#include <functional>
+#include "aux.hpp"
+#include "MallaInd.hpp"
+
+// ---------------------------------------------------------------------
+// tiempo, en milisegundos, de la ejecución más rápida de 'tarea' entre
+// 'veces' ejecuciones (la más rápida es la que menos ruido tiene)
+
+double MedirMs( const std::function<void()> & tarea, const unsigned veces = 5 );
+
+// escribe el título de una medida
+void Titulo( const std::string & titulo );
+
+// crea una ventana oculta de 'ancho' x 'alto' pixels y activa su contexto
+// de OpenGL (con GLEW inicializado), para las medidas que visualizan
+GLFWwindow * CrearVentanaOculta( const int ancho = 1024, const int alto = 1024 );
+
+// ---------------------------------------------------------------------
+// malla en forma de rejilla de n x n vértices, con 2(n-1)² triángulos. Los
+// vértices se desplazan un poco al azar (siempre igual, con la misma
+// semilla), así las normales no son todas iguales. Las medidas acceden a
+// sus tablas a través de ella
+
+class MallaRejilla : public MallaInd
+{
+   public:
+      MallaRejilla( const unsigned n );
+
+      void normales() { calcular_normales(); }
+      const vector<Tupla3f> & leerVertices() const { return vertices ; }
+      const vector<Tupla3i> & leerCaras() const { return caras ; }
+      const vector<Tupla3f> & leerNormalesCaras() const { return normales_caras ; }
+      const vector<Tupla3f> & leerNormalesVertices() const { return normales_vertices ; }
+} ;
+
+#endif
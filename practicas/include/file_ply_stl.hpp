@@ -26,6 +26,7 @@
 #define _PLY_H
 
 #include <vector>
+#include <functional>
 
 namespace ply
 {
@@ -43,6 +44,7 @@ namespace ply
 // **     vectores 'vertices' y 'caras'
 // **   - lee el archivo .ply y lo carga en 'vertices' y 'faces'
 // **   - solo admite plys con triángulos, 
+// **   - admite formato 'ascii', 'binary_little_endian' y 'binary_big_endian'
 // **   - no lee colores, coordenadas de textura, ni normales.
 // **
 // *********************************************************************
@@ -67,6 +69,7 @@ void read
 // **     vectores 'vertices' y 'caras'
 // **   - lee el archivo .ply y lo carga en 'vertices' y 'faces'
 // **   - solo admite plys con cuatro vértices por cara
+// **   - admite formato 'ascii', 'binary_little_endian' y 'binary_big_endian'
 // **   - no lee colores, coordenadas de textura, ni normales.
 // **
 // *********************************************************************
@@ -90,6 +93,7 @@ void read_4vc
 // **   - elimina cualquier contenido previo en el 
 // **     vector 'vertices' 
 // **   - lee el archivo .ply y carga los vértices en 'vertices'
+// **   - admite formato 'ascii', 'binary_little_endian' y 'binary_big_endian'
 // **   - no lee colores, caras, coordenadas de textura, ni normales.
 // **   - se ignora la información de caras
 // **
@@ -100,6 +104,72 @@ void read_vertices
    const char *         nombre_archivo_pse, // entrada: nombre de archivo 
    std::vector<float> & vertices            // salida:  vector de coords. de vert.
 );
+
+// **********************************************************************
+// **
+// ** ply::read_mmap
+// **
+// **  lee un archivo ply proyectándolo en memoria, y escribe los vértices,
+// **  las caras y (opcionalmente) otros atributos de los vértices
+// **  directamente en la memoria que proporciona quien llama
+// **
+// **   - 'nombre_archivo' nombre del archivo (se le añade .ply si no 
+// **     acaba en .ply)
+// **   - si hay un error, aborta
+// **   - tras leer la cabecera, llama a 'reservar_vertices(n)', que debe
+// **     devolver espacio para 3*n floats, y a 'reservar_caras(n)', que
+// **     debe devolver espacio para 3*n ints
+// **   - para cada función no vacía de 'reservar_atributos', si el archivo
+// **     tiene todas las propiedades del atributo, la llama con el número
+// **     de vértices y escribe en la memoria que devuelve:
+// **        normales: 3*n floats (propiedades 'nx','ny','nz')
+// **        colores:  3*n floats en [0,1] (propiedades 'red','green','blue',
+// **                  si son 'uchar' o 'ushort' se dividen por 255 o 65535)
+// **        cctt:     2*n floats (propiedades 's','t', o bien 'u','v', o
+// **                  bien 'texture_u','texture_v' o 'texture_s','texture_t')
+// **   - no usa vectores intermedios: el cuerpo se decodifica desde el
+// **     archivo proyectado (en binario nativo con solo x,y,z en float,
+// **     los vértices se copian tal cual)
+// **   - solo admite plys con triángulos, 
+// **   - admite formato 'ascii', 'binary_little_endian' y 'binary_big_endian'
+// **
+// *********************************************************************
+
+typedef std::function< float * ( unsigned num_vertices ) > FuncReservaVertices ;
+typedef std::function< int *   ( unsigned num_caras )    > FuncReservaCaras ;
+
+struct ReservaAtributos
+{
+   FuncReservaVertices normales ; // 3 floats por vértice
+   FuncReservaVertices colores ;  // 3 floats por vértice
+   FuncReservaVertices cctt ;     // 2 floats por vértice
+} ;
+
+void read_mmap
+(
+   const char *                 nombre_archivo_pse, // entrada: nombre de archivo
+   const FuncReservaVertices &  reservar_vertices,  // entrada: reserva de coords. de vert.
+   const FuncReservaCaras &     reservar_caras,     // entrada: reserva de triángulos (índices)
+   const ReservaAtributos &     reservar_atributos = ReservaAtributos() // entrada: reserva de otros atributos
+);
+   
+// **********************************************************************
+// **
+// ** ply::fijar_num_hebras
+// **
+// **  fija el número de hebras con que se analizan los cuerpos ascii
+// **  (en 'read', 'read_4vc', 'read_vertices' y 'read_mmap')
+// **
+// **   - con 0 se usa una hebra por núcleo del hardware (el valor inicial)
+// **   - los cuerpos pequeños se analizan con menos hebras (cada hebra
+// **     analiza al menos 256 KB)
+// **
+// *********************************************************************
+
+void fijar_num_hebras
+(
+   const unsigned num_hebras  // entrada: número de hebras (0: las del hardware)
+);
    
 } ; // fin namespace ply
 
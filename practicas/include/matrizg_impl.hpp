@@ -23,6 +23,9 @@
 #ifndef MATRIZG_IMPL_HPP
 #define MATRIZG_IMPL_HPP
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 
 // *********************************************************************
@@ -166,9 +169,67 @@ TuplaG<T,n-1> MatrizCG<T,n>::operator * ( const TuplaG<T,n-1>  & t ) const
 }
 
 
+// *********************************************************************
+// especializaciones para 'float' y n=4 (Matriz4f) con SSE: las columnas
+// están seguidas en memoria, y cada una cabe en un registro. Cada columna
+// del resultado es una combinación lineal de las columnas de la matriz de
+// la izquierda, sumada en el mismo orden y desde el mismo 0 que en las
+// versiones genéricas (así el resultado es idéntico, también en el signo
+// de los ceros: 0 + (-0) es +0). Sin SSE se usan las genéricas.
+
+#ifdef __SSE__
 
-   
+// ---------------------------------------------------------------------
+// combinación lineal de las columnas de 'izq' con las componentes de 'c'
+// (cada una se repite en las cuatro posiciones de un registro)
+
+inline __m128 MatrizCG_CombinarColumnas( const float * izq, const __m128 c )
+{
+   __m128 r = _mm_setzero_ps();
+   r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( izq ),    _mm_shuffle_ps( c, c, _MM_SHUFFLE(0,0,0,0) ) ) );
+   r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( izq+4 ),  _mm_shuffle_ps( c, c, _MM_SHUFFLE(1,1,1,1) ) ) );
+   r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( izq+8 ),  _mm_shuffle_ps( c, c, _MM_SHUFFLE(2,2,2,2) ) ) );
+   r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( izq+12 ), _mm_shuffle_ps( c, c, _MM_SHUFFLE(3,3,3,3) ) ) );
+   return r ;
+}
+
+// ---------------------------------------------------------------------
+
+template<> inline
+MatrizCG<float,4> MatrizCG<float,4>::operator * ( const MatrizCG<float,4> & der ) const
+{
+   MatrizCG<float,4> res ;
+   const float * a = *this, * b = der ;
+   float *       r = res ;
+
+   for( unsigned col = 0 ; col < 4 ; col++ )
+      _mm_storeu_ps( r+4*col, MatrizCG_CombinarColumnas( a, _mm_loadu_ps( b+4*col ) ) );
+   return res ;
+}
+
+// ---------------------------------------------------------------------
+
+template<> inline
+TuplaG<float,4> MatrizCG<float,4>::operator * ( const TuplaG<float,4> & t ) const
+{
+   TuplaG<float,4> res ;
+   _mm_storeu_ps( res, MatrizCG_CombinarColumnas( *this, _mm_loadu_ps( t ) ) );
+   return res ;
+}
+
+// ---------------------------------------------------------------------
+// (la tupla de 3 no se puede leer con un solo '_mm_loadu_ps': se pasaría
+// del final)
+
+template<> inline
+TuplaG<float,3> MatrizCG<float,4>::operator * ( const TuplaG<float,3> & t ) const
+{
+   float res1[4] ;
+   _mm_storeu_ps( res1, MatrizCG_CombinarColumnas( *this, _mm_setr_ps( t(0), t(1), t(2), 1.0f ) ) );
+   return TuplaG<float,3>( res1 );
+}
 
+#endif // __SSE__
 
 // *********************************************************************
 #endif
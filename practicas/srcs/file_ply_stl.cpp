@@ -31,7 +31,15 @@
 #include <fstream>
 #include <cmath>
 #include <limits>
+#include <algorithm>
 #include <assert.h>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <fcntl.h>     // open
+#include <unistd.h>    // close
+#include <sys/stat.h>  // fstat
+#include <sys/mman.h>  // mmap, munmap
 
 #include "file_ply_stl.hpp"
 
@@ -51,6 +59,101 @@ using namespace std ;
 
 const streamsize tam_buffer = streamsize(10L)*streamsize(1024L) ;
 
+// número de registros (vértices o caras) que se leen de golpe en los
+// archivos binarios, cuando no se pueden leer directamente sobre el vector
+const unsigned long num_regs_bloque = 64UL*1024UL ;
+
+// tamaño mínimo en bytes de cada trozo de un cuerpo ascii que se analiza
+// en una hebra distinta (con cuerpos pequeños no compensa crear hebras)
+const size_t tam_min_trozo = 256UL*1024UL ;
+
+// número de hebras fijado con 'fijar_num_hebras' (0: las del hardware)
+atomic<unsigned> hebras_fijadas( 0 ) ;
+
+// formatos de archivo admitidos
+enum FormatoPLY { fmt_ascii, fmt_binario_le, fmt_binario_be } ;
+
+// tipos de los valores de las propiedades (los mismos que en la especificación ply)
+enum TipoPLY { t_char, t_uchar, t_short, t_ushort, t_int, t_uint, t_float, t_double, t_ninguno } ;
+
+// descripción de una propiedad de un elemento ('property ...' en la cabecera)
+struct PropiedadPLY
+{
+   string  nombre ;
+   TipoPLY tipo ;     // tipo del valor (o de cada valor de la lista)
+   TipoPLY tipo_num ; // tipo del número de valores de la lista (t_ninguno si no es lista)
+} ;
+
+// información de la cabecera necesaria para leer el cuerpo del archivo
+struct CabeceraPLY
+{
+   FormatoPLY           formato ;
+   vector<PropiedadPLY> props_vertices, // propiedades de 'element vertex', en orden
+                        props_caras ;   // propiedades de 'element face', en orden
+   bool                 otros_elementos ; // hay otros elementos antes de los vértices o las caras
+} ;
+
+// memoria donde se escriben los atributos de los vértices (nullptr si no se leen)
+struct DestinosVertices
+{
+   float *       vertices ;        // 3 flotantes por vértice (x,y,z)
+   float *       normales ;        // 3 flotantes por vértice (nx,ny,nz)
+   float *       colores ;         // 3 flotantes por vértice (red,green,blue)
+   float *       cctt ;            // 2 flotantes por vértice
+   const char *  nombres_cctt[2] ; // nombres de las propiedades de 'cctt' en el archivo
+} ;
+
+// propiedad de vértice que se guarda: componente 'comp' de un atributo
+// con 'num_comp' componentes por vértice
+struct PropiedadLeida
+{
+   unsigned indice ;   // posición de la propiedad en la cabecera
+   long     despl ;    // desplazamiento dentro del registro (archivos binarios)
+   TipoPLY  tipo ;     // tipo del valor
+   float *  dest ;     // valores del atributo (desde el vértice 0)
+   unsigned num_comp,  // número de componentes del atributo
+            comp ;     // componente que se escribe
+   float    escala ;   // factor aplicado al valor (1/255 en colores 'uchar', etc...)
+} ;
+
+// propiedades de los vértices que se guardan, y su posición en cada registro
+struct DisposicionVertices
+{
+   unsigned               tam_reg ;   // tamaño en bytes de un registro (binario)
+   unsigned               num_props ; // valores a leer de cada línea (ascii)
+   vector<PropiedadLeida> props ;     // propiedades guardadas, en orden de 'indice'
+   bool                   directa ;   // true si el registro es exactamente x,y,z en float nativo
+} ;
+
+// posición de la lista de índices en los registros de caras binarios
+struct DisposicionCaras
+{
+   unsigned tam_reg ;     // tamaño en bytes de un registro (fijo)
+   long     despl_lista ; // desplazamiento de la lista dentro del registro
+   TipoPLY  tipo_num,     // tipo del número de índices
+            tipo_ind ;    // tipo de cada índice
+} ;
+
+// parámetros del análisis de un cuerpo ascii: las líneas no vacías se numeran
+// desde cero, las 'num_vertices' primeras son vértices y las 'num_caras'
+// siguientes son caras (el resto de líneas, si las hay, se ignoran)
+struct CuerpoAscii
+{
+   unsigned  nvc ;          // número de vértices por cara
+   unsigned  num_vertices,  // número de líneas de vértices
+             num_caras ;    // número de líneas de caras (0 si no se leen)
+   const DisposicionVertices *
+             vertices ;     // salida: propiedades de los vértices
+   int *     dest_caras ;   // salida: nvc*num_caras enteros
+} ;
+
+// archivo completo proyectado en memoria (de solo lectura)
+struct ArchivoProyectado
+{
+   const char *  datos ; // primer byte del archivo
+   size_t        tam ;   // tamaño en bytes
+} ;
+
 void read_nvc
 (
    const unsigned       nvc,                // entrada: número de vértices por cara
@@ -60,15 +163,38 @@ void read_nvc
 );
 
 void abrir_archivo( string & nombre_archivo, ifstream & src ) ;
-void leer_cabecera( const unsigned nvc, ifstream & src,
+void leer_cabecera( const unsigned nvc, istream & src,
                     unsigned & num_vertices, unsigned & num_caras,
-                    const bool lee_num_caras ) ;
+                    const bool lee_num_caras, CabeceraPLY & cab ) ;
 void error( const char *msg_error ) ;
-void leer_vertices(  unsigned num_vertices, vector<float> & vertices,
-                     ifstream & src  ) ;
-void leer_caras( const unsigned nvc, unsigned num_vertices,
-                 unsigned num_caras, vector<int> & caras,
-                 ifstream & src  ) ;
+void leer_vertices_bin( unsigned num_vertices, const CabeceraPLY & cab,
+                        vector<float> & vertices, ifstream & src ) ;
+void leer_caras_bin( const unsigned nvc, unsigned num_vertices, unsigned num_caras,
+                     const CabeceraPLY & cab, vector<int> & caras, ifstream & src ) ;
+TipoPLY leer_tipo( const string & nombre ) ;
+unsigned tam_tipo( const TipoPLY tipo ) ;
+bool host_little_endian() ;
+bool invertir_bytes( const CabeceraPLY & cab ) ;
+double decodificar( const char * p, const TipoPLY tipo, const bool invertir ) ;
+DisposicionVertices analizar_vertices( const CabeceraPLY & cab, const DestinosVertices & destinos ) ;
+DestinosVertices solo_coordenadas( float * vertices ) ;
+int buscar_propiedad( const vector<PropiedadPLY> & props, const char * nombre ) ;
+DisposicionCaras analizar_caras( const unsigned nvc, const CabeceraPLY & cab ) ;
+void decodificar_vertices( const char * datos, const unsigned long n, const unsigned long primero,
+                           const DisposicionVertices & d, const bool invertir ) ;
+void decodificar_caras( const char * datos, const unsigned long n, const unsigned nvc,
+                        const unsigned num_vertices, const DisposicionCaras & d,
+                        const bool invertir, int * dest ) ;
+void proyectar_archivo( const string & nombre_archivo, ArchivoProyectado & arch ) ;
+void liberar_archivo( ArchivoProyectado & arch ) ;
+const char * buscar_fin_cabecera( const ArchivoProyectado & arch ) ;
+void leer_cuerpo_ascii( ifstream & src, const CuerpoAscii & cuerpo ) ;
+void leer_cuerpo_ascii_mem( const char * ini, const char * fin, const CuerpoAscii & cuerpo ) ;
+unsigned long contar_lineas( const char * ini, const char * fin ) ;
+void analizar_lineas( const char * ini, const char * fin, unsigned long primera_linea,
+                      const CuerpoAscii & cuerpo ) ;
+bool leer_real( const char * & p, const char * fin, float & valor ) ;
+bool leer_entero( const char * & p, const char * fin, long long & valor ) ;
 
 //**********************************************************************
 // funcion principal de lectura
@@ -115,10 +241,23 @@ void read_nvc
    if ( na.substr( na.find_last_of(".")+1 ) != "ply" )
       na += ".ply" ;
 
+   CabeceraPLY
+      cab ;
+
    abrir_archivo( na, src ) ;
-   leer_cabecera( nvc, src, num_vertices, num_caras, true ) ;
-   leer_vertices( num_vertices, vertices, src ) ;
-   leer_caras( nvc, num_vertices, num_caras, caras, src ) ;
+   leer_cabecera( nvc, src, num_vertices, num_caras, true, cab ) ;
+
+   if ( cab.formato == fmt_ascii )
+   {  vertices.resize( (unsigned long)(num_vertices)*3UL );
+      caras.resize( (unsigned long)(num_caras)*nvc );
+      const DisposicionVertices dv = analizar_vertices( cab, solo_coordenadas( vertices.data() ) );
+      const CuerpoAscii cuerpo = { nvc, num_vertices, num_caras, &dv, caras.data() } ;
+      leer_cuerpo_ascii( src, cuerpo ) ;
+   }
+   else
+   {  leer_vertices_bin( num_vertices, cab, vertices, src ) ;
+      leer_caras_bin( nvc, num_vertices, num_caras, cab, caras, src ) ;
+   }
 
    //cout << "archivo ply '" << na << "' leido: núm. vértices == " << num_vertices << ", núm caras == " << num_caras << endl << flush ;
 }
@@ -142,100 +281,127 @@ void read_vertices
    if ( na.substr( na.find_last_of(".")+1 ) != "ply" )
       na += ".ply" ;
 
+   CabeceraPLY
+      cab ;
+
    abrir_archivo( na, src ) ;
-   leer_cabecera( 3, src, num_vertices, num_caras, false ) ;
-   leer_vertices( num_vertices, vertices, src ) ;
+   leer_cabecera( 3, src, num_vertices, num_caras, false, cab ) ;
+
+   if ( cab.formato == fmt_ascii )
+   {  vertices.resize( (unsigned long)(num_vertices)*3UL );
+      const DisposicionVertices dv = analizar_vertices( cab, solo_coordenadas( vertices.data() ) );
+      const CuerpoAscii cuerpo = { 3, num_vertices, 0, &dv, nullptr } ;
+      leer_cuerpo_ascii( src, cuerpo ) ;
+   }
+   else
+      leer_vertices_bin( num_vertices, cab, vertices, src ) ;
 
    //cout << "archivo ply leido (únicamente vértices)" << endl << flush ;
 }
 
-
 //**********************************************************************
+// lectura proyectando el archivo en memoria: el cuerpo se decodifica (o
+// se copia tal cual, si es binario en el formato nativo) directamente
+// sobre la memoria que proporcionan 'reservar_vertices' y 'reservar_caras'
 
-void leer_vertices( unsigned num_vertices, vector<float> & vertices, ifstream & src )
+void read_mmap
+(
+   const char *                 nombre_archivo_pse,
+   const FuncReservaVertices &  reservar_vertices,
+   const FuncReservaCaras &     reservar_caras,
+   const ReservaAtributos &     reservar_atributos
+)
 {
-   char
-      buffer[unsigned(tam_buffer)];
+   const unsigned
+      nvc = 3 ;
+   unsigned
+      num_vertices = 0,
+      num_caras    = 0 ;
    string
+      na = nombre_archivo_pse,
       token ;
+   ArchivoProyectado
+      arch ;
+   CabeceraPLY
+      cab ;
 
-   // leer vértices:
+   if ( na.substr( na.find_last_of(".")+1 ) != "ply" )
+      na += ".ply" ;
 
-   vertices.resize( num_vertices*3 );
+   proyectar_archivo( na, arch );
 
-   //cout << "  leyendo " << num_vertices << " vértices ...." << endl << flush ;
+   // la cabecera es pequeña: se analiza con el mismo código que con ifstream
+   const char *
+      cuerpo = buscar_fin_cabecera( arch );
+   istringstream
+      src_cab( string( arch.datos, cuerpo ) );
 
-   for( long long iv = 0 ; iv < num_vertices ; iv++ )
+   src_cab >> token ;
+   if ( token != "ply" )
+      error("el archivo de entrada no comienza con 'ply'");
+   leer_cabecera( nvc, src_cab, num_vertices, num_caras, true, cab ) ;
+
+   // atributos opcionales: solo se reservan si se piden y están completos en el archivo
+   const vector<PropiedadPLY> &
+      pv = cab.props_vertices ;
+   const char *
+      pares_cctt[4][2] = { {"s","t"}, {"u","v"}, {"texture_u","texture_v"}, {"texture_s","texture_t"} } ;
+   DestinosVertices
+      destinos = solo_coordenadas( reservar_vertices( num_vertices ) );
+
+   if ( reservar_atributos.normales && buscar_propiedad( pv, "nx" ) >= 0 &&
+        buscar_propiedad( pv, "ny" ) >= 0 && buscar_propiedad( pv, "nz" ) >= 0 )
+      destinos.normales = reservar_atributos.normales( num_vertices );
+   if ( reservar_atributos.colores && buscar_propiedad( pv, "red" ) >= 0 &&
+        buscar_propiedad( pv, "green" ) >= 0 && buscar_propiedad( pv, "blue" ) >= 0 )
+      destinos.colores = reservar_atributos.colores( num_vertices );
+   if ( reservar_atributos.cctt )
+      for( unsigned i = 0 ; i < 4 && destinos.cctt == nullptr ; i++ )
+         if ( buscar_propiedad( pv, pares_cctt[i][0] ) >= 0 && buscar_propiedad( pv, pares_cctt[i][1] ) >= 0 )
+         {  destinos.nombres_cctt[0] = pares_cctt[i][0] ;
+            destinos.nombres_cctt[1] = pares_cctt[i][1] ;
+            destinos.cctt = reservar_atributos.cctt( num_vertices );
+         }
+
+   int * dest_caras = reservar_caras( num_caras );
+   assert( destinos.vertices != nullptr && dest_caras != nullptr );
+
+   const DisposicionVertices
+      dv = analizar_vertices( cab, destinos );
+
+   if ( cab.formato == fmt_ascii )
    {
-      if ( src.eof() )
+      const CuerpoAscii cuerpo_ascii = { nvc, num_vertices, num_caras, &dv, dest_caras } ;
+      leer_cuerpo_ascii_mem( cuerpo, arch.datos+arch.tam, cuerpo_ascii );
+   }
+   else
+   {
+      const DisposicionCaras
+         dc = analizar_caras( nvc, cab );
+      const size_t
+         tam_vertices = size_t(num_vertices)*dv.tam_reg,
+         tam_caras    = size_t(num_caras)*dc.tam_reg,
+         tam_cuerpo   = size_t( arch.datos+arch.tam-cuerpo );
+
+      if ( tam_cuerpo < tam_vertices )
          error("fin de archivo prematuro en la lista de vértices");
+      if ( tam_cuerpo-tam_vertices < tam_caras )
+         error("fin de archivo prematuro en la lista de caras");
 
-      long double x,y,z ;
-
-      src >> x >> y >> z ;
-      //cout << "vertex #" << iv << " readed: (" << x << "," << y << "," << z << ")" << endl ;
-
-      src.getline(buffer,tam_buffer); // ignore more properties, so far ...
-
-      // add new vertex
-      long long base = iv*3 ;
-      vertices[base+0] = x ;
-      vertices[base+1] = y ;
-      vertices[base+2] = z ;
+      decodificar_vertices( cuerpo, num_vertices, 0, dv, invertir_bytes( cab ) );
+      decodificar_caras( cuerpo+tam_vertices, num_caras, nvc, num_vertices, dc,
+                         invertir_bytes( cab ), dest_caras );
    }
-   //cout << "  fin de la lista de vértices" << endl << flush ;
+
+   liberar_archivo( arch );
 }
 
+
 //**********************************************************************
 
-void leer_caras
-(
-   const unsigned nvc,
-   unsigned num_vertices,
-   unsigned num_caras,
-   vector<int> & caras,
-   ifstream & src
-)
+void fijar_num_hebras( const unsigned num_hebras )
 {
-   char
-      buffer[unsigned(tam_buffer)];
-   string
-      token ;
-
-   assert( nvc > 2 ) ; // tipicamente, 3 o 4.
-
-   //cout << "  leyendo " << num_caras << " caras ...." << endl << flush ;
-
-   caras.resize( num_caras*nvc );
-
-   for( long long ifa = 0 ; ifa < num_caras ; ifa++ )
-   {
-      if ( src.eof() )
-         error("fin de archivo prematuro en la lista de caras");
-
-      unsigned nv ;
-      src >> nv ;
-      //cout << "reading face #" << ifa << " with " << nv << " vertexes: " ;
-
-      if ( nv != nvc )
-         error("encontrada una cara con un número de vértices distinto del prefijado.");
-
-      long long
-         iv[nvc] ;
-      const long long
-         base = ifa*nvc ;
-
-      // bucle que lee los índices de vértices en una línea
-      for ( unsigned ivc = 0 ; ivc < nvc ; ivc++ )
-      {  src >> iv[ivc] ;
-         if ( num_vertices <= iv[ivc] )
-            error("encontrado algún índice de vértice igual o superior al número de vértices");
-         caras[ base+ivc ] = iv[ivc] ;
-      }
-
-      src.getline(buffer,tam_buffer); // ignore more properties, so far ...
-   }
-   //cout << "  fin de la lista de caras." << endl ;
+   hebras_fijadas = num_hebras ;
 }
 
 //**********************************************************************
@@ -243,10 +409,11 @@ void leer_caras
 void leer_cabecera
 (
    const unsigned nvc,
-   ifstream &src,
+   istream &src,
    unsigned & num_vertices,
    unsigned & num_caras,
-   const bool lee_num_caras
+   const bool lee_num_caras,
+   CabeceraPLY & cab
 )
 {
    char
@@ -260,6 +427,13 @@ void leer_cabecera
    long long int
       nv = 0,
       nc = 0 ;
+   vector<PropiedadPLY> *
+      props_actuales = nullptr ; // propiedades del último elemento leído (nullptr si se ignora)
+
+   cab.formato         = fmt_ascii ;
+   cab.otros_elementos = false ;
+   cab.props_vertices.clear();
+   cab.props_caras.clear();
 
    // leer cabecera:
 
@@ -282,20 +456,28 @@ void leer_cabecera
      }
      else if ( token == "format" )
      {  src >> token ;
-        if ( token != "ascii" )
-        {  string msg = string("el formato del ply no es 'ascii' es '")+token+"', no lo puedo leer" ;
+        if ( token == "ascii" )
+           cab.formato = fmt_ascii ;
+        else if ( token == "binary_little_endian" )
+           cab.formato = fmt_binario_le ;
+        else if ( token == "binary_big_endian" )
+           cab.formato = fmt_binario_be ;
+        else
+        {  string msg = string("el formato del ply es '")+token+"', no lo puedo leer" ;
            error(msg.c_str());
         }
         src.getline(buffer,tam_buffer);
      }
      else if ( token == "element" )
      {  src >> token ;
+        props_actuales = nullptr ;
         if ( token == "vertex" )
         {  if ( state != 0 )
               error("la línea 'element vertex' va después de 'element face'");
            src >> nv ;
            //cout << "  numero de vértices == " << nv << endl ;
            state = lee_num_caras ? 1 : 2 ;
+           props_actuales = & cab.props_vertices ;
         }
         else if ( lee_num_caras && token == "face" )
         {  if ( state != 1 )
@@ -303,14 +485,31 @@ void leer_cabecera
            src >> nc ;
            //cout << "  número de caras == " << nc << endl ;
            state = 2 ;
+           props_actuales = & cab.props_caras ;
         }
         else
         {  //cout << "  elemento '" + token + "' ignorado." << endl ;
+           if ( state < 2 )
+              cab.otros_elementos = true ;
         }
         src.getline(buffer,tam_buffer);
      }
      else if ( token == "property" )
-     {  src.getline(buffer,tam_buffer); // ignore properties, so far ...
+     {  if ( props_actuales != nullptr )
+        {  PropiedadPLY prop ;
+           src >> token ;
+           if ( token == "list" )
+           {  src >> token ; prop.tipo_num = leer_tipo( token );
+              src >> token ; prop.tipo     = leer_tipo( token );
+           }
+           else
+           {  prop.tipo_num = t_ninguno ;
+              prop.tipo     = leer_tipo( token );
+           }
+           src >> prop.nombre ;
+           props_actuales->push_back( prop );
+        }
+        src.getline(buffer,tam_buffer); // resto de la línea (o propiedad de un elemento ignorado)
      }
    } // end of while( en_cabecera )
 
@@ -328,10 +527,776 @@ void leer_cabecera
    if ( nc > numeric_limits<int>::max() )
       error("el número de caras es superior al valor 'int' más grande posible.");
 
+   if ( cab.formato != fmt_ascii && cab.otros_elementos )
+      error("en los archivos binarios no se admiten otros elementos antes de 'vertex' o 'face'");
+
    num_vertices = unsigned(nv) ;
    num_caras    = unsigned(nc) ;
 }
 
+//**********************************************************************
+// destinos con solo las coordenadas de los vértices
+
+DestinosVertices solo_coordenadas( float * vertices )
+{
+   DestinosVertices d ;
+   d.vertices        = vertices ;
+   d.normales        = nullptr ;
+   d.colores         = nullptr ;
+   d.cctt            = nullptr ;
+   d.nombres_cctt[0] = nullptr ;
+   d.nombres_cctt[1] = nullptr ;
+   return d ;
+}
+
+//**********************************************************************
+// índice de una propiedad en la lista (-1 si no está)
+
+int buscar_propiedad( const vector<PropiedadPLY> & props, const char * nombre )
+{
+   for( unsigned ip = 0 ; ip < props.size() ; ip++ )
+      if ( props[ip].nombre == nombre )
+         return int(ip) ;
+   return -1 ;
+}
+
+//**********************************************************************
+// qué propiedades de los vértices se guardan, dónde, y en qué posición
+// están dentro de cada registro (binario) o línea (ascii)
+
+DisposicionVertices analizar_vertices( const CabeceraPLY & cab, const DestinosVertices & destinos )
+{
+   struct Atributo { const char * nombre ; float * dest ; unsigned num_comp, comp ; } ;
+
+   const Atributo
+      atributos[] =
+      {  { "x",     destinos.vertices, 3, 0 }, { "y",     destinos.vertices, 3, 1 }, { "z",    destinos.vertices, 3, 2 },
+         { "nx",    destinos.normales, 3, 0 }, { "ny",    destinos.normales, 3, 1 }, { "nz",   destinos.normales, 3, 2 },
+         { "red",   destinos.colores,  3, 0 }, { "green", destinos.colores,  3, 1 }, { "blue", destinos.colores,  3, 2 },
+         { destinos.nombres_cctt[0], destinos.cctt, 2, 0 }, { destinos.nombres_cctt[1], destinos.cctt, 2, 1 }
+      } ;
+   const unsigned
+      num_atributos = sizeof(atributos)/sizeof(atributos[0]) ;
+   DisposicionVertices
+      d ;
+   unsigned
+      num_coords = 0 ;
+   long
+      primera_lista = -1 ; // índice de la primera propiedad de tipo lista
+
+   d.tam_reg   = 0 ;
+   d.num_props = 0 ;
+
+   for( unsigned ip = 0 ; ip < cab.props_vertices.size() ; ip++ )
+   {
+      const PropiedadPLY & prop = cab.props_vertices[ip] ;
+      if ( prop.tipo_num != t_ninguno )
+      {  if ( cab.formato != fmt_ascii )
+            error("no se admiten listas en los vértices de archivos binarios");
+         if ( primera_lista < 0 )
+            primera_lista = ip ;
+         continue ;
+      }
+      for( unsigned ia = 0 ; ia < num_atributos ; ia++ )
+      {
+         const Atributo & a = atributos[ia] ;
+         if ( a.dest == nullptr || a.nombre == nullptr || prop.nombre != a.nombre )
+            continue ;
+         if ( primera_lista >= 0 )
+            error("no se admiten listas en los vértices antes de las propiedades leídas");
+
+         PropiedadLeida pl ;
+         pl.indice   = ip ;
+         pl.despl    = d.tam_reg ;
+         pl.tipo     = prop.tipo ;
+         pl.dest     = a.dest ;
+         pl.num_comp = a.num_comp ;
+         pl.comp     = a.comp ;
+         pl.escala   = 1.0f ;
+         if ( a.dest == destinos.colores ) // colores enteros: se llevan a [0,1]
+         {  if ( prop.tipo == t_uchar )
+               pl.escala = 1.0f/255.0f ;
+            else if ( prop.tipo == t_ushort )
+               pl.escala = 1.0f/65535.0f ;
+         }
+         d.props.push_back( pl );
+         d.num_props = ip+1 ;
+         if ( a.dest == destinos.vertices )
+            num_coords++ ;
+         break ;
+      }
+      d.tam_reg += tam_tipo( prop.tipo );
+   }
+   if ( num_coords != 3 )
+      error("no encuentro las propiedades 'x', 'y' o 'z' de los vértices");
+
+   // caso más frecuente: solo x,y,z en float y con el mismo orden de bytes
+   // que el procesador: los registros se pueden copiar tal cual
+   d.directa = d.tam_reg == 3*sizeof(float) && d.props.size() == 3 && ! invertir_bytes( cab ) ;
+   for( unsigned i = 0 ; i < d.props.size() && d.directa ; i++ )
+      d.directa = d.props[i].dest == destinos.vertices && d.props[i].comp == i &&
+                  d.props[i].despl == long(4*i) && d.props[i].tipo == t_float ;
+   return d ;
+}
+
+//**********************************************************************
+// disposición de la lista de índices dentro de cada registro de cara
+// (todas las caras deben tener 'nvc' vértices, así que todos los
+// registros tienen el mismo tamaño)
+
+DisposicionCaras analizar_caras( const unsigned nvc, const CabeceraPLY & cab )
+{
+   DisposicionCaras
+      d ;
+
+   assert( nvc > 2 ) ; // tipicamente, 3 o 4.
+
+   d.tam_reg     = 0 ;
+   d.despl_lista = -1 ;
+   d.tipo_num    = t_ninguno ;
+   d.tipo_ind    = t_ninguno ;
+
+   for( unsigned ip = 0 ; ip < cab.props_caras.size() ; ip++ )
+   {
+      const PropiedadPLY & prop = cab.props_caras[ip] ;
+      if ( prop.tipo_num != t_ninguno )
+      {  if ( d.despl_lista >= 0 )
+            error("no se admiten varias listas en las caras de archivos binarios");
+         d.despl_lista = d.tam_reg ;
+         d.tipo_num    = prop.tipo_num ;
+         d.tipo_ind    = prop.tipo ;
+         d.tam_reg    += tam_tipo( prop.tipo_num ) + nvc*tam_tipo( prop.tipo );
+      }
+      else
+         d.tam_reg += tam_tipo( prop.tipo );
+   }
+   if ( d.despl_lista < 0 )
+      error("no encuentro la lista de índices de vértices de las caras");
+   return d ;
+}
+
+//**********************************************************************
+// decodifica 'n' registros de vértices consecutivos en 'datos', que
+// corresponden a los vértices desde 'primero' en adelante
+
+void decodificar_vertices
+(
+   const char *                datos,
+   const unsigned long         n,
+   const unsigned long         primero,
+   const DisposicionVertices & d,
+   const bool                  invertir
+)
+{
+   if ( d.directa )
+   {  memcpy( d.props[0].dest + primero*3UL, datos, n*d.tam_reg );
+      return ;
+   }
+   for( unsigned long i = 0 ; i < n ; i++ )
+   {
+      const char * reg = datos + i*d.tam_reg ;
+      for( unsigned ip = 0 ; ip < d.props.size() ; ip++ )
+      {  const PropiedadLeida & p = d.props[ip] ;
+         p.dest[(primero+i)*p.num_comp+p.comp] =
+            float( decodificar( reg+p.despl, p.tipo, invertir )*p.escala );
+      }
+   }
+}
+
+//**********************************************************************
+// decodifica 'n' registros de caras consecutivos en 'datos',
+// escribiendo nvc*n índices (comprobados) en 'dest'
+
+void decodificar_caras
+(
+   const char *             datos,
+   const unsigned long      n,
+   const unsigned           nvc,
+   const unsigned           num_vertices,
+   const DisposicionCaras & d,
+   const bool               invertir,
+   int *                    dest
+)
+{
+   const unsigned
+      tam_num = tam_tipo( d.tipo_num ),
+      tam_ind = tam_tipo( d.tipo_ind );
+
+   for( unsigned long i = 0 ; i < n ; i++ )
+   {
+      const char * lista = datos + i*d.tam_reg + d.despl_lista ;
+
+      if ( decodificar( lista, d.tipo_num, invertir ) != double(nvc) )
+         error("encontrada una cara con un número de vértices distinto del prefijado.");
+
+      for( unsigned ivc = 0 ; ivc < nvc ; ivc++ )
+      {
+         const double iv = decodificar( lista+tam_num+ivc*tam_ind, d.tipo_ind, invertir );
+         if ( iv < 0.0 || double(num_vertices) <= iv )
+            error("encontrado algún índice de vértice negativo, o igual o superior al número de vértices");
+         dest[i*nvc+ivc] = int(iv) ;
+      }
+   }
+}
+
+//**********************************************************************
+// lectura de los vértices de un archivo binario
+
+void leer_vertices_bin
+(
+   unsigned              num_vertices,
+   const CabeceraPLY &   cab,
+   vector<float> &       vertices,
+   ifstream &            src
+)
+{
+   vertices.resize( (unsigned long)(num_vertices)*3UL );
+
+   const DisposicionVertices
+      d = analizar_vertices( cab, solo_coordenadas( vertices.data() ) );
+
+   // en el caso directo se leen todos los vértices de golpe sobre el vector
+   if ( d.directa )
+   {
+      src.read( (char *) vertices.data(), streamsize(num_vertices)*streamsize(d.tam_reg) );
+      if ( ! src )
+         error("fin de archivo prematuro en la lista de vértices");
+      return ;
+   }
+
+   // caso general: se leen bloques de vértices y se decodifican
+   vector<char>
+      bloque( num_regs_bloque*d.tam_reg );
+
+   for( unsigned long iv0 = 0 ; iv0 < num_vertices ; iv0 += num_regs_bloque )
+   {
+      const unsigned long
+         nb = min( num_regs_bloque, num_vertices-iv0 );
+      src.read( bloque.data(), streamsize(nb*d.tam_reg) );
+      if ( ! src )
+         error("fin de archivo prematuro en la lista de vértices");
+      decodificar_vertices( bloque.data(), nb, iv0, d, invertir_bytes( cab ) );
+   }
+}
+
+//**********************************************************************
+// lectura de las caras de un archivo binario (por bloques)
+
+void leer_caras_bin
+(
+   const unsigned        nvc,
+   unsigned              num_vertices,
+   unsigned              num_caras,
+   const CabeceraPLY &   cab,
+   vector<int> &         caras,
+   ifstream &            src
+)
+{
+   const DisposicionCaras
+      d = analizar_caras( nvc, cab );
+   vector<char>
+      bloque( num_regs_bloque*d.tam_reg );
+
+   caras.resize( (unsigned long)(num_caras)*nvc );
+
+   for( unsigned long ifa0 = 0 ; ifa0 < num_caras ; ifa0 += num_regs_bloque )
+   {
+      const unsigned long
+         nb = min( num_regs_bloque, num_caras-ifa0 );
+      src.read( bloque.data(), streamsize(nb*d.tam_reg) );
+      if ( ! src )
+         error("fin de archivo prematuro en la lista de caras");
+      decodificar_caras( bloque.data(), nb, nvc, num_vertices, d, invertir_bytes( cab ),
+                         caras.data()+ifa0*nvc );
+   }
+}
+
+//**********************************************************************
+// proyecta en memoria (solo lectura) el archivo completo
+
+void proyectar_archivo( const string & nombre_archivo, ArchivoProyectado & arch )
+{
+   const int
+      fd = open( nombre_archivo.c_str(), O_RDONLY );
+   struct stat
+      info ;
+
+   if ( fd < 0 )
+   {
+      string msg = string("no puedo abrir el archivo '") + nombre_archivo + "' para lectura." ;
+      error(msg.c_str());
+   }
+   if ( fstat( fd, &info ) != 0 || info.st_size <= 0 )
+   {  close( fd );
+      error("no puedo obtener el tamaño del archivo, o está vacío");
+   }
+
+   void * ptr = mmap( nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0 );
+   close( fd ); // la proyección sigue siendo válida tras cerrar el descriptor
+
+   if ( ptr == MAP_FAILED )
+      error("no puedo proyectar el archivo en memoria");
+
+   madvise( ptr, size_t(info.st_size), MADV_SEQUENTIAL );
+
+   arch.datos = (const char *) ptr ;
+   arch.tam   = size_t(info.st_size) ;
+}
+
+//**********************************************************************
+
+void liberar_archivo( ArchivoProyectado & arch )
+{
+   munmap( (void *) arch.datos, arch.tam );
+   arch.datos = nullptr ;
+   arch.tam   = 0 ;
+}
+
+//**********************************************************************
+// devuelve un puntero al primer byte tras la línea 'end_header'
+
+const char * buscar_fin_cabecera( const ArchivoProyectado & arch )
+{
+   const string
+      marca = "\nend_header" ;
+   const char *
+      fin = arch.datos + arch.tam ;
+   const char *
+      pos = search( arch.datos, fin, marca.begin(), marca.end() );
+
+   if ( pos == fin )
+      error("fin de archivo prematuro antes de end_header");
+
+   pos = (const char *) memchr( pos+marca.size(), '\n', size_t(fin-pos-marca.size()) );
+   if ( pos == nullptr )
+      error("fin de archivo prematuro tras end_header");
+
+   return pos+1 ;
+}
+
+//**********************************************************************
+// lectura de un cuerpo ascii desde un archivo abierto: se lee el resto
+// del archivo de golpe y se analiza en memoria
+
+void leer_cuerpo_ascii( ifstream & src, const CuerpoAscii & cuerpo )
+{
+   const streampos
+      inicio = src.tellg();
+   src.seekg( 0, ios::end );
+   const streamoff
+      tam = src.tellg() - inicio ;
+   src.seekg( inicio );
+
+   vector<char>
+      texto( size_t( max( tam, streamoff(1) ) ) );
+   src.read( texto.data(), tam );
+   if ( ! src )
+      error("no puedo leer el cuerpo del archivo");
+
+   leer_cuerpo_ascii_mem( texto.data(), texto.data()+tam, cuerpo );
+}
+
+//**********************************************************************
+// lectura de un cuerpo ascii en memoria, en paralelo: el texto se divide
+// en trozos que acaban en final de línea, se cuentan (en paralelo) las
+// líneas de cada trozo para saber qué vértice o cara va en su primera
+// línea, y después se analizan (en paralelo) escribiendo cada valor
+// directamente en su posición final
+
+void leer_cuerpo_ascii_mem( const char * ini, const char * fin, const CuerpoAscii & cuerpo )
+{
+   const size_t
+      tam = size_t( fin-ini );
+   const unsigned
+      num_hebras = hebras_fijadas > 0 ? unsigned( hebras_fijadas )
+                                      : max( 1U, thread::hardware_concurrency() ),
+      num_trozos = unsigned( min( (unsigned long) num_hebras,
+                                  max( 1UL, (unsigned long)(tam/tam_min_trozo) ) ) );
+
+   // límites de los trozos (cada uno empieza justo tras un salto de línea)
+   vector<const char *>
+      limites( num_trozos+1 );
+   limites[0]          = ini ;
+   limites[num_trozos] = fin ;
+   for( unsigned i = 1 ; i < num_trozos ; i++ )
+   {
+      const char * p = max( limites[i-1], ini + (tam*i)/num_trozos ) ;
+      const char * nl = (const char *) memchr( p, '\n', size_t(fin-p) );
+      limites[i] = (nl == nullptr) ? fin : nl+1 ;
+   }
+
+   // ejecuta 'tarea(i)' para cada trozo, el primero en la hebra actual
+   auto en_paralelo = [&]( const function<void(unsigned)> & tarea )
+   {
+      vector<thread> hebras ;
+      for( unsigned i = 1 ; i < num_trozos ; i++ )
+         hebras.push_back( thread( tarea, i ) );
+      tarea( 0 );
+      for( auto & h : hebras )
+         h.join();
+   } ;
+
+   // primera pasada: número de líneas no vacías de cada trozo
+   vector<unsigned long>
+      primera_linea( num_trozos+1, 0 );
+   en_paralelo( [&]( unsigned i )
+   {  primera_linea[i+1] = contar_lineas( limites[i], limites[i+1] );
+   } );
+   for( unsigned i = 0 ; i < num_trozos ; i++ )
+      primera_linea[i+1] += primera_linea[i] ;
+
+   const unsigned long
+      total = primera_linea[num_trozos] ;
+   if ( total < cuerpo.num_vertices )
+      error("fin de archivo prematuro en la lista de vértices");
+   if ( total < (unsigned long)(cuerpo.num_vertices) + cuerpo.num_caras )
+      error("fin de archivo prematuro en la lista de caras");
+
+   // segunda pasada: análisis de las líneas de cada trozo
+   en_paralelo( [&]( unsigned i )
+   {  analizar_lineas( limites[i], limites[i+1], primera_linea[i], cuerpo );
+   } );
+}
+
+//**********************************************************************
+// número de líneas con algún carácter distinto de espacio
+
+unsigned long contar_lineas( const char * ini, const char * fin )
+{
+   unsigned long
+      n = 0 ;
+   bool
+      vacia = true ;
+
+   for( const char * p = ini ; p < fin ; p++ )
+   {
+      const char c = *p ;
+      if ( c == '\n' )
+      {  if ( ! vacia )
+            n++ ;
+         vacia = true ;
+      }
+      else if ( c != ' ' && c != '\t' && c != '\r' )
+         vacia = false ;
+   }
+   return vacia ? n : n+1 ;
+}
+
+//**********************************************************************
+// analiza las líneas no vacías de un trozo, sabiendo el número de la
+// primera de ellas dentro del cuerpo
+
+void analizar_lineas
+(
+   const char *        ini,
+   const char *        fin,
+   unsigned long       primera_linea,
+   const CuerpoAscii & cuerpo
+)
+{
+   const unsigned long
+      num_lineas = (unsigned long)(cuerpo.num_vertices) + cuerpo.num_caras ;
+   unsigned long
+      linea = primera_linea ;
+   const char *
+      p = ini ;
+
+   while ( p < fin && linea < num_lineas )
+   {
+      const char * fin_linea = (const char *) memchr( p, '\n', size_t(fin-p) );
+      if ( fin_linea == nullptr )
+         fin_linea = fin ;
+
+      const char * q = p ;
+      while ( q < fin_linea && (*q == ' ' || *q == '\t' || *q == '\r') )
+         q++ ;
+
+      if ( q < fin_linea ) // línea no vacía (el resto de propiedades se ignoran)
+      {
+         if ( linea < cuerpo.num_vertices )
+         {
+            const DisposicionVertices & d = *cuerpo.vertices ;
+            unsigned                    k = 0 ; // siguiente propiedad a guardar
+            for( unsigned ip = 0 ; ip < d.num_props ; ip++ )
+            {  float v ;
+               if ( ! leer_real( q, fin_linea, v ) )
+                  error("encontrado un vértice con menos valores que propiedades");
+               if ( d.props[k].indice == ip )
+               {  const PropiedadLeida & p = d.props[k++] ;
+                  p.dest[linea*p.num_comp+p.comp] = p.escala == 1.0f ? v : float( double(v)*p.escala ) ;
+               }
+            }
+         }
+         else
+         {
+            const unsigned long ifa = linea - cuerpo.num_vertices ;
+            long long           nv ;
+
+            if ( ! leer_entero( q, fin_linea, nv ) || nv != (long long) cuerpo.nvc )
+               error("encontrada una cara con un número de vértices distinto del prefijado.");
+
+            for( unsigned ivc = 0 ; ivc < cuerpo.nvc ; ivc++ )
+            {  long long iv ;
+               if ( ! leer_entero( q, fin_linea, iv ) )
+                  error("encontrada una cara con menos índices de los indicados");
+               if ( iv < 0 || (long long)(cuerpo.num_vertices) <= iv )
+                  error("encontrado algún índice de vértice negativo, o igual o superior al número de vértices");
+               cuerpo.dest_caras[ifa*cuerpo.nvc+ivc] = int(iv) ;
+            }
+         }
+         linea++ ;
+      }
+      p = fin_linea+1 ;
+   }
+}
+
+//**********************************************************************
+// potencias de 10 exactas en 'long double' y máxima mantisa entera exacta
+// (con 64 bits de mantisa, hasta 10^27; con 53 bits, hasta 10^22)
+
+struct PotenciasExactas
+{
+   long double         pot[28] ;
+   unsigned            max_exp ;
+   unsigned long long  max_mant ;
+
+   PotenciasExactas()
+   {
+      const int digitos = numeric_limits<long double>::digits ;
+      max_mant = digitos >= 64 ? numeric_limits<unsigned long long>::max()
+                               : (1ULL << digitos) ;
+      // 10^e es exacto si 5^e cabe en la mantisa
+      unsigned long long cinco_e = 1 ;
+      max_exp = 0 ;
+      pot[0]  = 1.0L ;
+      while ( max_exp+1 < 28 && cinco_e <= max_mant/5 )
+      {  cinco_e *= 5 ;
+         max_exp++ ;
+         pot[max_exp] = pot[max_exp-1]*10.0L ;
+      }
+   }
+} ;
+
+const PotenciasExactas potencias_exactas ;
+
+//**********************************************************************
+// lee un número real en [p,fin) (tras saltar espacios), sin depender del
+// 'locale', y avanza 'p'. El resultado es el mismo que produce
+// 'istream >> long double' seguido de la conversión a float: si la
+// mantisa decimal y la potencia de 10 son exactas en 'long double', una
+// sola operación da el valor correctamente redondeado; si no, se usa
+// 'strtold'. Devuelve false si no hay un número.
+
+bool leer_real( const char * & p, const char * fin, float & valor )
+{
+   while ( p < fin && (*p == ' ' || *p == '\t' || *p == '\r') )
+      p++ ;
+
+   const char *
+      ini = p ;
+   bool
+      negativo = false,
+      hay_digitos = false,
+      exacto = true ;
+   unsigned long long
+      mant = 0 ;
+   unsigned
+      num_dig = 0 ;  // dígitos significativos en 'mant'
+   long
+      exp10 = 0 ;
+
+   if ( p < fin && (*p == '-' || *p == '+') )
+      negativo = *(p++) == '-' ;
+
+   for( ; p < fin && '0' <= *p && *p <= '9' ; p++ )
+   {  hay_digitos = true ;
+      if ( mant == 0 && *p == '0' )
+         continue ;
+      if ( num_dig < 19 )
+      {  mant = mant*10 + unsigned(*p-'0') ;
+         num_dig++ ;
+      }
+      else
+      {  exp10++ ;
+         exacto = exacto && *p == '0' ;
+      }
+   }
+   if ( p < fin && *p == '.' )
+      for( p++ ; p < fin && '0' <= *p && *p <= '9' ; p++ )
+      {  hay_digitos = true ;
+         if ( mant == 0 && *p == '0' )
+            exp10-- ;
+         else if ( num_dig < 19 )
+         {  mant = mant*10 + unsigned(*p-'0') ;
+            num_dig++ ;
+            exp10-- ;
+         }
+         else
+            exacto = exacto && *p == '0' ;
+      }
+   if ( ! hay_digitos )
+      exacto = false ;
+   else if ( p < fin && (*p == 'e' || *p == 'E') )
+   {
+      const char * q = p+1 ;
+      bool         neg_exp = false ;
+      long         e = 0 ;
+      if ( q < fin && (*q == '-' || *q == '+') )
+         neg_exp = *(q++) == '-' ;
+      if ( q < fin && '0' <= *q && *q <= '9' )
+      {  for( ; q < fin && '0' <= *q && *q <= '9' ; q++ )
+            if ( e < 100000 )
+               e = e*10 + (*q-'0') ;
+         exp10 += neg_exp ? -e : e ;
+         p = q ;
+      }
+      else
+         exacto = false ;
+   }
+   if ( p < fin && *p != ' ' && *p != '\t' && *p != '\r' )
+      exacto = false ;
+
+   if ( exacto && mant <= potencias_exactas.max_mant &&
+        (unsigned long)( exp10 < 0 ? -exp10 : exp10 ) <= potencias_exactas.max_exp )
+   {
+      long double v = (long double)( mant );
+      if ( exp10 < 0 )
+         v /= potencias_exactas.pot[-exp10] ;
+      else
+         v *= potencias_exactas.pot[exp10] ;
+      valor = float( negativo ? -v : v );
+      return true ;
+   }
+
+   // caso lento (muchos dígitos, exponentes grandes, 'inf', 'nan', etc...)
+   char
+      token[128] ;
+   const char *
+      q = ini ;
+   while ( q < fin && *q != ' ' && *q != '\t' && *q != '\r' )
+      q++ ;
+   if ( q == ini || size_t(q-ini) >= sizeof(token) )
+      return false ;
+   memcpy( token, ini, size_t(q-ini) );
+   token[q-ini] = 0 ;
+
+   char *
+      fin_num ;
+   const long double
+      v = strtold( token, &fin_num );
+   if ( fin_num == token )
+      return false ;
+   valor = float( v );
+   p = ini + (fin_num-token) ;
+   return true ;
+}
+
+//**********************************************************************
+// lee un número entero en [p,fin) (tras saltar espacios) y avanza 'p'.
+// Devuelve false si no hay un número.
+
+bool leer_entero( const char * & p, const char * fin, long long & valor )
+{
+   while ( p < fin && (*p == ' ' || *p == '\t' || *p == '\r') )
+      p++ ;
+
+   bool
+      negativo = false ;
+   if ( p < fin && (*p == '-' || *p == '+') )
+      negativo = *(p++) == '-' ;
+
+   if ( p == fin || *p < '0' || '9' < *p )
+      return false ;
+
+   long long
+      v = 0 ;
+   for( ; p < fin && '0' <= *p && *p <= '9' ; p++ )
+   {  if ( v > (numeric_limits<long long>::max()-9)/10 )
+         return false ;
+      v = v*10 + (*p-'0') ;
+   }
+   valor = negativo ? -v : v ;
+   return true ;
+}
+
+//**********************************************************************
+// tipo de una propiedad a partir de su nombre en la cabecera
+
+TipoPLY leer_tipo( const string & nombre )
+{
+   if ( nombre == "char"   || nombre == "int8"    ) return t_char ;
+   if ( nombre == "uchar"  || nombre == "uint8"   ) return t_uchar ;
+   if ( nombre == "short"  || nombre == "int16"   ) return t_short ;
+   if ( nombre == "ushort" || nombre == "uint16"  ) return t_ushort ;
+   if ( nombre == "int"    || nombre == "int32"   ) return t_int ;
+   if ( nombre == "uint"   || nombre == "uint32"  ) return t_uint ;
+   if ( nombre == "float"  || nombre == "float32" ) return t_float ;
+   if ( nombre == "double" || nombre == "float64" ) return t_double ;
+
+   string msg = string("tipo de propiedad desconocido: '")+nombre+"'" ;
+   error(msg.c_str());
+   return t_ninguno ;
+}
+
+//**********************************************************************
+// tamaño en bytes de un valor de un tipo
+
+unsigned tam_tipo( const TipoPLY tipo )
+{
+   switch( tipo )
+   {  case t_char   : case t_uchar  : return 1 ;
+      case t_short  : case t_ushort : return 2 ;
+      case t_int    : case t_uint   : case t_float : return 4 ;
+      case t_double : return 8 ;
+      default       : return 0 ;
+   }
+}
+
+//**********************************************************************
+// true si el procesador guarda los enteros con el byte menos significativo primero
+
+bool host_little_endian()
+{
+   const unsigned short uno = 1 ;
+   return *((const unsigned char *) &uno) == 1 ;
+}
+
+//**********************************************************************
+// true si el orden de bytes del cuerpo del archivo no es el del procesador
+
+bool invertir_bytes( const CabeceraPLY & cab )
+{
+   return (cab.formato == fmt_binario_le) != host_little_endian() ;
+}
+
+//**********************************************************************
+// decodifica un valor binario de un tipo en 'p', invirtiendo el orden
+// de los bytes si es necesario
+
+double decodificar( const char * p, const TipoPLY tipo, const bool invertir )
+{
+   char
+      bytes[8] ;
+   const unsigned
+      tam = tam_tipo( tipo );
+
+   for( unsigned i = 0 ; i < tam ; i++ )
+      bytes[i] = invertir ? p[tam-1-i] : p[i] ;
+
+   switch( tipo )
+   {
+      case t_char   : { signed char    v ; memcpy( &v, bytes, 1 ); return v ; }
+      case t_uchar  : { unsigned char  v ; memcpy( &v, bytes, 1 ); return v ; }
+      case t_short  : { short          v ; memcpy( &v, bytes, 2 ); return v ; }
+      case t_ushort : { unsigned short v ; memcpy( &v, bytes, 2 ); return v ; }
+      case t_int    : { int            v ; memcpy( &v, bytes, 4 ); return v ; }
+      case t_uint   : { unsigned       v ; memcpy( &v, bytes, 4 ); return v ; }
+      case t_float  : { float          v ; memcpy( &v, bytes, 4 ); return v ; }
+      case t_double : { double         v ; memcpy( &v, bytes, 8 ); return v ; }
+      default       : return 0.0 ;
+   }
+}
+
 //**********************************************************************
 
 
@@ -341,7 +1306,7 @@ void abrir_archivo( string & nombre_archivo, ifstream & src )
    char buffer[unsigned(tam_buffer)];
    string token ;
 
-   src.open( nombre_archivo.c_str() ) ; // abrir (¿en modo lectura?)
+   src.open( nombre_archivo.c_str(), ios::in | ios::binary ) ; // abrir en modo lectura (binario, por si el cuerpo lo es)
 
    if ( ! src.is_open() )
    {